@@ -0,0 +1,167 @@
+//
+// Batch evaluation backends: bit-packed masked adds, or dense GEMM (linalg.h).
+//
+#include <batch_eval.h>
+#include <linalg.h>
+#include <stats.h>
+#include <profiler.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Internal helper to set the feasibility of a tile from its usage (tile x m, row-major) */
+static void check_tile(const Problem *prob, Solution *const *sols, const int count, const float *usage) {
+    for (int k = 0; k < count; k++) {
+        bool feasible = true;
+        for (int i = 0; i < prob->m; i++) {
+            feasible &= usage[k * prob->m + i] <= prob->capacities[i];
+        }
+        sols[k]->feasible = feasible;
+    }
+}
+
+/* ------------------------------------------------------
+ * Bit-packed backend
+ * ------------------------------------------------------ */
+typedef struct {
+    BatchEvaluator base;
+    int words;        /**< 64-bit words per packed solution */
+    uint64_t *bits;   /**< Packed tile, BATCH_EVAL_TILE x words */
+    float *usage;     /**< Usage of the tile, BATCH_EVAL_TILE x m */
+} BitpackedEvaluator;
+
+/* Internal helper: sum of row[j] over the set bits j of a packed solution */
+static inline float masked_sum(const float *row, const uint64_t *bits, const int words) {
+    float sum = 0.0f;
+    for (int w = 0; w < words; w++) {
+        uint64_t word = bits[w];
+        while (word) {
+            sum += row[w * 64 + __builtin_ctzll(word)];
+            word &= word - 1;
+        }
+    }
+    return sum;
+}
+
+static void bitpacked_evaluate(BatchEvaluator *self, const Problem *prob, Solution *const *sols, const int count) {
+    BitpackedEvaluator *ev = (BitpackedEvaluator*)self;
+    const int n = prob->n;
+    const int m = prob->m;
+
+    for (int t0 = 0; t0 < count; t0 += BATCH_EVAL_TILE) {
+        const int tile = (count - t0 < BATCH_EVAL_TILE) ? count - t0 : BATCH_EVAL_TILE;
+        Solution *const *tile_sols = &sols[t0];
+
+        // Pack the tile: bit j of solution k is set if item j is selected
+        memset(ev->bits, 0, (size_t)tile * ev->words * sizeof(uint64_t));
+        for (int k = 0; k < tile; k++) {
+            uint64_t *bits = &ev->bits[(size_t)k * ev->words];
+            const float *x = tile_sols[k]->x;
+            for (int j = 0; j < n; j++) {
+                bits[j >> 6] |= (uint64_t)(x[j] > 0.5f) << (j & 63);
+            }
+        }
+
+        // Objective, then usage row by row: each weight row stays in cache for the whole tile
+        for (int k = 0; k < tile; k++) {
+            tile_sols[k]->value = masked_sum(prob->c, &ev->bits[(size_t)k * ev->words], ev->words);
+        }
+        for (int i = 0; i < m; i++) {
+            const float *row = &prob->weights[(size_t)i * n];
+            for (int k = 0; k < tile; k++) {
+                ev->usage[k * m + i] = masked_sum(row, &ev->bits[(size_t)k * ev->words], ev->words);
+            }
+        }
+        check_tile(prob, tile_sols, tile, ev->usage);
+    }
+}
+
+static void bitpacked_destroy(BatchEvaluator *self) {
+    BitpackedEvaluator *ev = (BitpackedEvaluator*)self;
+    free(ev->bits);
+    free(ev->usage);
+    free(ev);
+}
+
+/* ------------------------------------------------------
+ * Dense (GEMM) backend
+ * ------------------------------------------------------ */
+typedef struct {
+    BatchEvaluator base;
+    float *x;         /**< Dense tile, BATCH_EVAL_TILE x n */
+    float *usage;     /**< Usage of the tile, BATCH_EVAL_TILE x m */
+    float *values;    /**< Objective of the tile, BATCH_EVAL_TILE */
+} DenseEvaluator;
+
+static void dense_evaluate(BatchEvaluator *self, const Problem *prob, Solution *const *sols, const int count) {
+    DenseEvaluator *ev = (DenseEvaluator*)self;
+    const int n = prob->n;
+    const int m = prob->m;
+
+    for (int t0 = 0; t0 < count; t0 += BATCH_EVAL_TILE) {
+        const int tile = (count - t0 < BATCH_EVAL_TILE) ? count - t0 : BATCH_EVAL_TILE;
+        Solution *const *tile_sols = &sols[t0];
+
+        for (int k = 0; k < tile; k++) {
+            memcpy(&ev->x[(size_t)k * n], tile_sols[k]->x, n * sizeof(float));
+        }
+
+        // values = X * c, usage = X * W^T
+        linalg_sgemm(tile, 1, n, ev->x, n, prob->c, 1, ev->values, 1);
+        linalg_sgemm(tile, m, n, ev->x, n, prob->weights_by_item, m, ev->usage, m);
+
+        for (int k = 0; k < tile; k++) {
+            tile_sols[k]->value = ev->values[k];
+        }
+        check_tile(prob, tile_sols, tile, ev->usage);
+    }
+}
+
+static void dense_destroy(BatchEvaluator *self) {
+    DenseEvaluator *ev = (DenseEvaluator*)self;
+    free(ev->x);
+    free(ev->usage);
+    free(ev->values);
+    free(ev);
+}
+
+BatchEvaluator *batch_evaluator_create(const BatchBackend backend, const Problem *prob) {
+    if (backend == BATCH_EVAL_DENSE) {
+        DenseEvaluator *ev = calloc(1, sizeof(DenseEvaluator));
+        if (!ev) return nullptr;
+        ev->base = (BatchEvaluator){ .name = "dense", .evaluate = dense_evaluate, .destroy = dense_destroy };
+        ev->x      = (float*)malloc((size_t)BATCH_EVAL_TILE * prob->n * sizeof(float));
+        ev->usage  = (float*)malloc((size_t)BATCH_EVAL_TILE * prob->m * sizeof(float));
+        ev->values = (float*)malloc(BATCH_EVAL_TILE * sizeof(float));
+        if (!ev->x || !ev->usage || !ev->values) {
+            fprintf(stderr, "Memory allocation error in batch_evaluator_create.\n");
+            dense_destroy(&ev->base);
+            return nullptr;
+        }
+        return &ev->base;
+    }
+
+    BitpackedEvaluator *ev = calloc(1, sizeof(BitpackedEvaluator));
+    if (!ev) return nullptr;
+    ev->base = (BatchEvaluator){ .name = "bitpacked", .evaluate = bitpacked_evaluate, .destroy = bitpacked_destroy };
+    ev->words = (prob->n + 63) / 64;
+    ev->bits  = (uint64_t*)malloc((size_t)BATCH_EVAL_TILE * ev->words * sizeof(uint64_t));
+    ev->usage = (float*)malloc((size_t)BATCH_EVAL_TILE * prob->m * sizeof(float));
+    if (!ev->bits || !ev->usage) {
+        fprintf(stderr, "Memory allocation error in batch_evaluator_create.\n");
+        bitpacked_destroy(&ev->base);
+        return nullptr;
+    }
+    return &ev->base;
+}
+
+void batch_evaluate(BatchEvaluator *eval, const Problem *prob, Solution *const *sols, const int count) {
+    PROFILE_ZONE("batch_evaluate");
+    stats_add(STAT_FULL_EVALS, (uint64_t)count);
+    eval->evaluate(eval, prob, sols, count);
+}
+
+void batch_evaluator_destroy(BatchEvaluator *eval) {
+    if (eval) eval->destroy(eval);
+}
@@ -0,0 +1,200 @@
+//
+// Solution board: seqlock slots of packed solutions, published by compare-and-swap.
+//
+#include <board.h>
+#include <stats.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Attempts of a read before giving up (a write only copies n/64 words)
+#define BOARD_READ_ATTEMPTS 16
+
+/* Internal helper to make a sequence number from a writer's pid and a write count */
+static inline uint64_t seq_make(const uint32_t pid, const uint32_t count) {
+    return (uint64_t)pid << 32 | count;
+}
+
+/* Internal helper to get the write count of a sequence number (odd during a write) */
+static inline uint32_t seq_count(const uint64_t seq) {
+    return (uint32_t)seq;
+}
+
+/* Internal helper to check whether the writer of an odd sequence number died during its write */
+static bool seq_writer_died(const uint64_t seq) {
+    const pid_t pid = (pid_t)(seq >> 32);
+    return pid != getpid() && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+/* Internal helper to empty a slot left odd by a dead writer (a process killed while publishing to
+ * a shared board), so that it can be published to again. The slot ends at count + 3: its writer
+ * claimed count and would release count + 1, and both now carry another pid anyway, so a writer
+ * wrongly taken for dead can neither release the slot nor make a torn copy look consistent. */
+static void repair_slot(BoardSlot *slot, uint64_t seq) {
+    const uint32_t self = (uint32_t)getpid();
+    const uint32_t count = seq_count(seq);
+    if (!seq_writer_died(seq) ||
+        !atomic_compare_exchange_strong_explicit(&slot->seq, &seq, seq_make(self, count + 2),
+                                                 memory_order_acquire, memory_order_relaxed)) {
+        return;
+    }
+    atomic_store_explicit(&slot->value, -INFINITY, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq_make(self, count + 3), memory_order_release);
+}
+
+/* Internal helper to release a slot claimed with sequence number claimed
+ * @return false if the slot was taken over (repaired) in the meantime */
+static bool release_slot(BoardSlot *slot, uint64_t claimed) {
+    const uint64_t released = seq_make((uint32_t)(claimed >> 32), seq_count(claimed) + 1);
+    return atomic_compare_exchange_strong_explicit(&slot->seq, &claimed, released,
+                                                   memory_order_release, memory_order_relaxed);
+}
+
+size_t solution_board_bytes(const int capacity, const int n) {
+    // The version on a cache line of its own, then the slots, then the packed solutions
+    const size_t bits = (size_t)capacity * ((n + 63) / 64) * sizeof(uint64_t);
+    return sizeof(BoardSlot) + (size_t)capacity * sizeof(BoardSlot) + (bits + 63) / 64 * 64;
+}
+
+void solution_board_attach(SolutionBoard *board, const int capacity, const int n, void *memory) {
+    char *block = memory;
+    board->n = n;
+    board->words = (n + 63) / 64;
+    board->capacity = capacity;
+    board->version = (_Atomic uint64_t*)block;
+    board->slots = (BoardSlot*)(block + sizeof(BoardSlot));
+    board->bits = (_Atomic uint64_t*)(block + sizeof(BoardSlot) + (size_t)capacity * sizeof(BoardSlot));
+    board->memory = memory;
+    board->owned = false;
+}
+
+int solution_board_init(SolutionBoard *board, const int capacity, const int n) {
+    memset(board, 0, sizeof(*board));
+    void *memory = aligned_alloc(alignof(BoardSlot), solution_board_bytes(capacity, n));
+    if (!memory) {
+        fprintf(stderr, "Memory allocation error in solution_board_init.\n");
+        return -1;
+    }
+    memset(memory, 0, solution_board_bytes(capacity, n));
+    solution_board_attach(board, capacity, n, memory);
+    board->owned = true;
+    solution_board_clear(board);
+    return 0;
+}
+
+void solution_board_free(SolutionBoard *board) {
+    if (board->owned) {
+        free(board->memory);
+    }
+    memset(board, 0, sizeof(*board));
+}
+
+void solution_board_clear(SolutionBoard *board) {
+    for (int s = 0; s < board->capacity; s++) {
+        atomic_init(&board->slots[s].seq, 0);
+        atomic_init(&board->slots[s].value, -INFINITY);
+    }
+    atomic_store(board->version, 0);
+}
+
+bool solution_board_publish(SolutionBoard *board, const Solution *sol) {
+    if (!sol->feasible || board->capacity == 0) {
+        return false;
+    }
+
+    // Worst slot (an emptied one if its writer died); an equal value is taken for the same solution
+    int worst = 0;
+    for (int s = 0; s < board->capacity; s++) {
+        const uint64_t seq = atomic_load_explicit(&board->slots[s].seq, memory_order_relaxed);
+        if (seq_count(seq) & 1) {
+            repair_slot(&board->slots[s], seq);
+        }
+        const float value = solution_board_value(board, s);
+        if (value == sol->value) {
+            return false;
+        }
+        if (value < solution_board_value(board, worst)) {
+            worst = s;
+        }
+    }
+    BoardSlot *slot = &board->slots[worst];
+
+    // Claim the slot (odd count, with our pid), unless another writer holds it or it got better
+    const uint32_t self = (uint32_t)getpid();
+    uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    const uint64_t claimed = seq_make(self, seq_count(seq) + 1);
+    if ((seq_count(seq) & 1) || !atomic_compare_exchange_strong_explicit(&slot->seq, &seq, claimed,
+                                                                         memory_order_acquire, memory_order_relaxed)) {
+        return false;
+    }
+    if (atomic_load_explicit(&slot->value, memory_order_relaxed) >= sol->value) {
+        release_slot(slot, claimed);
+        return false;
+    }
+
+    // Write, then release: readers that saw the old sequence number retry
+    atomic_thread_fence(memory_order_release);
+    _Atomic uint64_t *bits = &board->bits[(size_t)worst * board->words];
+    for (int w = 0; w < board->words; w++) {
+        uint64_t word = 0;
+        const int end = (w * 64 + 64 < board->n) ? w * 64 + 64 : board->n;
+        for (int j = w * 64; j < end; j++) {
+            word |= (uint64_t)(sol->x[j] > 0.5f) << (j & 63);
+        }
+        atomic_store_explicit(&bits[w], word, memory_order_relaxed);
+    }
+    atomic_store_explicit(&slot->value, sol->value, memory_order_relaxed);
+    if (!release_slot(slot, claimed)) {
+        return false;
+    }
+    atomic_fetch_add_explicit(board->version, 1, memory_order_release);
+    stats_inc(STAT_BOARD_PUBLISHES);
+    return true;
+}
+
+int solution_board_best(const SolutionBoard *board) {
+    int best = -1;
+    float best_value = -INFINITY;
+    for (int s = 0; s < board->capacity; s++) {
+        const float value = solution_board_value(board, s);
+        if (value > best_value) {
+            best_value = value;
+            best = s;
+        }
+    }
+    return best;
+}
+
+bool solution_board_read(const SolutionBoard *board, const int s, Solution *sol) {
+    const BoardSlot *slot = &board->slots[s];
+    const _Atomic uint64_t *bits = &board->bits[(size_t)s * board->words];
+    for (int attempt = 0; attempt < BOARD_READ_ATTEMPTS; attempt++) {
+        const uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        const float value = atomic_load_explicit(&slot->value, memory_order_relaxed);
+        if (value == -INFINITY) {
+            return false;
+        }
+        for (int w = 0; w < board->words; w++) {
+            const uint64_t word = atomic_load_explicit(&bits[w], memory_order_relaxed);
+            const int end = (w * 64 + 64 < board->n) ? w * 64 + 64 : board->n;
+            for (int j = w * 64; j < end; j++) {
+                sol->x[j] = ((word >> (j & 63)) & 1u) ? 1.0f : 0.0f;
+            }
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq) {
+            sol->value = value;
+            sol->feasible = true;
+            stats_inc(STAT_BOARD_IMPORTS);
+            return true;
+        }
+    }
+    return false;
+}
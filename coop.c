@@ -0,0 +1,368 @@
+//
+// Cooperative parallel search: VNS, GA and GD-seeded VND workers exchanging solutions through a
+// lock-free solution board.
+//
+#include <coop.h>
+#include <board.h>
+#include <vnd.h>
+#include <vns.h>
+#include <genetic.h>
+#include <gradesc.h>
+#include <thread_pool.h>
+#include <profiler.h>
+#include <math.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+static const char *role_names[COOP_ROLES] = {
+    [COOP_VNS] = "VNS",
+    [COOP_GA]  = "GA",
+    [COOP_LS]  = "LS",
+};
+
+/* The shared part of a cooperative run */
+typedef struct {
+    const Problem *prob;
+    const MkpParams *params;
+    const Solution *initial;               // read-only during the run
+    SolutionBoard *board;
+    Workspace *ws;                         // workspace of thread 0
+    Workspace *workers;                    // workspaces of threads 1 and up
+    int threads;
+    clock_t start;
+    float max_time;
+    bool deterministic;                    // rounds with ordered exchanges (see coop_rounds)
+    _Atomic int turn;                      // deterministic: round * threads + thread allowed to exchange
+    _Atomic bool stop;                     // deterministic: the next round is the last exchange
+    float best_value;                      // deterministic: best board value at the last round's end
+    int stale_rounds;                      // deterministic: rounds since it improved
+    _Atomic int publishes[COOP_ROLES];     // solutions each role put on the board
+    _Atomic int imports[COOP_ROLES];       // solutions each role took from the board
+} CoopRun;
+
+/* One worker: a role and the state of its current method */
+typedef struct {
+    CoopRole role;
+    const Problem *prob;                   // the instance, NUMA-local if the thread has a copy
+    Workspace *ws;
+    float published;                       // value of the last solution it published
+    uint64_t seen;                         // board version at its last look
+    int steps;
+    bool descending;                       // LS: VND on the GD result, else GD
+    bool done;                             // deterministic: the method stopped during the round
+    VnsState vns;
+    GaState ga;
+    GdState gd;
+    VndState vnd;
+} CoopWorker;
+
+const char *coop_role_name(const CoopRole role) {
+    return (role >= 0 && role < COOP_ROLES) ? role_names[role] : "UNKNOWN";
+}
+
+/* Internal helper to get the workspace of thread t */
+static inline Workspace *coop_workspace(const CoopRun *run, const int t) {
+    return (t == 0) ? run->ws : &run->workers[t - 1];
+}
+
+/* Internal helper to tell whether thread t runs role r */
+static inline bool coop_runs_role(const int threads, const int t, const int r) {
+    return (threads >= COOP_ROLES) ? r == t % COOP_ROLES : r % threads == t;
+}
+
+/* Internal helper to publish a worker's solution if it improved since its last publish */
+static void coop_publish(CoopRun *run, CoopWorker *w, const Solution *sol) {
+    if (sol->feasible && sol->value > w->published && solution_board_publish(run->board, sol)) {
+        w->published = sol->value;
+        atomic_fetch_add_explicit(&run->publishes[w->role], 1, memory_order_relaxed);
+    }
+}
+
+/* Internal helper to copy the board's best solution into sol (the initial one if the board is
+ * empty or busy) */
+static void coop_read_best(CoopRun *run, CoopWorker *w, Solution *sol) {
+    const int best = solution_board_best(run->board);
+    if (best >= 0 && solution_board_read(run->board, best, sol)) {
+        atomic_fetch_add_explicit(&run->imports[w->role], 1, memory_order_relaxed);
+    } else {
+        copy_solution(run->initial, sol);
+    }
+}
+
+/* Internal helper to start the method of a worker */
+static void coop_start(CoopRun *run, CoopWorker *w) {
+    const Problem *prob = w->prob;
+    const MkpParams *params = run->params;
+    Workspace *ws = w->ws;
+    w->seen = solution_board_version(run->board);
+    switch (w->role) {
+        case COOP_VNS:
+            coop_read_best(run, w, &ws->coop_vns);
+            vns_init(&w->vns, prob, &ws->coop_vns, params->max_no_improv, params->k_max, params->ls_max_checks,
+                     LS_BEST_IMPROVEMENT, NONE, ws);
+            break;
+        case COOP_GA:
+            coop_read_best(run, w, &ws->coop_import);
+            ga_init(&w->ga, prob, &ws->coop_import, params->population_size, params->max_generations,
+                    params->mutation_rate, NONE, &ws->coop_import, ws);
+            break;
+        case COOP_LS:
+            // From a saturated solution the gradient vanishes: start anywhere
+            gd_init(&w->gd, prob, params->lambda, params->learning_rate, params->max_no_improv, &ws->coop_ls,
+                    NONE, nullptr, ws);
+            w->descending = false;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Internal helper to end the method of a worker, publishing its result */
+static void coop_finish(CoopRun *run, CoopWorker *w) {
+    switch (w->role) {
+        case COOP_VNS:
+            vns_finalize(&w->vns);
+            coop_publish(run, w, &w->ws->coop_vns);
+            break;
+        case COOP_GA:
+            coop_publish(run, w, ga_best(&w->ga));
+            ga_finalize(&w->ga);
+            break;
+        case COOP_LS:
+            if (w->descending) {
+                vnd_finalize(&w->vnd);
+                coop_publish(run, w, &w->ws->coop_ls);
+            } else {
+                gd_finalize(&w->gd);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Internal helper to run one step of a worker's method, of at most units iterations
+ * @return false once the method is done */
+static bool coop_advance(CoopRun *run, CoopWorker *w, const uint64_t units, const float budget) {
+    Workspace *ws = w->ws;
+    switch (w->role) {
+        case COOP_VNS:
+            return vns_step_units(&w->vns, units, budget);
+        case COOP_GA:
+            return ga_step_units(&w->ga, units, budget);
+        case COOP_LS:
+            // GD until it converges, then VND on its rounded result
+            if (!w->descending) {
+                if (!gd_step_units(&w->gd, units, budget)) {
+                    gd_finalize(&w->gd);
+                    vnd_init(&w->vnd, w->prob, &ws->coop_ls, run->params->max_no_improv,
+                             run->params->ls_max_checks, LS_BEST_IMPROVEMENT, ws);
+                    w->descending = true;
+                }
+                return true;
+            }
+            return vnd_step_units(&w->vnd, units, budget);
+        default:
+            return false;
+    }
+}
+
+/* Internal helper to publish the current solution of a running method (LS only publishes its
+ * finished descents) */
+static void coop_publish_current(CoopRun *run, CoopWorker *w) {
+    switch (w->role) {
+        case COOP_VNS:
+            coop_publish(run, w, &w->ws->coop_vns);
+            break;
+        case COOP_GA:
+            coop_publish(run, w, ga_best(&w->ga));
+            break;
+        default:
+            break;
+    }
+}
+
+/* Internal helper to run one step of a worker and publish what it found; a method that is done
+ * starts over */
+static void coop_step(CoopRun *run, CoopWorker *w, const float budget) {
+    if (coop_advance(run, w, UINT64_MAX, budget)) {
+        coop_publish_current(run, w);
+    } else {
+        coop_finish(run, w);
+        coop_start(run, w);
+    }
+}
+
+/* Internal helper to take news from the board: VNS moves to a better best solution, GA takes in
+ * a random member */
+static void coop_import(CoopRun *run, CoopWorker *w) {
+    const uint64_t version = solution_board_version(run->board);
+    if (version == w->seen) {
+        return;
+    }
+    w->seen = version;
+    Workspace *ws = w->ws;
+    Solution *incoming = &ws->coop_import;
+    switch (w->role) {
+        case COOP_VNS: {
+            const int best = solution_board_best(run->board);
+            if (best >= 0 && solution_board_value(run->board, best) > ws->coop_vns.value &&
+                solution_board_read(run->board, best, incoming)) {
+                vns_finalize(&w->vns);
+                copy_solution(incoming, &ws->coop_vns);
+                vns_init(&w->vns, w->prob, &ws->coop_vns, run->params->max_no_improv, run->params->k_max,
+                         run->params->ls_max_checks, LS_BEST_IMPROVEMENT, NONE, ws);
+                w->published = ws->coop_vns.value;
+                atomic_fetch_add_explicit(&run->imports[w->role], 1, memory_order_relaxed);
+            }
+            break;
+        }
+        case COOP_GA: {
+            // ga_init's output buffer is only written by ga_finalize
+            const int s = rng_below(&ws->rng, run->board->capacity);
+            if (solution_board_read(run->board, s, incoming)) {
+                ga_inject(&w->ga, incoming);
+                atomic_fetch_add_explicit(&run->imports[w->role], 1, memory_order_relaxed);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/* Internal helper for the last thread of a deterministic round to decide whether the next round
+ * is the last one: after COOP_PATIENCE rounds without a better board solution, or when time is up */
+static void coop_decide(CoopRun *run) {
+    const int best = solution_board_best(run->board);
+    const float value = (best >= 0) ? solution_board_value(run->board, best) : -INFINITY;
+    if (value > run->best_value) {
+        run->best_value = value;
+        run->stale_rounds = 0;
+    } else {
+        run->stale_rounds++;
+    }
+    if (run->stale_rounds >= COOP_PATIENCE || time_is_up(run->start, run->max_time)) {
+        atomic_store_explicit(&run->stop, true, memory_order_relaxed);
+    }
+}
+
+/* Internal helper: the workers of one thread in a deterministic run. Rounds alternate an exchange,
+ * made by the threads one at a time in thread order (so the board every thread sees is the same on
+ * every run), and COOP_IMPORT_PERIOD steps of COOP_STEP_UNITS iterations, in parallel without
+ * touching the board. Methods that stop during the steps restart at the next exchange */
+static void coop_rounds(CoopRun *run, CoopWorker *workers, const int count, const int t) {
+    for (int round = 0;; round++) {
+        const int ticket = round * run->threads + t;
+        while (atomic_load_explicit(&run->turn, memory_order_acquire) != ticket) {
+            sched_yield();
+        }
+        const bool stop = atomic_load_explicit(&run->stop, memory_order_relaxed);
+        for (int i = 0; i < count; i++) {
+            CoopWorker *w = &workers[i];
+            if (round == 0) {
+                coop_start(run, w);
+            } else if (stop || w->done) {
+                coop_finish(run, w);
+                if (!stop) {
+                    coop_start(run, w);
+                }
+                w->done = false;
+            } else {
+                coop_publish_current(run, w);
+                coop_import(run, w);
+            }
+        }
+        if (t == run->threads - 1 && !stop) {
+            coop_decide(run);
+        }
+        atomic_fetch_add_explicit(&run->turn, 1, memory_order_release);
+        if (stop) {
+            return;
+        }
+
+        for (int step = 0; step < COOP_IMPORT_PERIOD; step++) {
+            for (int i = 0; i < count; i++) {
+                CoopWorker *w = &workers[i];
+                if (!w->done) {
+                    w->done = !coop_advance(run, w, COOP_STEP_UNITS, time_remaining(run->start, run->max_time));
+                }
+            }
+        }
+    }
+}
+
+/* Internal helper: the workers of one thread, stepped in turn until time is up */
+static void coop_task(void *arg, const int task, const int worker) {
+    (void)task;
+    CoopRun *run = arg;
+    Workspace *ws = coop_workspace(run, worker);
+    CoopWorker workers[COOP_ROLES];
+    int count = 0;
+    for (int r = 0; r < COOP_ROLES; r++) {
+        if (coop_runs_role(run->threads, worker, r)) {
+            workers[count] = (CoopWorker){
+                .role = (CoopRole)r, .prob = workspace_problem(ws, run->prob), .ws = ws, .published = -INFINITY
+            };
+            count++;
+        }
+    }
+    if (run->deterministic) {
+        coop_rounds(run, workers, count, worker);
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        coop_start(run, &workers[i]);
+    }
+    while (!time_is_up(run->start, run->max_time)) {
+        for (int i = 0; i < count; i++) {
+            CoopWorker *w = &workers[i];
+            coop_step(run, w, fminf(COOP_STEP, time_remaining(run->start, run->max_time)));
+            if (++w->steps % COOP_IMPORT_PERIOD == 0) {
+                coop_import(run, w);
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        coop_finish(run, &workers[i]);
+    }
+}
+
+void coop(const Problem *prob,
+          const MkpParams *params,
+          Solution *best_sol,
+          const clock_t start,
+          const float max_time,
+          SolutionBoard *board,
+          Workspace *ws,
+          Workspace *workers) {
+    PROFILE_ZONE("coop");
+    ThreadPool *pool = ws->pool;
+    CoopRun run = {
+        .prob = prob, .params = params, .initial = best_sol, .board = board, .ws = ws, .workers = workers,
+        .threads = thread_pool_size(pool), .start = start, .max_time = max_time,
+        .deterministic = params->deterministic, .best_value = -INFINITY
+    };
+    solution_board_publish(run.board, best_sol);
+
+    // Each worker runs sequentially on its thread: the pool is busy running the workers
+    ws->pool = nullptr;
+    thread_pool_run_each(pool, coop_task, &run);
+    ws->pool = pool;
+
+    // Other processes may still write to a shared board: a failed read leaves best_sol alone
+    const int best = solution_board_best(run.board);
+    if (best >= 0 && solution_board_value(run.board, best) > best_sol->value &&
+        solution_board_read(run.board, best, &ws->coop_import)) {
+        copy_solution(&ws->coop_import, best_sol);
+    }
+
+    if (params->log_level >= INFO) {
+        for (int r = 0; r < COOP_ROLES; r++) {
+            printf("[COOP] %-3s %5d published, %5d imported\n", role_names[r],
+                   atomic_load(&run.publishes[r]), atomic_load(&run.imports[r]));
+        }
+    }
+}
@@ -0,0 +1,246 @@
+//
+// In-place updates of a loaded problem (capacities, profits, removed and added items).
+//
+#include <delta.h>
+#include <order.h>
+#include <profiler.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Internal helper to find the rank of an item in an ordering */
+static int order_position(const Problem *prob, const ItemOrder order, const int item) {
+    for (int pos = 0; pos < prob->n; pos++) {
+        if (prob->orders[order][pos] == item) return pos;
+    }
+    return -1;
+}
+
+/* Internal helper to move the entry at pos of an ordering to its rank after its key changed */
+static void order_reposition(Problem *prob, const ItemOrder order, int pos) {
+    int *list = prob->orders[order];
+    const int item = list[pos];
+    const float key = problem_order_key(prob, order, item);
+
+    while (pos > 0 && problem_order_key(prob, order, list[pos - 1]) < key) {
+        list[pos] = list[pos - 1];
+        pos--;
+    }
+    while (pos < prob->n - 1 && problem_order_key(prob, order, list[pos + 1]) > key) {
+        list[pos] = list[pos + 1];
+        pos++;
+    }
+    list[pos] = item;
+}
+
+/* Internal helper to insert an item (already counted in prob->n) into an ordering of length len */
+static void order_insert(Problem *prob, const ItemOrder order, const int len, const int item) {
+    int *list = prob->orders[order];
+    const float key = problem_order_key(prob, order, item);
+
+    // Binary search for the first entry with a strictly smaller key
+    int lo = 0, hi = len;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (problem_order_key(prob, order, list[mid]) >= key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(&list[lo + 1], &list[lo], (len - lo) * sizeof(int));
+    list[lo] = item;
+}
+
+/* Internal helper to check a delta against the problem, and count the distinct removed items */
+static int validate_delta(const Problem *prob, const ProblemDelta *delta, int *new_index, int *num_removed) {
+    for (int k = 0; k < delta->num_capacities; k++) {
+        if (delta->capacity_idx[k] < 0 || delta->capacity_idx[k] >= prob->m) {
+            fprintf(stderr, "Invalid constraint index %d in delta.\n", delta->capacity_idx[k]);
+            return -1;
+        }
+    }
+    for (int k = 0; k < delta->num_profits; k++) {
+        if (delta->profit_idx[k] < 0 || delta->profit_idx[k] >= prob->n) {
+            fprintf(stderr, "Invalid item index %d in delta.\n", delta->profit_idx[k]);
+            return -1;
+        }
+    }
+    *num_removed = 0;
+    for (int k = 0; k < delta->num_removed; k++) {
+        const int j = delta->removed[k];
+        if (j < 0 || j >= prob->n) {
+            fprintf(stderr, "Invalid removed item %d in delta.\n", j);
+            return -1;
+        }
+        if (new_index[j] == 0) (*num_removed)++;
+        new_index[j] = -1;
+    }
+    if (delta->num_added < 0 || (delta->num_added > 0 && (!delta->added_c || !delta->added_weights))) {
+        fprintf(stderr, "Invalid added items in delta.\n");
+        return -1;
+    }
+    if (prob->n - *num_removed + delta->num_added < 1) {
+        fprintf(stderr, "Delta leaves no item in the problem.\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Internal helper to grow all item arrays (and the solution) to hold n items */
+static int reserve_items(Problem *prob, Solution *sol, const int n) {
+    const int m = prob->m;
+    float *c = realloc(prob->c, n * sizeof(float));
+    if (c) prob->c = c;
+    float *weights = realloc(prob->weights, (size_t)m * n * sizeof(float));
+    if (weights) prob->weights = weights;
+    float *weights_by_item = realloc(prob->weights_by_item, (size_t)m * n * sizeof(float));
+    if (weights_by_item) prob->weights_by_item = weights_by_item;
+    float *sum_of_weights = realloc(prob->sum_of_weights, n * sizeof(float));
+    if (sum_of_weights) prob->sum_of_weights = sum_of_weights;
+    float *ratios = realloc(prob->ratios, n * sizeof(float));
+    if (ratios) prob->ratios = ratios;
+    float *scaled_ratios = realloc(prob->scaled_ratios, n * sizeof(float));
+    if (scaled_ratios) prob->scaled_ratios = scaled_ratios;
+    float *dual_ratios = realloc(prob->dual_ratios, n * sizeof(float));
+    if (dual_ratios) prob->dual_ratios = dual_ratios;
+    bool orders_ok = true;
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        int *list = realloc(prob->orders[o], n * sizeof(int));
+        if (list) prob->orders[o] = list;
+        orders_ok &= list != nullptr;
+    }
+    problem_set_order(prob, prob->order);
+    float *x = sol ? realloc(sol->x, n * sizeof(float)) : nullptr;
+    if (x) sol->x = x;
+
+    if (!c || !weights || !weights_by_item || !sum_of_weights || !ratios || !scaled_ratios || !dual_ratios ||
+        !orders_ok || (sol && !x)) {
+        fprintf(stderr, "Memory allocation error in problem_apply_delta.\n");
+        return -1;
+    }
+    return 0;
+}
+
+int problem_apply_delta(Problem *prob, const ProblemDelta *delta, Solution *sol, float *usage) {
+    PROFILE_ZONE("problem_apply_delta");
+    const int m = prob->m;
+
+    // Old -> new item index, -1 for removed items (only marks removals until the compaction)
+    int *new_index = calloc(prob->n, sizeof(int));
+    if (!new_index) {
+        fprintf(stderr, "Memory allocation error in problem_apply_delta.\n");
+        return -1;
+    }
+    int num_removed;
+    if (validate_delta(prob, delta, new_index, &num_removed) != 0) {
+        free(new_index);
+        return -1;
+    }
+
+    // Allocate first, so that an allocation error leaves the problem unchanged
+    const int final_n = prob->n - num_removed + delta->num_added;
+    if (final_n > prob->n && reserve_items(prob, sol, final_n) != 0) {
+        free(new_index);
+        return -1;
+    }
+
+    // Capacities: nothing derived depends on them
+    for (int k = 0; k < delta->num_capacities; k++) {
+        prob->capacities[delta->capacity_idx[k]] = delta->capacity_values[k];
+    }
+
+    // Profits: update the keys and move the item to its new rank in every ordering
+    for (int k = 0; k < delta->num_profits; k++) {
+        const int j = delta->profit_idx[k];
+        if (sol && sol->x[j] > 0.5f) sol->value += delta->profit_values[k] - prob->c[j];
+        prob->c[j] = delta->profit_values[k];
+        problem_update_item_keys(prob, j);
+        for (int o = 0; o < ORDER_COUNT; o++) {
+            order_reposition(prob, (ItemOrder)o, order_position(prob, (ItemOrder)o, j));
+        }
+    }
+
+    // Removals: compact every item array in place, renumbering the orderings
+    if (num_removed > 0) {
+        const int old_n = prob->n;
+        int new_n = 0;
+        for (int j = 0; j < old_n; j++) {
+            if (new_index[j] < 0) {
+                if (sol && sol->x[j] > 0.5f) {
+                    sol->value -= prob->c[j];
+                    if (usage) {
+                        for (int i = 0; i < m; i++) {
+                            usage[i] -= prob->weights[i * old_n + j];
+                        }
+                    }
+                }
+                continue;
+            }
+            new_index[j] = new_n;
+            prob->c[new_n] = prob->c[j];
+            prob->sum_of_weights[new_n] = prob->sum_of_weights[j];
+            prob->ratios[new_n] = prob->ratios[j];
+            prob->scaled_ratios[new_n] = prob->scaled_ratios[j];
+            prob->dual_ratios[new_n] = prob->dual_ratios[j];
+            memmove(&prob->weights_by_item[new_n * m], &prob->weights_by_item[j * m], m * sizeof(float));
+            if (sol) sol->x[new_n] = sol->x[j];
+            new_n++;
+        }
+
+        // Destination never overtakes the source, so a forward pass is safe
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < old_n; j++) {
+                if (new_index[j] >= 0) prob->weights[i * new_n + new_index[j]] = prob->weights[i * old_n + j];
+            }
+        }
+
+        for (int o = 0; o < ORDER_COUNT; o++) {
+            int *list = prob->orders[o];
+            int len = 0;
+            for (int pos = 0; pos < old_n; pos++) {
+                const int j = new_index[list[pos]];
+                if (j >= 0) list[len++] = j;
+            }
+        }
+
+        prob->n = new_n;
+    }
+    free(new_index);
+
+    // Additions: relayout the rows once (last row first), then insert each item by rank
+    if (delta->num_added > 0) {
+        const int old_n = prob->n;
+        const int new_n = old_n + delta->num_added;
+        for (int i = m - 1; i >= 0; i--) {
+            memmove(&prob->weights[i * new_n], &prob->weights[i * old_n], old_n * sizeof(float));
+            for (int k = 0; k < delta->num_added; k++) {
+                prob->weights[i * new_n + old_n + k] = delta->added_weights[k * m + i];
+            }
+        }
+        memcpy(&prob->weights_by_item[old_n * m], delta->added_weights, (size_t)delta->num_added * m * sizeof(float));
+
+        prob->n = new_n;
+        for (int k = 0; k < delta->num_added; k++) {
+            const int j = old_n + k;
+            prob->c[j] = delta->added_c[k];
+            prob->sum_of_weights[j] = 0.0f;
+            for (int i = 0; i < m; i++) {
+                prob->sum_of_weights[j] += prob->weights[i * new_n + j];
+            }
+            problem_update_item_keys(prob, j);
+            for (int o = 0; o < ORDER_COUNT; o++) {
+                order_insert(prob, (ItemOrder)o, j, j);
+            }
+            if (sol) sol->x[j] = 0.0f;
+        }
+    }
+
+    // Capacities change the surrogate keys of every item: re-estimate the duals and re-sort
+    if (delta->num_capacities > 0) {
+        problem_build_orders(prob);
+    }
+
+    if (sol) sol->n = prob->n;
+    return 0;
+}
@@ -0,0 +1,123 @@
+//
+// Elite pool: bounded, diversity-aware set of packed feasible solutions.
+//
+#include <elite.h>
+#include <stats.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int elite_pool_init(ElitePool *pool, const int capacity, const int n) {
+    memset(pool, 0, sizeof(*pool));
+    pool->n = n;
+    pool->words = (n + 63) / 64;
+    pool->capacity = capacity;
+    // Closer than 1% of the items (at least 2 flips): the same local optimum up to a small move
+    pool->min_distance = (n / 100 > 2) ? n / 100 : 2;
+    pool->bits    = (uint64_t*)calloc((size_t)capacity * pool->words, sizeof(uint64_t));
+    pool->values  = (float*)calloc(capacity, sizeof(float));
+    pool->ids     = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+    pool->scratch = (uint64_t*)calloc(pool->words, sizeof(uint64_t));
+    if (!pool->bits || !pool->values || !pool->ids || !pool->scratch) {
+        fprintf(stderr, "Memory allocation error in elite_pool_init.\n");
+        elite_pool_free(pool);
+        return -1;
+    }
+    return 0;
+}
+
+void elite_pool_free(ElitePool *pool) {
+    free(pool->bits); pool->bits = nullptr;
+    free(pool->values); pool->values = nullptr;
+    free(pool->ids); pool->ids = nullptr;
+    free(pool->scratch); pool->scratch = nullptr;
+    pool->count = 0;
+    pool->capacity = 0;
+}
+
+void elite_pool_clear(ElitePool *pool) {
+    pool->count = 0;
+}
+
+/* Internal helper: Hamming distance between two packed solutions */
+static inline int packed_distance(const uint64_t *a, const uint64_t *b, const int words) {
+    int distance = 0;
+    for (int w = 0; w < words; w++) {
+        distance += __builtin_popcountll(a[w] ^ b[w]);
+    }
+    return distance;
+}
+
+/* Internal helper: store the packed scratch solution as member e */
+static void store_member(ElitePool *pool, const int e, const float value) {
+    memcpy(&pool->bits[(size_t)e * pool->words], pool->scratch, pool->words * sizeof(uint64_t));
+    pool->values[e] = value;
+    pool->ids[e] = pool->next_id++;
+    stats_inc(STAT_ELITE_INSERTS);
+}
+
+bool elite_pool_offer(ElitePool *pool, const Solution *sol) {
+    if (!sol->feasible || pool->capacity == 0) {
+        return false;
+    }
+
+    // Worst member, for the cheap rejection before packing
+    int worst = -1;
+    for (int e = 0; e < pool->count; e++) {
+        if (worst == -1 || pool->values[e] < pool->values[worst]) {
+            worst = e;
+        }
+    }
+    const bool full = pool->count == pool->capacity;
+    if (full && sol->value <= pool->values[worst]) {
+        return false;
+    }
+
+    // Pack, then find the nearest member
+    memset(pool->scratch, 0, pool->words * sizeof(uint64_t));
+    for (int j = 0; j < pool->n; j++) {
+        pool->scratch[j >> 6] |= (uint64_t)(sol->x[j] > 0.5f) << (j & 63);
+    }
+    int nearest = -1;
+    int nearest_distance = pool->n + 1;
+    for (int e = 0; e < pool->count; e++) {
+        const int d = packed_distance(pool->scratch, &pool->bits[(size_t)e * pool->words], pool->words);
+        if (d < nearest_distance) {
+            nearest_distance = d;
+            nearest = e;
+        }
+    }
+
+    // A near-duplicate only replaces the member it duplicates, and only if it is better
+    if (nearest != -1 && nearest_distance < pool->min_distance) {
+        if (nearest_distance == 0 || sol->value <= pool->values[nearest]) {
+            return false;
+        }
+        store_member(pool, nearest, sol->value);
+        return true;
+    }
+    store_member(pool, full ? worst : pool->count++, sol->value);
+    return true;
+}
+
+int elite_pool_best(const ElitePool *pool) {
+    int best = -1;
+    for (int e = 0; e < pool->count; e++) {
+        if (best == -1 || pool->values[e] > pool->values[best]) {
+            best = e;
+        }
+    }
+    return best;
+}
+
+int elite_pool_distance(const ElitePool *pool, const int a, const int b) {
+    return packed_distance(&pool->bits[(size_t)a * pool->words], &pool->bits[(size_t)b * pool->words], pool->words);
+}
+
+void elite_pool_get(const ElitePool *pool, const int e, Solution *sol) {
+    for (int j = 0; j < pool->n; j++) {
+        sol->x[j] = elite_pool_selected(pool, e, j) ? 1.0f : 0.0f;
+    }
+    sol->value = pool->values[e];
+    sol->feasible = true;
+}
@@ -0,0 +1,429 @@
+//
+// Compound neighborhoods: 2-1 and 1-2 exchanges, ejection chains.
+// Candidates are restricted to the best-ranked unselected and worst-ranked selected items of
+// candidate_list, and every move is checked in O(m) against the slack of the current solution.
+//
+#include <exchange.h>
+#include <utils.h>
+#include <stats.h>
+#include <profiler.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest chain: the start, EJECTION_DEPTH ejections and pushed adds, and the fills
+#define CHAIN_MAX_OPS (2 * EJECTION_DEPTH + EXCHANGE_CANDIDATES + 1)
+
+/* Restricted candidate sets of one iteration */
+typedef struct {
+    int adds[EXCHANGE_CANDIDATES];           // unselected items of the window, in candidate_list order
+    float add_pairs[EXCHANGE_CANDIDATES][2]; // (c_j, j) of the adds, by profit descending
+    int num_adds;
+    int drops[EXCHANGE_CANDIDATES];          // selected items, worst-ranked first
+    int num_drops;
+} ExchangeCandidates;
+
+/* A sequence of flips, applied in order */
+typedef struct {
+    int items[CHAIN_MAX_OPS];
+    bool added[CHAIN_MAX_OPS];               // true: item added, false: item dropped
+    int length;
+} ExchangeChain;
+
+/* Internal helper to collect the add and drop candidates of the current solution */
+static void collect_candidates(const SearchContext *ctx, ExchangeCandidates *cand) {
+    const Problem *prob = ctx->prob;
+    const Solution *sol = ctx->sol;
+    const int limit = (ctx->ls_k <= prob->n) ? ctx->ls_k : prob->n;
+
+    cand->num_adds = 0;
+    for (int idx = 0; idx < limit && cand->num_adds < EXCHANGE_CANDIDATES; idx++) {
+        const int j = prob->candidate_list[idx];
+        if (sol->x[j] < 0.5f && prob->c[j] > 0.0f) {
+            cand->add_pairs[cand->num_adds][0] = prob->c[j];
+            cand->add_pairs[cand->num_adds][1] = (float)j;
+            cand->adds[cand->num_adds++] = j;
+        }
+    }
+    qsort(cand->add_pairs, cand->num_adds, sizeof(cand->add_pairs[0]), compare_pairs_descending);
+
+    cand->num_drops = 0;
+    for (int idx = prob->n - 1; idx >= 0 && cand->num_drops < EXCHANGE_CANDIDATES; idx--) {
+        const int i = prob->candidate_list[idx];
+        if (sol->x[i] > 0.5f) {
+            cand->drops[cand->num_drops++] = i;
+        }
+    }
+}
+
+/* Internal helper to compute the slack (capacities - usage) of the current solution */
+static void compute_slack(const Problem *prob, const float *usage, float *slack) {
+    for (int k = 0; k < prob->m; k++) {
+        slack[k] = prob->capacities[k] - usage[k];
+    }
+}
+
+/* Internal helper to check whether item j fits in a residual capacity */
+static inline bool fits_residual(const Problem *prob, const float *residual, const int j) {
+    const float *w = &prob->weights_by_item[j * prob->m];
+    for (int k = 0; k < prob->m; k++) {
+        if (w[k] > residual[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Internal helper to check whether items j1 and j2 fit together in a residual capacity */
+static inline bool pair_fits_residual(const Problem *prob, const float *residual, const int j1, const int j2) {
+    const float *w1 = &prob->weights_by_item[j1 * prob->m];
+    const float *w2 = &prob->weights_by_item[j2 * prob->m];
+    for (int k = 0; k < prob->m; k++) {
+        if (w1[k] + w2[k] > residual[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Internal helper to add (sign = 1) or drop (sign = -1) item j, keeping value and usage exact */
+static inline void apply_flip(const Problem *prob, Solution *sol, float *usage, const int j, const float sign) {
+    const float *w = &prob->weights_by_item[j * prob->m];
+    sol->x[j] = (sign > 0.0f) ? 1.0f : 0.0f;
+    sol->value += sign * prob->c[j];
+    for (int k = 0; k < prob->m; k++) {
+        usage[k] += sign * w[k];
+    }
+}
+
+/* Internal helper to update the don't-look bits once a compound search stops */
+static void finish_search(SearchContext *ctx, bool *optimal, const bool changed) {
+    if (changed) {
+        search_context_invalidate(ctx);
+    }
+    *optimal = true;
+}
+
+void local_search_exchange_21_ctx(SearchContext *ctx) {
+    PROFILE_ZONE("exchange_21");
+    if (ctx->drop2_optimal) {
+        return;
+    }
+    const Problem *prob = ctx->prob;
+    const int m = prob->m;
+    float *slack = ctx->ws->ex_slack;
+    float *residual = ctx->ws->ex_residual;
+    ExchangeCandidates cand;
+    bool changed = false;
+
+    while (true) {
+        stats_inc(STAT_LS_ITERATIONS);
+        collect_candidates(ctx, &cand);
+        if (cand.num_adds == 0 || cand.num_drops < 2) {
+            break;
+        }
+        compute_slack(prob, ctx->usage, slack);
+        const float best_c_add = cand.add_pairs[0][0];
+
+        int best_i1 = -1, best_i2 = -1, best_j = -1;
+        float best_gain = 0.0f;
+        uint64_t moves = 0;
+        bool stop = false;
+        for (int a = 0; a < cand.num_drops && !stop; a++) {
+            const int i1 = cand.drops[a];
+            const float *w1 = &prob->weights_by_item[i1 * m];
+            for (int b = a + 1; b < cand.num_drops && !stop; b++) {
+                const int i2 = cand.drops[b];
+                const float removed = prob->c[i1] + prob->c[i2];
+                if (best_c_add - removed <= best_gain) {
+                    continue; // no add can beat the best gain
+                }
+
+                // Residual capacity once both items are dropped
+                const float *w2 = &prob->weights_by_item[i2 * m];
+                for (int k = 0; k < m; k++) {
+                    residual[k] = slack[k] + w1[k] + w2[k];
+                }
+
+                // In profit order, the first add that fits is the best one for this pair
+                for (int o = 0; o < cand.num_adds; o++) {
+                    const float gain = cand.add_pairs[o][0] - removed;
+                    if (gain <= best_gain) {
+                        break;
+                    }
+                    const int j = (int)cand.add_pairs[o][1];
+                    moves++;
+                    if (fits_residual(prob, residual, j)) {
+                        best_i1 = i1;
+                        best_i2 = i2;
+                        best_j = j;
+                        best_gain = gain;
+                        stop = ctx->ls_mode == LS_FIRST_IMPROVEMENT;
+                        break;
+                    }
+                }
+            }
+        }
+        stats_add(STAT_INCREMENTAL_MOVES, moves);
+        if (best_j == -1) {
+            break;
+        }
+
+        apply_flip(prob, ctx->sol, ctx->usage, best_i1, -1.0f);
+        apply_flip(prob, ctx->sol, ctx->usage, best_i2, -1.0f);
+        apply_flip(prob, ctx->sol, ctx->usage, best_j, 1.0f);
+        changed = true;
+        stats_inc(STAT_LS_IMPROVEMENTS);
+    }
+
+    finish_search(ctx, &ctx->drop2_optimal, changed);
+}
+
+void local_search_exchange_12_ctx(SearchContext *ctx) {
+    PROFILE_ZONE("exchange_12");
+    if (ctx->add2_optimal) {
+        return;
+    }
+    const Problem *prob = ctx->prob;
+    const int m = prob->m;
+    float *slack = ctx->ws->ex_slack;
+    float *residual = ctx->ws->ex_residual;
+    ExchangeCandidates cand;
+    int fit[EXCHANGE_CANDIDATES]; // positions in add_pairs of the adds that fit alone
+    bool changed = false;
+
+    while (true) {
+        stats_inc(STAT_LS_ITERATIONS);
+        collect_candidates(ctx, &cand);
+        if (cand.num_adds < 2 || cand.num_drops == 0) {
+            break;
+        }
+        compute_slack(prob, ctx->usage, slack);
+        const float best_two_adds = cand.add_pairs[0][0] + cand.add_pairs[1][0];
+
+        int best_i = -1, best_j1 = -1, best_j2 = -1;
+        float best_gain = 0.0f;
+        uint64_t moves = 0;
+        bool stop = false;
+        for (int a = 0; a < cand.num_drops && !stop; a++) {
+            const int i = cand.drops[a];
+            const float ci = prob->c[i];
+            if (best_two_adds - ci <= best_gain) {
+                continue; // no pair of adds can beat the best gain
+            }
+
+            // Residual capacity once i is dropped, and the adds that fit in it alone
+            const float *w_i = &prob->weights_by_item[i * m];
+            for (int k = 0; k < m; k++) {
+                residual[k] = slack[k] + w_i[k];
+            }
+            int num_fit = 0;
+            for (int o = 0; o < cand.num_adds; o++) {
+                moves++;
+                if (fits_residual(prob, residual, (int)cand.add_pairs[o][1])) {
+                    fit[num_fit++] = o;
+                }
+            }
+
+            // Pairs in profit order: the gain decreases along both indices
+            for (int p = 0; p + 1 < num_fit && !stop; p++) {
+                const float c1 = cand.add_pairs[fit[p]][0];
+                if (c1 + cand.add_pairs[fit[p + 1]][0] - ci <= best_gain) {
+                    break;
+                }
+                for (int q = p + 1; q < num_fit; q++) {
+                    const float gain = c1 + cand.add_pairs[fit[q]][0] - ci;
+                    if (gain <= best_gain) {
+                        break;
+                    }
+                    const int j1 = (int)cand.add_pairs[fit[p]][1];
+                    const int j2 = (int)cand.add_pairs[fit[q]][1];
+                    moves++;
+                    if (pair_fits_residual(prob, residual, j1, j2)) {
+                        best_i = i;
+                        best_j1 = j1;
+                        best_j2 = j2;
+                        best_gain = gain;
+                        stop = ctx->ls_mode == LS_FIRST_IMPROVEMENT;
+                        break;
+                    }
+                }
+            }
+        }
+        stats_add(STAT_INCREMENTAL_MOVES, moves);
+        if (best_i == -1) {
+            break;
+        }
+
+        apply_flip(prob, ctx->sol, ctx->usage, best_i, -1.0f);
+        apply_flip(prob, ctx->sol, ctx->usage, best_j1, 1.0f);
+        apply_flip(prob, ctx->sol, ctx->usage, best_j2, 1.0f);
+        changed = true;
+        stats_inc(STAT_LS_IMPROVEMENTS);
+    }
+
+    finish_search(ctx, &ctx->add2_optimal, changed);
+}
+
+/* Internal helper to check a chain's usage against the capacities */
+static inline bool chain_feasible(const Problem *prob, const float *usage) {
+    for (int k = 0; k < prob->m; k++) {
+        if (usage[k] > prob->capacities[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Internal helper to pick the drop candidate to eject from an infeasible chain: the cheapest one
+ * that restores feasibility, otherwise the one relieving the most normalized excess per unit of
+ * profit. Returns its position in cand->drops, or -1 if no unused drop relieves anything.
+ */
+static int choose_ejection(const Problem *prob, const ExchangeCandidates *cand, const bool *drop_used,
+                           const float *usage, uint64_t *moves) {
+    const int m = prob->m;
+    int best_restoring = -1;
+    int best_relieving = -1;
+    float best_score = 0.0f;
+    for (int d = 0; d < cand->num_drops; d++) {
+        if (drop_used[d]) {
+            continue;
+        }
+        const int i = cand->drops[d];
+        const float *w = &prob->weights_by_item[i * m];
+        bool restores = true;
+        float relief = 0.0f;
+        for (int k = 0; k < m; k++) {
+            const float excess = usage[k] - prob->capacities[k];
+            if (excess > 0.0f) {
+                restores &= w[k] >= excess;
+                relief += ((w[k] < excess) ? w[k] : excess) / prob->capacities[k];
+            }
+        }
+        (*moves)++;
+        if (restores) {
+            if (best_restoring == -1 || prob->c[i] < prob->c[cand->drops[best_restoring]]) {
+                best_restoring = d;
+            }
+        } else if (relief > 0.0f) {
+            const float score = relief / (prob->c[i] + 1e-9f);
+            if (score > best_score) {
+                best_score = score;
+                best_relieving = d;
+            }
+        }
+    }
+    return (best_restoring != -1) ? best_restoring : best_relieving;
+}
+
+/* Internal helper to append a flip to a chain, keeping its usage and gain */
+static inline void chain_push(const Problem *prob, ExchangeChain *chain, float *usage, float *gain,
+                              const int j, const bool add) {
+    const float *w = &prob->weights_by_item[j * prob->m];
+    const float sign = add ? 1.0f : -1.0f;
+    for (int k = 0; k < prob->m; k++) {
+        usage[k] += sign * w[k];
+    }
+    *gain += sign * prob->c[j];
+    chain->items[chain->length] = j;
+    chain->added[chain->length] = add;
+    chain->length++;
+}
+
+void local_search_ejection_ctx(SearchContext *ctx) {
+    PROFILE_ZONE("ejection_chain");
+    if (ctx->chain_optimal) {
+        return;
+    }
+    const Problem *prob = ctx->prob;
+    const int m = prob->m;
+    float *chain_usage = ctx->ws->ex_chain_usage;
+    ExchangeCandidates cand;
+    ExchangeChain chain, best_chain;
+    bool changed = false;
+
+    while (true) {
+        stats_inc(STAT_LS_ITERATIONS);
+        collect_candidates(ctx, &cand);
+        if (cand.num_adds == 0 || cand.num_drops == 0) {
+            break;
+        }
+
+        float best_gain = 0.0f;
+        best_chain.length = 0;
+        uint64_t moves = 0;
+        for (int s = 0; s < cand.num_adds; s++) {
+            bool add_used[EXCHANGE_CANDIDATES] = { false };
+            bool drop_used[EXCHANGE_CANDIDATES] = { false };
+            memcpy(chain_usage, ctx->usage, m * sizeof(float));
+            chain.length = 0;
+            float gain = 0.0f;
+
+            // Push the start in, then eject until feasible, fill, and go on while ejections remain
+            add_used[s] = true;
+            chain_push(prob, &chain, chain_usage, &gain, cand.adds[s], true);
+            int next_add = 0;
+            for (int ejections = 0; ejections < EJECTION_DEPTH; ejections++) {
+                if (!chain_feasible(prob, chain_usage)) {
+                    const int d = choose_ejection(prob, &cand, drop_used, chain_usage, &moves);
+                    if (d == -1) {
+                        break;
+                    }
+                    drop_used[d] = true;
+                    chain_push(prob, &chain, chain_usage, &gain, cand.drops[d], false);
+                    if (!chain_feasible(prob, chain_usage)) {
+                        continue;
+                    }
+                }
+
+                // Feasible: fill the slack with the unused adds, in candidate_list order
+                for (int o = 0; o < cand.num_adds; o++) {
+                    if (add_used[o]) {
+                        continue;
+                    }
+                    const int j = cand.adds[o];
+                    const float *w = &prob->weights_by_item[j * m];
+                    bool fits = true;
+                    for (int k = 0; k < m && fits; k++) {
+                        fits = chain_usage[k] + w[k] <= prob->capacities[k];
+                    }
+                    moves++;
+                    if (fits) {
+                        add_used[o] = true;
+                        chain_push(prob, &chain, chain_usage, &gain, j, true);
+                    }
+                }
+                if (gain > best_gain) {
+                    best_gain = gain;
+                    best_chain = chain;
+                    break;
+                }
+
+                // Not improving: push the next unused add in and eject again
+                while (next_add < cand.num_adds && add_used[next_add]) {
+                    next_add++;
+                }
+                if (next_add == cand.num_adds) {
+                    break;
+                }
+                add_used[next_add] = true;
+                chain_push(prob, &chain, chain_usage, &gain, cand.adds[next_add], true);
+            }
+            if (best_chain.length > 0 && ctx->ls_mode == LS_FIRST_IMPROVEMENT) {
+                break;
+            }
+        }
+        stats_add(STAT_INCREMENTAL_MOVES, moves);
+        if (best_chain.length == 0) {
+            break;
+        }
+
+        for (int op = 0; op < best_chain.length; op++) {
+            apply_flip(prob, ctx->sol, ctx->usage, best_chain.items[op], best_chain.added[op] ? 1.0f : -1.0f);
+        }
+        changed = true;
+        stats_inc(STAT_LS_IMPROVEMENTS);
+    }
+
+    finish_search(ctx, &ctx->chain_optimal, changed);
+}
@@ -6,130 +6,211 @@
 #include "genetic.h"
 #include "data_structure.h"
 #include "utils.h"
+#include "stats.h"
+#include "profiler.h"
 
 #define ELITE_PERCENTAGE 0.05
 #define TOURNAMENT_SIZE 5
 #define PENALTY_FACTOR 1.0f
 
-void genetic_algorithm(const Problem *prob,
-                       Solution *best_sol,
-                       const int population_size,
-                       const int max_generations,
-                       const float mutation_rate,
-                       const clock_t start,
-                       const float max_time,
-                       const LogLevel verbose)
+void ga_init(GaState *st,
+             const Problem *prob,
+             Solution *best_sol,
+             const int population_size,
+             const int max_generations,
+             const float mutation_rate,
+             const LogLevel verbose,
+             const Solution *seed,
+             Workspace *ws)
 {
-    void (*eval_func)(const Problem*, Solution*) = evaluate_solution_cpu;
-
-    // Allocate population
-    Individual *population = malloc(population_size * sizeof(Individual));
-    Individual *new_population = malloc(population_size * sizeof(Individual));
-    // Check for allocation errors
-    if (!population || !new_population) {
-        fprintf(stderr, "Memory allocation error for population.\n");
+    PROFILE_ZONE("ga_init");
+    const uint64_t t0 = stats_phase_begin();
+
+    // Population buffers from the workspace (only allocated if the population grows)
+    if (workspace_reserve_population(ws, population_size) != 0) {
         exit(EXIT_FAILURE);
     }
-    // Allocate memory for solutions within each Individual
-    for(int i = 0; i < population_size; i++) {
-        allocate_solution(&population[i].sol, prob->n);
-        allocate_solution(&new_population[i].sol, prob->n);
-    }
+    Individual *population = ws->ga_population;
 
     // Initialize population
-    ga_init_population(prob, population, population_size, eval_func);
+    ga_init_population(prob, population, population_size, &ws->rng);
+    ga_evaluate_population(prob, population, population_size, ws);
+
+    // Inject the warm-start solution as an individual
+    if (seed) {
+        copy_solution(seed, &population[0].sol);
+        ga_repair(prob, &population[0], ws->ga_usage);
+        ga_evaluate_individual(prob, &population[0], evaluate_solution_cpu);
+    }
 
-    // Track best solution
-    int best_index = 0;
+    // Generations only count as improvements once they beat the initial population
+    float best_fitness = -INFINITY;
+    for (int i = 0; i < population_size; i++) {
+        best_fitness = fmaxf(best_fitness, population[i].fitness);
+    }
+
+    *st = (GaState){
+        .prob = prob, .ws = ws, .best_sol = best_sol,
+        .population_size = population_size, .max_generations = max_generations,
+        .mutation_rate = mutation_rate, .best_elite_fitness = best_fitness, .verbose = verbose
+    };
+    stats_phase_end(PHASE_GA, t0);
+}
 
-    /* GA main loop */
-    for(int gen = 0; gen < max_generations; gen++) {
+bool ga_step(GaState *st, const float budget)
+{
+    return ga_step_units(st, UINT64_MAX, budget);
+}
+
+bool ga_step_units(GaState *st, const uint64_t units, const float budget)
+{
+    PROFILE_ZONE("genetic_algorithm");
+    const uint64_t t0 = stats_phase_begin();
+    const clock_t start = wall_clock();
+    const Problem *prob = st->prob;
+    Workspace *ws = st->ws;
+    const int population_size = st->population_size;
+    Individual *population = ws->ga_population;
+    Individual *new_population = ws->ga_new_population;
+
+    /* GA main loop: at least one generation per step */
+    for (uint64_t unit = 1; st->generation < st->max_generations; unit++) {
+        stats_inc(STAT_GA_GENERATIONS);
         // Keep best 5% of the population
         int elite_count = (int)ceil(ELITE_PERCENTAGE * population_size);
         if (elite_count < 1) {
             elite_count = 1;
         }
 
-        // Create an auxiliary array of pointers to individuals.
-        Individual **sorted_population = malloc(population_size * sizeof(Individual *));
-        if (!sorted_population) {
-            fprintf(stderr, "Memory allocation error for sorted_population.\n");
-            exit(EXIT_FAILURE);
-        }
+        // Auxiliary array of pointers to individuals.
+        Individual **sorted_population = ws->ga_sorted;
         for (int i = 0; i < population_size; i++) {
             sorted_population[i] = &population[i];
         }
 
         // Sort the pointers in descending order by fitness.
         qsort(sorted_population, population_size, sizeof(Individual *), cmp_individual_ptrs_desc);
+        if (sorted_population[0]->fitness > st->best_elite_fitness) {
+            st->best_elite_fitness = sorted_population[0]->fitness;
+            stats_inc(STAT_INCUMBENT_IMPROVEMENTS);
+        }
 
         // Copy the elite individuals (the best elite_count) into new_population.
         for (int i = 0; i < elite_count; i++) {
             ga_copy_individual(sorted_population[i], &new_population[i]);
         }
-        free(sorted_population);
 
         // Fill the rest with new_population
         for(int i = 1; i < population_size; i++) {
             //Selection
-            Individual parent1, parent2;
-            allocate_solution(&parent1.sol, prob->n);
-            allocate_solution(&parent2.sol, prob->n);
+            int parent1, parent2;
+            ga_tournament_selection(population, population_size, TOURNAMENT_SIZE, &ws->rng, &parent1, &parent2);
 
-            ga_tournament_selection(population, population_size, TOURNAMENT_SIZE, &parent1, &parent2);
+            stats_inc(STAT_GA_OFFSPRING);
 
             //Crossover
-            ga_single_point_crossover(prob, &parent1, &parent2, &new_population[i]);
+            ga_single_point_crossover(prob, &population[parent1], &population[parent2], &new_population[i], &ws->rng);
 
             //Mutation
-            ga_mutation(prob, &new_population[i], mutation_rate);
+            ga_mutation(prob, &new_population[i], st->mutation_rate, &ws->rng);
 
-            //Repair & Evaluate new offspring
-            ga_repair(prob, &new_population[i]);
-            ga_evaluate_individual(prob, &new_population[i], eval_func);
-
-            // Free parent's solution memory
-            free_solution(&parent1.sol);
-            free_solution(&parent2.sol);
+            //Repair new offspring
+            ga_repair(prob, &new_population[i], ws->ga_usage);
         }
 
+        // Evaluate all offspring at once
+        ga_evaluate_population(prob, &new_population[1], population_size - 1, ws);
+
         // Swap populations for the next generation
         for(int i = 0; i < population_size; i++) {
             ga_swap_individuals(&population[i], &new_population[i]);
         }
 
+        // Print progress
+        if (st->verbose == DEBUG && (st->generation % 100 == 0)) {
+            printf("[GA] Generation %d: best fitness = %.2f\n", st->generation, st->best_elite_fitness);
+        }
+        st->generation++;
+
         // Check time limit
-        if (time_is_up(start, max_time)) {
-            if (verbose == INFO || verbose == DEBUG) {
-                printf("[GA] Time limit reached at generation %d.\n", gen);
-            }
+        if (unit >= units || time_is_up(start, budget)) {
             break;
         }
+    }
 
-        // Print progress
-        if (verbose == DEBUG && (gen % 100 == 0)) {
-            printf("[GA] Generation %d: best fitness = %.2f\n", gen, population[best_index].fitness);
+    stats_phase_end(PHASE_GA, t0);
+    return st->generation < st->max_generations;
+}
+
+/* Internal helper: index of the fittest individual of the population */
+static int ga_best_index(const GaState *st)
+{
+    const Individual *population = st->ws->ga_population;
+    int best_index = 0;
+    for(int i = 1; i < st->population_size; i++) {
+        if (population[i].fitness > population[best_index].fitness) {
+            best_index = i;
         }
     }
+    return best_index;
+}
 
-    // Find best again after the last generation
-    best_index = 0;
-    float best_fitness = population[0].fitness;
-    for(int i = 1; i < population_size; i++) {
-        if (population[i].fitness > best_fitness) {
-            best_fitness = population[i].fitness;
-            best_index = i;
+StepState ga_state(const GaState *st)
+{
+    return (StepState){
+        .value = st->ws->ga_population[ga_best_index(st)].fitness,
+        .iterations = (uint64_t)st->generation,
+        .done = st->generation >= st->max_generations,
+    };
+}
+
+void ga_finalize(GaState *st)
+{
+    const Individual *population = st->ws->ga_population;
+    copy_solution(&population[ga_best_index(st)].sol, st->best_sol);
+
+    // Feasible individuals of the final population feed the elite pool
+    for (int i = 0; i < st->population_size; i++) {
+        elite_pool_offer(&st->ws->elite, &population[i].sol);
+    }
+}
+
+const Solution *ga_best(const GaState *st)
+{
+    return &st->ws->ga_population[ga_best_index(st)].sol;
+}
+
+void ga_inject(GaState *st, const Solution *sol)
+{
+    Individual *population = st->ws->ga_population;
+    int worst_index = 0;
+    for(int i = 1; i < st->population_size; i++) {
+        if (population[i].fitness < population[worst_index].fitness) {
+            worst_index = i;
         }
     }
-    copy_solution(&population[best_index].sol, best_sol);
+    copy_solution(sol, &population[worst_index].sol);
+    ga_repair(st->prob, &population[worst_index], st->ws->ga_usage);
+    ga_evaluate_individual(st->prob, &population[worst_index], evaluate_solution_cpu);
+}
 
-    // Clean up
-    for(int i = 0; i < population_size; i++) {
-        free_solution(&population[i].sol);
-        free_solution(&new_population[i].sol);
+void genetic_algorithm(const Problem *prob,
+                       Solution *best_sol,
+                       const int population_size,
+                       const int max_generations,
+                       const float mutation_rate,
+                       const clock_t start,
+                       const float max_time,
+                       const LogLevel verbose,
+                       const Solution *seed,
+                       Workspace *ws)
+{
+    GaState st;
+    ga_init(&st, prob, best_sol, population_size, max_generations, mutation_rate, verbose, seed, ws);
+    if (ga_step(&st, time_remaining(start, max_time)) && (verbose == INFO || verbose == DEBUG)) {
+        printf("[GA] Time limit reached at generation %d.\n", st.generation);
     }
-    free(population);
-    free(new_population);
+    ga_finalize(&st);
 }
 
 /* ------------------------------------------------------
@@ -138,23 +219,36 @@ void genetic_algorithm(const Problem *prob,
 void ga_init_population(const Problem *prob,
                                Individual *population,
                                const int population_size,
-                               void (*eval_func)(const Problem*, Solution*))
+                               Rng *rng)
 {
+    PROFILE_ZONE("ga_init_population");
     for (int i = 0; i < population_size; i++) {
         // Random init: each item has 50% chance of being included
         for (int j = 0; j < prob->n; j++) {
-            population[i].sol.x[j] = rand() / (float)RAND_MAX < 0.5f ? 1.0f : 0.0f;
+            population[i].sol.x[j] = rng_uniform(rng) < 0.5f ? 1.0f : 0.0f;
         }
-        // Evaluate the solution
-        eval_func(prob, &population[i].sol);
+    }
+}
 
-        // Compute fitness: use value for feasible solutions, penalize infeasible ones
-        if (population[i].sol.feasible) {
-            population[i].fitness = population[i].sol.value;
+void ga_evaluate_population(const Problem *prob,
+                            Individual *individuals,
+                            const int count,
+                            Workspace *ws)
+{
+    PROFILE_ZONE("ga_evaluate");
+    for (int i = 0; i < count; i++) {
+        ws->eval_batch[i] = &individuals[i].sol;
+    }
+    batch_evaluate(ws->evaluator, prob, ws->eval_batch, count);
+
+    // Compute fitness: use value for feasible solutions, penalize infeasible ones
+    for (int i = 0; i < count; i++) {
+        if (individuals[i].sol.feasible) {
+            individuals[i].fitness = individuals[i].sol.value;
         } else {
             // Penalization seems to give worse results
-            population[i].fitness = 0.0f;
-            //population[i].fitness = population[i].sol.value - compute_penalty(prob, &population[i].sol, PENALTY_FACTOR);
+            individuals[i].fitness = 0.0f;
+            //individuals[i].fitness = individuals[i].sol.value - compute_penalty(prob, &individuals[i].sol, PENALTY_FACTOR);
         }
     }
 }
@@ -163,6 +257,7 @@ void ga_evaluate_individual(const Problem *prob,
                                    Individual *ind,
                                    void (*eval_func)(const Problem*, Solution*))
 {
+    PROFILE_ZONE("ga_evaluate");
     eval_func(prob, &ind->sol);
     if (ind->sol.feasible) {
         ind->fitness = ind->sol.value;
@@ -176,9 +271,11 @@ void ga_evaluate_individual(const Problem *prob,
 void ga_tournament_selection(const Individual *population,
                                const int population_size,
                                const int tournament_size,
-                               Individual *parent1,
-                               Individual *parent2)
+                               Rng *rng,
+                               int *parent1,
+                               int *parent2)
 {
+    PROFILE_ZONE("ga_selection");
     // Ensure at least 2 candidates are selected
     int const t_size = tournament_size < 2 ? 2 : tournament_size;
 
@@ -187,7 +284,7 @@ void ga_tournament_selection(const Individual *population,
     float second_best_fitness = -INFINITY;
 
     for (int i = 0; i < t_size; i++) {
-        const int idx = rand() % population_size;
+        const int idx = rng_below(rng, population_size);
         const float candidate_fitness = population[idx].fitness;
         if (candidate_fitness > best_fitness) {
             // Update second best with the old best
@@ -212,13 +309,14 @@ void ga_tournament_selection(const Individual *population,
         second_best_index = 0;
     }
 
-    // Copy the selected individuals
-    ga_copy_individual(&population[best_index], parent1);
-    ga_copy_individual(&population[second_best_index], parent2);
+    // Return the selected individuals
+    *parent1 = best_index;
+    *parent2 = second_best_index;
 }
 
-void ga_single_point_crossover(const Problem *prob, const Individual *p1, const Individual *p2, Individual *child) {
-    const int point = rand() % prob->n; // random crossover point
+void ga_single_point_crossover(const Problem *prob, const Individual *p1, const Individual *p2, Individual *child, Rng *rng) {
+    PROFILE_ZONE("ga_crossover");
+    const int point = rng_below(rng, prob->n); // random crossover point
 
     for (int j = 0; j < point; j++) {
         child->sol.x[j] = p1->sol.x[j];
@@ -249,25 +347,24 @@ float compute_penalty(const Problem *prob, const Solution *sol, const float pena
     return penalty;
 }
 
-void ga_mutation(const Problem *prob, Individual *ind, const float mutation_rate) {
+void ga_mutation(const Problem *prob, Individual *ind, const float mutation_rate, Rng *rng) {
+    PROFILE_ZONE("ga_mutation");
     for (int j = 0; j < prob->n; j++) {
-        const float r = rand() / (float)RAND_MAX;
+        const float r = rng_uniform(rng);
         if (r < mutation_rate) {
             ind->sol.x[j] = ind->sol.x[j] > 0.5f ? 0.0f : 1.0f;
         }
     }
 }
 
-void ga_repair(const Problem *prob, Individual *ind) {
+void ga_repair(const Problem *prob, Individual *ind, float *usage) {
+    PROFILE_ZONE("ga_repair");
     if (!check_feasibility(prob, &ind->sol)) {
-        float *usage = calloc(prob->m, sizeof(float));
         compute_usage_from_solution(prob, &ind->sol, usage);
 
         float cur_value = ind->sol.value; /* might be negative or 0 if infeasible, but we'll just pass it in */
 
         repair_solution(prob, &ind->sol, usage, &cur_value);
-
-        free(usage);
     }
 }
 
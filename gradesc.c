@@ -1,22 +1,43 @@
 #include <gradesc.h>
 #include <data_structure.h>
 #include <utils.h>              // for evaluate_solution_cpu, etc.
-#include <math.h>               // for expf
-#include <stdlib.h>             // for malloc, free, rand
-#include <stdio.h>              // for fprintf
+#include <stats.h>              // for phase timers
+#include <profiler.h>           // for PROFILE_ZONE
+#include <linalg.h>             // for the batched matrix products
+#include <math.h>               // for fminf, fmaxf
+#include <stdio.h>              // for printf
+#include <string.h>             // for memset
 
 #define CLAMP_VALUE 1.0f
 
 /**
- * @brief Simple sigmoid function with clamping to avoid overflow.
+ * @brief exp(x) for x in [-CLAMP_VALUE, CLAMP_VALUE] = [-1, 1].
+ *
+ * Degree-9 Taylor polynomial in Horner form (relative error below 1e-6 on [-1, 1]): no libm
+ * call and no branch, so loops calling it are vectorized.
+ */
+static inline float exp_unit(const float x) {
+    float p = 1.0f / 362880.0f;
+    p = p * x + 1.0f / 40320.0f;
+    p = p * x + 1.0f / 5040.0f;
+    p = p * x + 1.0f / 720.0f;
+    p = p * x + 1.0f / 120.0f;
+    p = p * x + 1.0f / 24.0f;
+    p = p * x + 1.0f / 6.0f;
+    p = p * x + 0.5f;
+    p = p * x + 1.0f;
+    return p * x + 1.0f;
+}
+
+/**
+ * @brief Sigmoid function with clamping to avoid overflow.
  *
  * @param z The input value (can be negative or positive).
- * @return Sigmoid(z) = 1 / (1 + exp(-z)) clamped to avoid large exponents.
+ * @return Sigmoid(z) = 1 / (1 + exp(-z)), with z clamped to [-CLAMP_VALUE, CLAMP_VALUE].
  */
-static float sigmoid(float z) {
-    if (z > CLAMP_VALUE)  z = CLAMP_VALUE;
-    if (z < -CLAMP_VALUE) z = -CLAMP_VALUE;
-    return 1.0f / (1.0f + expf(-z));
+static inline float sigmoid(float z) {
+    z = fminf(fmaxf(z, -CLAMP_VALUE), CLAMP_VALUE);
+    return 1.0f / (1.0f + exp_unit(-z));
 }
 
 /**
@@ -79,151 +100,340 @@ static void freeze_highest_thetas(const Problem *prob, float *theta, bool *froze
 }
 
 
-void gradient_solver(const Problem *prob,
-                    const float lambda,
-                    const float learning_rate,
-                    const int max_no_improvement,
-                    Solution *out_sol,
-                    const LogLevel verbose,
-                    const clock_t start,
-                    const float max_time) {
+/**
+ * @brief Round logits to a 0-1 solution, then evaluate and repair it.
+ *
+ * A warm-start solution (if any) is returned instead when the rounded result is worse.
+ */
+static void round_and_repair(const Problem *prob, const float *theta, const Solution *init,
+                             Solution *out_sol, float *usage, const LogLevel verbose) {
+    // Now convert final x_hat to a 0-1 solution in out_sol
+    for (int i = 0; i < prob->n; i++) {
+        constexpr float cutoff = 0.5f;
+        const float val = sigmoid(theta[i]);
+        out_sol->x[i] = (val >= cutoff) ? 1.0f : 0.0f;
+    }
 
-    const int n = prob->n;
-    const int m = prob->m;
+    // Recompute usage from the final integer solution
+    compute_usage(prob, out_sol->x, usage);
 
-    // 1) Allocate theta, velocity, etc.
-    const auto theta   = (float*)malloc(n * sizeof(float));
-    const auto v       = (float*)calloc(n, sizeof(float));  // velocity for momentum
-    const auto x_hat   = (float*)malloc(n * sizeof(float));
-    const auto usage   = (float*)malloc(m * sizeof(float));
-    const auto grad    = (float*)malloc(n * sizeof(float));
-    const auto frozen  = (bool*)calloc(n, sizeof(bool)); // we freeze iteratively the highest theta
-    // Check for allocation errors
-    if (!theta || !x_hat || !usage || !grad || !v || !frozen) {
-        fprintf(stderr, "Allocation error in gradient_solver.\n");
-        free(theta); free(x_hat); free(usage); free(grad); free(v);
-        exit(EXIT_FAILURE);
+    // Evaluate objective and feasibility
+    evaluate_solution_cpu(prob, out_sol);
+    out_sol->feasible = check_feasibility(prob, out_sol);
+    if (verbose == DEBUG) {
+        printf("\n--- After Gradient Descent ---\n");
+        printf("Value: %.2f\n", out_sol->value);
+        printf("Feasible: %s\n", out_sol->feasible ? "Yes" : "No");
     }
 
-    // Randomly initialize theta
-    for (int i = 0; i < n; i++) {
-        theta[i] = (float)rand() / (float)RAND_MAX;
+    // Repair if infeasible
+    if (!out_sol->feasible) {
+        repair_solution(prob, out_sol, usage, &out_sol->value);
+        // Re-evaluate after repair
+        evaluate_solution_cpu(prob, out_sol);
+        out_sol->feasible = check_feasibility(prob, out_sol);
+        if (verbose == DEBUG) {
+            printf("--- After Repair ---\n");
+            printf("Value: %.2f\n", out_sol->value);
+            printf("Feasible: %s\n", out_sol->feasible ? "Yes" : "No");
+        }
     }
 
-    int no_improvement = 0;
-    int iter = 0;
-    float previous_loss = 1e9f;
+    // A warm start never makes the result worse than the solution it started from
+    if (init && init->feasible && (!out_sol->feasible || init->value > out_sol->value)) {
+        copy_solution(init, out_sol);
+    }
+}
 
-    // Main loop
-    while (no_improvement < max_no_improvement && !time_is_up(start, max_time)) {
-        constexpr int n_warmup_iters = 10;
-        // Compute x_hat
+
+void gd_init(GdState *st,
+             const Problem *prob,
+             const float lambda,
+             const float learning_rate,
+             const int max_no_improvement,
+             Solution *out_sol,
+             const LogLevel verbose,
+             const Solution *init,
+             Workspace *ws) {
+    const int n = prob->n;
+
+    // Theta, velocity, etc. live in the workspace
+    float *theta = ws->gd_theta;
+    memset(ws->gd_velocity, 0, n * sizeof(float));
+    memset(ws->gd_frozen, 0, n * sizeof(bool));
+
+    // Initialize theta: from the warm-start solution if given (saturated in/out), otherwise randomly
+    if (init) {
         for (int i = 0; i < n; i++) {
-            if (frozen[i]) {// if frozen, interpret sign to fix it in or out
-                x_hat[i] = (theta[i] > 0.0f) ? 1.0f : 0.0f;
-            } else {
-                x_hat[i] = sigmoid(theta[i]);
-            }
+            theta[i] = (init->x[i] > 0.5f) ? CLAMP_VALUE : -CLAMP_VALUE;
         }
+    } else {
+        for (int i = 0; i < n; i++) {
+            theta[i] = rng_uniform(&ws->rng);
+        }
+    }
 
-        // Compute usage
-        compute_usage(prob, x_hat, usage);
+    *st = (GdState){
+        .prob = prob, .ws = ws, .out_sol = out_sol, .init = init,
+        .lambda = lambda, .learning_rate = learning_rate, .max_no_improvement = max_no_improvement,
+        .previous_loss = 1e9f, .profit = -INFINITY, .verbose = verbose
+    };
+}
 
-        // Compute gradient
+bool gd_step(GdState *st, const float budget) {
+    return gd_step_units(st, UINT64_MAX, budget);
+}
+
+bool gd_step_units(GdState *st, const uint64_t units, const float budget) {
+    PROFILE_ZONE("gradient_solver");
+    const uint64_t t0 = stats_phase_begin();
+    const clock_t start = wall_clock();
+    const Problem *prob = st->prob;
+    const int n = prob->n;
+    const int m = prob->m;
+    const float lambda = st->lambda;
+    const float learning_rate = st->learning_rate;
+    Workspace *ws = st->ws;
+    float *theta   = ws->gd_theta;
+    float *v       = ws->gd_velocity;  // velocity for momentum
+    float *x_hat   = ws->gd_x_hat;
+    float *usage   = ws->gd_usage;
+    float *mask    = ws->gd_mask;      // violated constraints (0/1)
+    bool  *frozen  = ws->gd_frozen;    // we freeze iteratively the highest theta
+
+    // Main loop: one pass for x_hat, one for usage, one fused pass for gradient, update and argmax
+    for (uint64_t unit = 0; unit < units && st->no_improvement < st->max_no_improvement &&
+                            !time_is_up(start, budget); unit++) {
+        constexpr int n_warmup_iters = 10;
+
+        // Compute x_hat (branch-free, vectorizable) and the profit part of the loss
+        float profit = 0.0f;
         for (int i = 0; i < n; i++) {
-            if (frozen[i]) {
-                grad[i] = 0.0f;
-            } else {
-                const float s  = x_hat[i];
-                const float ds = s * (1.0f - s);
-                float g  = -prob->c[i] * ds;  // objective part
+            // if frozen, interpret sign to fix it in or out
+            const float x = frozen[i] ? ((theta[i] > 0.0f) ? 1.0f : 0.0f) : sigmoid(theta[i]);
+            x_hat[i] = x;
+            profit += prob->c[i] * x;
+        }
 
-                // penalty part
-                for (int j = 0; j < m; j++) {
-                    const float diff = usage[j] - prob->capacities[j];
-                    const float w_ij = prob->weights[j * n + i];
-                    if (diff > 0.0) g += lambda * w_ij * ds;
-                }
-                grad[i] = g;
+        // Compute usage as a sum of item-major weight rows (contiguous, vectorized over m)
+        memset(usage, 0, m * sizeof(float));
+        for (int i = 0; i < n; i++) {
+            const float x = x_hat[i];
+            const float *w_i = &prob->weights_by_item[i * m];
+            for (int j = 0; j < m; j++) {
+                usage[j] += x * w_i[j];
             }
         }
 
-        // Momentum update
+        // Violated-constraint mask, built once, and the penalty part of the loss
+        float penalty = 0.0f;
+        bool any_violated = false;
+        for (int j = 0; j < m; j++) {
+            const float diff = usage[j] - prob->capacities[j];
+            const bool violated = diff > 0.0f;
+            mask[j] = violated ? 1.0f : 0.0f;
+            penalty += violated ? diff : 0.0f;
+            any_violated |= violated;
+        }
+        const float L = -profit + 0.5f * lambda * penalty;
+
+        // Fused gradient (masked sum over the item's weights), momentum update and argmax of theta
+        int best_idx = -1;
+        float best_theta = -1e9f;
         for (int i = 0; i < n; i++) {
-            if (!frozen[i]) {
-                constexpr float momentum = 0.95f;
-                v[i] = momentum * v[i] + (1.0f - momentum) * grad[i];
-                theta[i] -= learning_rate * v[i];
+            if (frozen[i]) continue;
+            float pen = 0.0f;
+            if (any_violated) {
+                const float *w_i = &prob->weights_by_item[i * m];
+                for (int j = 0; j < m; j++) {
+                    pen += mask[j] * w_i[j];
+                }
+            }
+            constexpr float momentum = 0.95f;
+            const float s  = x_hat[i];
+            const float ds = s * (1.0f - s);
+            const float g  = (-prob->c[i] + lambda * pen) * ds;
+            v[i] = momentum * v[i] + (1.0f - momentum) * g;
+            theta[i] -= learning_rate * v[i];
+            if (theta[i] > best_theta) {
+                best_theta = theta[i];
+                best_idx = i;
             }
         }
 
         // Freeze the highest theta after a few iterations
-        if (iter > n_warmup_iters) freeze_highest_thetas(prob, theta, frozen);
+        if (st->iter > n_warmup_iters && best_idx != -1) {
+            frozen[best_idx] = true;
+            theta[best_idx]  = 1.0f;  // force "in"
+        }
 
-        // Compute loss
-        const float L = compute_loss(prob, lambda, x_hat, usage);
-        if (L >= previous_loss) {
-            no_improvement++;
+        if (L >= st->previous_loss) {
+            st->no_improvement++;
         } else {
-            no_improvement = 0;
+            st->no_improvement = 0;
         }
-        previous_loss = L;
+        st->previous_loss = L;
+        st->profit = profit;
 
         // Print every few iterations
-        if (verbose == DEBUG && (iter % 100 == 0)) {
-            // approximate objective
-            float approx_obj = 0.0f;
-            for (int i = 0; i < n; i++) {
-                approx_obj += prob->c[i] * x_hat[i];
-            }
+        if (st->verbose == DEBUG && (st->iter % 100 == 0)) {
             // count how many items are frozen
             int count_frozen = 0;
             for (int i = 0; i < n; i++) {
                 if (frozen[i]) count_frozen++;
             }
             printf("Iter %3d: Loss=%.2f, approx_obj=%.2f, frozen=%d\n",
-                   iter, L, approx_obj, count_frozen);
+                   st->iter, L, profit, count_frozen);
         }
-        iter++;
+        st->iter++;
     }
 
-    // Now convert final x_hat to a 0-1 solution in out_sol
-    for (int i = 0; i < n; i++) {
-        constexpr float cutoff = 0.5f;
-        const float val = sigmoid(theta[i]);
-        out_sol->x[i] = (val >= cutoff) ? 1.0f : 0.0f;
-    }
+    stats_phase_end(PHASE_GD, t0);
+    return st->no_improvement < st->max_no_improvement;
+}
 
-    // Recompute usage from the final integer solution
-    compute_usage(prob, out_sol->x, usage);
+StepState gd_state(const GdState *st) {
+    return (StepState){
+        .value = st->profit,
+        .iterations = (uint64_t)st->iter,
+        .done = st->no_improvement >= st->max_no_improvement,
+    };
+}
 
-    // Evaluate objective and feasibility
-    evaluate_solution_cpu(prob, out_sol);
-    out_sol->feasible = check_feasibility(prob, out_sol);
-    if (verbose == DEBUG) {
-        printf("\n--- After Gradient Descent ---\n");
-        printf("Value: %.2f\n", out_sol->value);
-        printf("Feasible: %s\n", out_sol->feasible ? "Yes" : "No");
+void gd_finalize(GdState *st) {
+    round_and_repair(st->prob, st->ws->gd_theta, st->init, st->out_sol, st->ws->gd_usage, st->verbose);
+}
+
+void gradient_solver(const Problem *prob,
+                    const float lambda,
+                    const float learning_rate,
+                    const int max_no_improvement,
+                    Solution *out_sol,
+                    const LogLevel verbose,
+                    const clock_t start,
+                    const float max_time,
+                    const Solution *init,
+                    Workspace *ws) {
+    GdState st;
+    gd_init(&st, prob, lambda, learning_rate, max_no_improvement, out_sol, verbose, init, ws);
+    gd_step(&st, time_remaining(start, max_time));
+    gd_finalize(&st);
+}
+
+
+void gradient_solver_batched(const Problem *prob,
+                             const float lambda,
+                             const float learning_rate,
+                             const int max_no_improvement,
+                             const int batch,
+                             const LogLevel verbose,
+                             const clock_t start,
+                             const float max_time,
+                             const Solution *init,
+                             Workspace *ws) {
+    PROFILE_ZONE("gradient_solver_batched");
+    const uint64_t t0 = stats_phase_begin();
+
+    const int n = prob->n;
+    const int m = prob->m;
+
+    float *theta     = ws->gd_batch_theta;
+    float *v         = ws->gd_batch_velocity;
+    float *x_hat     = ws->gd_batch_x_hat;
+    float *grad      = ws->gd_batch_grad;
+    float *usage     = ws->gd_batch_usage;
+    float *mask      = ws->gd_batch_mask;
+    bool  *frozen    = ws->gd_batch_frozen;
+    float *prev_loss = ws->gd_batch_loss;
+    int   *no_improv = ws->gd_batch_no_improv;
+    memset(v, 0, (size_t)batch * n * sizeof(float));
+    memset(frozen, 0, (size_t)batch * n * sizeof(bool));
+
+    // Initialize theta: row 0 from the warm-start solution if given, every other row randomly
+    for (int b = 0; b < batch; b++) {
+        float *theta_b = &theta[(size_t)b * n];
+        for (int i = 0; i < n; i++) {
+            if (b == 0 && init) {
+                theta_b[i] = (init->x[i] > 0.5f) ? CLAMP_VALUE : -CLAMP_VALUE;
+            } else {
+                theta_b[i] = rng_uniform(&ws->rng);
+            }
+        }
+        prev_loss[b] = 1e9f;
+        no_improv[b] = 0;
     }
 
-    // Repair if infeasible
-    if (!out_sol->feasible) {
-        repair_solution(prob, out_sol, usage, &out_sol->value);
-        // Re-evaluate after repair
-        evaluate_solution_cpu(prob, out_sol);
-        out_sol->feasible = check_feasibility(prob, out_sol);
-        if (verbose == DEBUG) {
-            printf("--- After Repair ---\n");
-            printf("Value: %.2f\n", out_sol->value);
-            printf("Feasible: %s\n", out_sol->feasible ? "Yes" : "No");
+    int active = batch;
+    int iter = 0;
+    while (active > 0 && !time_is_up(start, max_time)) {
+        constexpr int n_warmup_iters = 10;
+
+        // Compute x_hat for every row
+        for (size_t k = 0; k < (size_t)batch * n; k++) {
+            x_hat[k] = frozen[k] ? ((theta[k] > 0.0f) ? 1.0f : 0.0f) : sigmoid(theta[k]);
         }
+
+        // Usage of every row at once: U (batch x m) = X_hat (batch x n) * W^T (n x m)
+        linalg_sgemm(batch, m, n, x_hat, n, prob->weights_by_item, m, usage, m);
+
+        // Violated constraints and penalty part of the loss (converged rows get an empty mask)
+        for (int b = 0; b < batch; b++) {
+            const bool row_active = no_improv[b] < max_no_improvement;
+            for (int j = 0; j < m; j++) {
+                const float diff = usage[b * m + j] - prob->capacities[j];
+                mask[b * m + j] = (row_active && diff > 0.0f) ? 1.0f : 0.0f;
+            }
+        }
+
+        // Penalty gradient of every row at once: G (batch x n) = mask (batch x m) * W (m x n)
+        linalg_sgemm(batch, n, m, mask, m, prob->weights, n, grad, n);
+
+        float best_loss = 1e9f;
+        for (int b = 0; b < batch; b++) {
+            if (no_improv[b] >= max_no_improvement) continue;
+            float *theta_b  = &theta[(size_t)b * n];
+            float *v_b      = &v[(size_t)b * n];
+            bool  *frozen_b = &frozen[(size_t)b * n];
+            const float *x_b = &x_hat[(size_t)b * n];
+            const float *g_b = &grad[(size_t)b * n];
+
+            // Gradient and momentum update
+            for (int i = 0; i < n; i++) {
+                if (!frozen_b[i]) {
+                    constexpr float momentum = 0.95f;
+                    const float s  = x_b[i];
+                    const float ds = s * (1.0f - s);
+                    const float g  = (-prob->c[i] + lambda * g_b[i]) * ds;
+                    v_b[i] = momentum * v_b[i] + (1.0f - momentum) * g;
+                    theta_b[i] -= learning_rate * v_b[i];
+                }
+            }
+
+            // Freeze the highest theta after a few iterations
+            if (iter > n_warmup_iters) freeze_highest_thetas(prob, theta_b, frozen_b);
+
+            // Loss of this row
+            const float L = compute_loss(prob, lambda, x_b, &usage[(size_t)b * m]);
+            if (L >= prev_loss[b]) {
+                if (++no_improv[b] >= max_no_improvement) active--;
+            } else {
+                no_improv[b] = 0;
+            }
+            prev_loss[b] = L;
+            if (L < best_loss) best_loss = L;
+        }
+
+        if (verbose == DEBUG && (iter % 100 == 0)) {
+            printf("Iter %3d: best Loss=%.2f, active rows=%d/%d\n", iter, best_loss, active, batch);
+        }
+        iter++;
+    }
+
+    // Round, evaluate and repair every row
+    for (int b = 0; b < batch; b++) {
+        round_and_repair(prob, &theta[(size_t)b * n], (b == 0) ? init : nullptr,
+                         &ws->start_solutions[b], ws->gd_usage, verbose);
     }
 
-    // Cleanup
-    free(theta);
-    free(x_hat);
-    free(usage);
-    free(grad);
-    free(v);
-    free(frozen);
+    stats_phase_end(PHASE_GD, t0);
 }
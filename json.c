@@ -0,0 +1,251 @@
+//
+// Minimal recursive-descent JSON reader (for the mkp_server request protocol).
+//
+#include <json.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JSON_MAX_DEPTH 64
+
+typedef struct {
+    const char *p;
+    const char *error;
+} JsonParser;
+
+static void skip_ws(JsonParser *ps) {
+    while (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r') ps->p++;
+}
+
+static int parse_value(JsonParser *ps, JsonValue *out, int depth);
+
+/* Internal helper to append an item (and optionally a key) to an array/object value */
+static JsonValue *push_item(JsonValue *v, char *key) {
+    if (v->count == 0 || (v->count >= 4 && (v->count & (v->count - 1)) == 0)) { // grow at powers of two
+        const int cap = v->count ? 2 * v->count : 4;
+        JsonValue *items = realloc(v->items, cap * sizeof(JsonValue));
+        if (!items) return nullptr;
+        v->items = items;
+        if (v->type == JSON_OBJECT) {
+            char **keys = realloc(v->keys, cap * sizeof(char *));
+            if (!keys) return nullptr;
+            v->keys = keys;
+        }
+    }
+    if (v->type == JSON_OBJECT) v->keys[v->count] = key;
+    JsonValue *item = &v->items[v->count++];
+    memset(item, 0, sizeof(*item));
+    return item;
+}
+
+static char *parse_string(JsonParser *ps) {
+    if (*ps->p != '"') {
+        ps->error = "expected string";
+        return nullptr;
+    }
+    ps->p++;
+
+    // Upper bound on the decoded length is the raw length
+    const char *end = ps->p;
+    while (*end && *end != '"') {
+        if (*end == '\\' && end[1]) end++;
+        end++;
+    }
+    if (*end != '"') {
+        ps->error = "unterminated string";
+        return nullptr;
+    }
+    char *str = malloc((size_t)(end - ps->p) + 1);
+    if (!str) {
+        ps->error = "out of memory";
+        return nullptr;
+    }
+
+    size_t len = 0;
+    while (ps->p < end) {
+        char ch = *ps->p++;
+        if (ch == '\\') {
+            const char esc = *ps->p++;
+            switch (esc) {
+                case 'n': ch = '\n'; break;
+                case 't': ch = '\t'; break;
+                case 'r': ch = '\r'; break;
+                case 'b': ch = '\b'; break;
+                case 'f': ch = '\f'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    for (int k = 0; k < 4 && ps->p < end; k++) {
+                        const char h = *ps->p++;
+                        code <<= 4;
+                        if (h >= '0' && h <= '9') code |= (unsigned)(h - '0');
+                        else if (h >= 'a' && h <= 'f') code |= (unsigned)(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') code |= (unsigned)(h - 'A' + 10);
+                    }
+                    ch = (code < 0x80) ? (char)code : '?';
+                    break;
+                }
+                default: ch = esc; break; // '"', '\\', '/'
+            }
+        }
+        str[len++] = ch;
+    }
+    str[len] = '\0';
+    ps->p = end + 1;
+    return str;
+}
+
+static int parse_value(JsonParser *ps, JsonValue *out, const int depth) {
+    memset(out, 0, sizeof(*out));
+    if (depth > JSON_MAX_DEPTH) {
+        ps->error = "nesting too deep";
+        return -1;
+    }
+    skip_ws(ps);
+
+    const char ch = *ps->p;
+    if (ch == '{' || ch == '[') {
+        const bool is_object = (ch == '{');
+        const char close = is_object ? '}' : ']';
+        out->type = is_object ? JSON_OBJECT : JSON_ARRAY;
+        ps->p++;
+        skip_ws(ps);
+        if (*ps->p == close) {
+            ps->p++;
+            return 0;
+        }
+        while (true) {
+            char *key = nullptr;
+            if (is_object) {
+                skip_ws(ps);
+                key = parse_string(ps);
+                if (!key) return -1;
+                skip_ws(ps);
+                if (*ps->p != ':') {
+                    free(key);
+                    ps->error = "expected ':'";
+                    return -1;
+                }
+                ps->p++;
+            }
+            JsonValue *item = push_item(out, key);
+            if (!item) {
+                free(key);
+                ps->error = "out of memory";
+                return -1;
+            }
+            if (parse_value(ps, item, depth + 1) != 0) return -1;
+            skip_ws(ps);
+            if (*ps->p == ',') {
+                ps->p++;
+                continue;
+            }
+            if (*ps->p == close) {
+                ps->p++;
+                return 0;
+            }
+            ps->error = is_object ? "expected ',' or '}'" : "expected ',' or ']'";
+            return -1;
+        }
+    }
+    if (ch == '"') {
+        out->type = JSON_STRING;
+        out->string = parse_string(ps);
+        return out->string ? 0 : -1;
+    }
+    if (strncmp(ps->p, "true", 4) == 0) {
+        out->type = JSON_BOOL;
+        out->number = 1.0;
+        ps->p += 4;
+        return 0;
+    }
+    if (strncmp(ps->p, "false", 5) == 0) {
+        out->type = JSON_BOOL;
+        ps->p += 5;
+        return 0;
+    }
+    if (strncmp(ps->p, "null", 4) == 0) {
+        out->type = JSON_NULL;
+        ps->p += 4;
+        return 0;
+    }
+
+    char *end;
+    out->number = strtod(ps->p, &end);
+    if (end == ps->p) {
+        ps->error = "unexpected character";
+        return -1;
+    }
+    out->type = JSON_NUMBER;
+    ps->p = end;
+    return 0;
+}
+
+int json_parse(const char *text, JsonValue *out, const char **error) {
+    JsonParser ps = { .p = text, .error = nullptr };
+    int rc = parse_value(&ps, out, 0);
+    if (rc == 0) {
+        skip_ws(&ps);
+        if (*ps.p != '\0') {
+            ps.error = "trailing characters";
+            rc = -1;
+        }
+    }
+    if (rc != 0) {
+        json_free(out);
+        if (error) *error = ps.error;
+    }
+    return rc;
+}
+
+void json_free(JsonValue *value) {
+    if (!value) return;
+    for (int i = 0; i < value->count; i++) {
+        json_free(&value->items[i]);
+        if (value->keys) free(value->keys[i]);
+    }
+    free(value->items);
+    free(value->keys);
+    free(value->string);
+    memset(value, 0, sizeof(*value));
+}
+
+const JsonValue *json_get(const JsonValue *object, const char *key) {
+    if (!object || object->type != JSON_OBJECT) return nullptr;
+    for (int i = 0; i < object->count; i++) {
+        if (strcmp(object->keys[i], key) == 0) return &object->items[i];
+    }
+    return nullptr;
+}
+
+double json_get_number(const JsonValue *object, const char *key, const double def) {
+    const JsonValue *v = json_get(object, key);
+    return (v && (v->type == JSON_NUMBER || v->type == JSON_BOOL)) ? v->number : def;
+}
+
+const char *json_get_string(const JsonValue *object, const char *key, const char *def) {
+    const JsonValue *v = json_get(object, key);
+    return (v && v->type == JSON_STRING) ? v->string : def;
+}
+
+int json_to_floats(const JsonValue *array, float *out, const int count) {
+    if (!array || array->type != JSON_ARRAY || array->count != count) return -1;
+    for (int i = 0; i < count; i++) {
+        if (array->items[i].type != JSON_NUMBER) return -1;
+        out[i] = (float)array->items[i].number;
+    }
+    return count;
+}
+
+void json_write_string(FILE *fout, const char *str) {
+    fputc('"', fout);
+    for (const char *p = str; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', fout);
+            fputc(*p, fout);
+        } else if ((unsigned char)*p < 0x20) {
+            fprintf(fout, "\\u%04x", (unsigned char)*p);
+        } else {
+            fputc(*p, fout);
+        }
+    }
+    fputc('"', fout);
+}
@@ -0,0 +1,53 @@
+#ifndef BATCH_EVAL_H
+#define BATCH_EVAL_H
+
+#include <data_structure.h>
+
+/**
+ * @brief Available batch evaluation backends.
+ */
+typedef enum {
+    BATCH_EVAL_BITPACKED, /**< Bit-packed solutions, masked adds over each weight row (default) */
+    BATCH_EVAL_DENSE      /**< Dense X * W^T through linalg_sgemm (OpenBLAS when built with it) */
+} BatchBackend;
+
+/**
+ * @brief Scores many candidate solutions in one call.
+ *
+ * Solutions are processed in tiles of BATCH_EVAL_TILE: each weight row is loaded once per tile
+ * and reused for every solution of the tile, instead of once per solution. A backend is created
+ * for a problem size and owns its scratch buffers, so evaluating performs no allocation.
+ */
+typedef struct BatchEvaluator BatchEvaluator;
+struct BatchEvaluator {
+    const char *name; /**< Backend name, e.g. for logs */
+
+    /**
+     * @brief Compute value = c^T x and feasibility (W x <= capacities) of count solutions.
+     */
+    void (*evaluate)(BatchEvaluator *self, const Problem *prob, Solution *const *sols, int count);
+
+    /** @brief Free the evaluator and its buffers. */
+    void (*destroy)(BatchEvaluator *self);
+};
+
+/** Number of solutions evaluated together. */
+#define BATCH_EVAL_TILE 32
+
+/**
+ * @brief Create an evaluator for problems of prob's size.
+ * @return The evaluator, or NULL on allocation error.
+ */
+BatchEvaluator *batch_evaluator_create(BatchBackend backend, const Problem *prob);
+
+/**
+ * @brief Evaluate count solutions (sets value and feasible of each).
+ */
+void batch_evaluate(BatchEvaluator *eval, const Problem *prob, Solution *const *sols, int count);
+
+/**
+ * @brief Free an evaluator (NULL is allowed).
+ */
+void batch_evaluator_destroy(BatchEvaluator *eval);
+
+#endif // BATCH_EVAL_H
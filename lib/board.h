@@ -0,0 +1,116 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <data_structure.h>
+
+/** Number of solutions kept by a solution board. */
+#define BOARD_SIZE 8
+
+/**
+ * @brief A slot of the board: a seqlock over one packed solution and its value.
+ *
+ * The low 32 bits of seq count the writes, and are odd while a writer fills the slot; the high 32
+ * bits hold the pid of the last writer, so that a slot left odd by a process that died during a
+ * write can be recognised and emptied (this needs every process sharing the board to be in the
+ * same PID namespace). A writer releases its slot by a compare-and-swap from the sequence number
+ * it claimed, which fails if the slot was emptied meanwhile. Slots are cache-line aligned so that
+ * publishing to one slot does not slow down the readers of another.
+ */
+typedef struct {
+    alignas(64) _Atomic uint64_t seq;  /**< Writer pid and write count, odd count during a write */
+    _Atomic float value;               /**< Objective value of the solution (-inf if empty) */
+} BoardSlot;
+
+/**
+ * @brief A bounded, versioned set of good solutions shared by concurrent searches, without locks.
+ *
+ * Readers never block writers and writers never wait: a read copies a slot and retries if its
+ * sequence number changed meanwhile (seqlock); a publish claims the worst slot by a
+ * compare-and-swap of its sequence number and gives up if another writer holds it. Every
+ * successful publish bumps the board's version, so a search can check for news with one atomic
+ * load. The words of the packed solutions are atomics too (relaxed), so concurrent reads and
+ * writes are well defined; a torn read is detected by the sequence number and retried.
+ *
+ * The version, the slots and the packed solutions live in one block of solution_board_bytes()
+ * bytes, holding no pointers: a board can be attached to a block shared by several processes
+ * (see shm.h), whose atomics are then the only means of exchange.
+ */
+typedef struct {
+    int n;                             /**< Number of items */
+    int words;                         /**< 64-bit words per packed solution */
+    int capacity;                      /**< Number of slots */
+    _Atomic uint64_t *version;         /**< Number of successful publishes */
+    BoardSlot *slots;                  /**< The slots, capacity of them */
+    _Atomic uint64_t *bits;            /**< Packed solutions, capacity x words */
+    void *memory;                      /**< The block holding all of the above */
+    bool owned;                        /**< Whether the block was allocated by solution_board_init */
+} SolutionBoard;
+
+/**
+ * @brief Allocate an empty board for solutions of n items.
+ * @return 0 on success, non-zero on allocation error.
+ */
+int solution_board_init(SolutionBoard *board, int capacity, int n);
+
+/**
+ * @brief Size of the block of a board (a multiple of 64 bytes).
+ */
+size_t solution_board_bytes(int capacity, int n);
+
+/**
+ * @brief Use a block of solution_board_bytes(capacity, n) bytes, aligned on 64 bytes, as a board.
+ *
+ * The block is not cleared: it may hold a board already in use by another process.
+ */
+void solution_board_attach(SolutionBoard *board, int capacity, int n, void *memory);
+
+/**
+ * @brief Free the buffers of a board (an attached block is left alone).
+ */
+void solution_board_free(SolutionBoard *board);
+
+/**
+ * @brief Empty every slot (not concurrently with other calls).
+ */
+void solution_board_clear(SolutionBoard *board);
+
+/**
+ * @brief Publish a solution: it replaces the worst slot if it is better and is not already there.
+ *
+ * Infeasible solutions are ignored. Never waits: returns false if the slot is being written. A
+ * slot whose writer process died during a write is emptied first, and taken.
+ *
+ * @return true if the solution entered the board.
+ */
+bool solution_board_publish(SolutionBoard *board, const Solution *sol);
+
+/**
+ * @brief Number of successful publishes so far.
+ */
+static inline uint64_t solution_board_version(const SolutionBoard *board) {
+    return atomic_load_explicit(board->version, memory_order_acquire);
+}
+
+/**
+ * @brief Index of the best slot, or -1 if the board is empty.
+ */
+int solution_board_best(const SolutionBoard *board);
+
+/**
+ * @brief Value of slot s (-inf if empty), without copying it.
+ */
+static inline float solution_board_value(const SolutionBoard *board, const int s) {
+    return atomic_load_explicit(&board->slots[s].value, memory_order_relaxed);
+}
+
+/**
+ * @brief Copy slot s into sol (x, value and feasible).
+ * @return false if the slot is empty, or was rewritten during every attempt.
+ */
+bool solution_board_read(const SolutionBoard *board, int s, Solution *sol);
+
+#endif // BOARD_H
@@ -0,0 +1,67 @@
+#ifndef COOP_H
+#define COOP_H
+
+#include <time.h>
+#include <mkp.h>
+#include <workspace.h>
+#include <board.h>
+
+/** Length of one step of a cooperative worker, in seconds. */
+#define COOP_STEP 0.02f
+
+/** Steps of a worker between two looks at the solution board. */
+#define COOP_IMPORT_PERIOD 10
+
+/** Iterations of a worker's method per step, in deterministic runs. */
+#define COOP_STEP_UNITS 5
+
+/** Rounds without a better board solution before a deterministic run stops. */
+#define COOP_PATIENCE 10
+
+/**
+ * @brief Kinds of workers of the cooperative search.
+ */
+typedef enum {
+    COOP_VNS,     /**< VNS on the board's best solution, restarted from it when done */
+    COOP_GA,      /**< GA seeded with the board's best, fed random board members */
+    COOP_LS,      /**< GD from random starts, each result improved by VND */
+    COOP_ROLES
+} CoopRole;
+
+/**
+ * @brief Cooperative parallel search: heterogeneous workers sharing a lock-free solution board.
+ *
+ * Thread t runs the worker of role t % COOP_ROLES; with fewer threads than roles, thread t runs
+ * every role r with r % threads == t, interleaving their steps. Each worker is a steppable method
+ * (see step.h) on its thread's workspace, run in steps of COOP_STEP seconds. After a step, a
+ * worker whose solution improved publishes it to the board (see board.h), and every
+ * COOP_IMPORT_PERIOD steps it checks the board's version: if anything was published meanwhile,
+ * VNS restarts from the board's best solution when it is better than its own, and GA injects a
+ * random board member in place of its least fit individual. The LS worker only publishes: its
+ * random starts keep the board diverse. Workers that meet their own stopping rule restart
+ * (VNS and GA from the board's best), so the whole budget is used.
+ *
+ * With params->deterministic, the run is a sequence of rounds: the threads exchange with the board
+ * one at a time, in thread order, then each runs COOP_IMPORT_PERIOD steps of COOP_STEP_UNITS
+ * iterations without touching the board. The run stops after COOP_PATIENCE rounds without a better
+ * board solution (or when time is up), so its result does not depend on the timing of the threads.
+ *
+ * @param prob     The problem instance.
+ * @param params   Parameters of the workers.
+ * @param best_sol The starting solution (feasible), replaced by the board's best at the end.
+ * @param start    The start time for the time limit.
+ * @param max_time The maximum allowed time in seconds.
+ * @param board    The board of the workers, not cleared: ws->board, or a board shared with other
+ *                 processes (see shm.h), whose solutions the workers then use too.
+ * @param ws       Workspace of the calling thread; its pool, if any, runs the workers.
+ * @param workers  Workspaces of the other pool threads, thread_pool_size(ws->pool) - 1 of them.
+ */
+void coop(const Problem *prob, const MkpParams *params, Solution *best_sol,
+          clock_t start, float max_time, SolutionBoard *board, Workspace *ws, Workspace *workers);
+
+/**
+ * @brief Name of a cooperative worker role (e.g. "VNS"), for logs.
+ */
+const char *coop_role_name(CoopRole role);
+
+#endif // COOP_H
@@ -1,6 +1,17 @@
 #ifndef DATA_STRUCTURE_H
 #define DATA_STRUCTURE_H
 
+/**
+ * @brief Orderings of the items (see order.h).
+ */
+typedef enum {
+    ORDER_RATIO,  /**< By c_j / sum_i w_ij */
+    ORDER_SCALED, /**< By c_j / sum_i (w_ij / b_i) */
+    ORDER_DUAL,   /**< By c_j / sum_i (mu_i w_ij), mu an estimate of the LP dual prices */
+    ORDER_PROFIT, /**< By c_j */
+    ORDER_COUNT
+} ItemOrder;
+
 /**
  * @brief Represents the MKP problem data.
  */
@@ -10,9 +21,15 @@ typedef struct {
     float *c;               /**< Objective coefficients, length n */
     float *capacities;      /**< Capacities for each constraint, length m */
     float *weights;         /**< Weights matrix, length m*n, row-major: W[i,j] = weights[i*n+j] */
+    float *weights_by_item; /**< Transposed copy, length n*m, item-major: W[i,j] = weights_by_item[j*m+i] */
     float *sum_of_weights;  /**< length n, sum of each item's weight across all constraints */
     float *ratios;          /**< length n, ratio c[j] / sum_of_weights[j] */
-    float *candidate_list;  /**< length n, indexes of items sorted by ratio */
+    float *scaled_ratios;   /**< length n, surrogate ratio c[j] / sum_i (W[i,j] / capacities[i]) */
+    float *dual_ratios;     /**< length n, surrogate ratio c[j] / sum_i (duals[i] * W[i,j]) */
+    float *duals;           /**< length m, estimate of the dual prices of the LP relaxation */
+    int *orders[ORDER_COUNT]; /**< length n each, item indexes by decreasing key of each ordering */
+    ItemOrder order;        /**< The active ordering */
+    int *candidate_list;    /**< length n, the active ordering (orders[order]) */
 } Problem;
 
 /**
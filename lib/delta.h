@@ -0,0 +1,53 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <data_structure.h>
+
+/**
+ * @brief A small perturbation of a loaded problem.
+ *
+ * Changes are applied in this order: capacities, profits, removals, additions. Capacity and
+ * profit indices, as well as removed items, refer to the problem before the delta. Added items
+ * are appended after the remaining items, in the given order.
+ */
+typedef struct {
+    int num_capacities;           /**< Number of changed capacities */
+    const int *capacity_idx;      /**< Constraint indices (0-based), length num_capacities */
+    const float *capacity_values; /**< New capacities, length num_capacities */
+
+    int num_profits;              /**< Number of changed profits */
+    const int *profit_idx;        /**< Item indices (0-based), length num_profits */
+    const float *profit_values;   /**< New profits, length num_profits */
+
+    int num_removed;              /**< Number of removed items */
+    const int *removed;           /**< Item indices (0-based), length num_removed */
+
+    int num_added;                /**< Number of added items */
+    const float *added_c;         /**< Profits of the added items, length num_added */
+    const float *added_weights;   /**< Weights of the added items, item-major: length num_added*m */
+} ProblemDelta;
+
+/**
+ * @brief Apply a delta to a problem in place, keeping an optional solution in sync.
+ *
+ * The derived arrays are updated incrementally: sum_of_weights and the order keys only for the
+ * touched items, and each touched item is moved to its new rank in every ordering (order.h)
+ * instead of re-sorting. Removals compact both weight layouts in place; additions relayout the
+ * row-major matrix once and append to the item-major copy. Capacity changes alter the scaled and
+ * dual keys of every item, so they trigger a full rebuild of the orderings instead.
+ *
+ * If sol and usage are given, sol is remapped to the new item indices (added items are left
+ * out), and its value and usage are updated with the removed and re-priced items. The solution
+ * may become infeasible if capacities decreased; usage is kept exact so it can be repaired
+ * directly.
+ *
+ * @param prob  The problem to update.
+ * @param delta The changes.
+ * @param sol   Optional solution of prob (its x array is reallocated when items are added).
+ * @param usage Optional usage of sol, length m.
+ * @return 0 on success, non-zero if the delta is invalid (the problem is then left unchanged)
+ *         or on allocation error.
+ */
+int problem_apply_delta(Problem *prob, const ProblemDelta *delta, Solution *sol, float *usage);
+
+#endif // DELTA_H
@@ -0,0 +1,77 @@
+#ifndef ELITE_H
+#define ELITE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <data_structure.h>
+
+/** Number of solutions kept by an elite pool. */
+#define ELITE_POOL_SIZE 10
+
+/**
+ * @brief A bounded set of good, mutually distant feasible solutions.
+ *
+ * Solutions are stored as packed bits (64 items per word), so the Hamming distance between two of
+ * them is a popcount over n/64 words. A solution offered to a full pool must beat its worst
+ * member. If it is closer than min_distance to some member, it replaces that member only if it is
+ * better (so near-duplicates compete with each other instead of crowding the pool out); otherwise
+ * it replaces the worst member.
+ */
+typedef struct {
+    int n;                /**< Number of items */
+    int words;            /**< 64-bit words per packed solution */
+    int capacity;         /**< Maximum number of members */
+    int count;            /**< Current number of members */
+    int min_distance;     /**< Members closer than this to an offered solution are its near-duplicates */
+    uint64_t *bits;       /**< Packed members, capacity x words */
+    float *values;        /**< Objective value of each member */
+    uint64_t *ids;        /**< Insertion number of each member (larger = more recent) */
+    uint64_t next_id;     /**< Insertion number of the next member */
+    uint64_t *scratch;    /**< Packed offered solution, words */
+} ElitePool;
+
+/**
+ * @brief Allocate a pool for solutions of n items.
+ * @return 0 on success, non-zero on allocation error.
+ */
+int elite_pool_init(ElitePool *pool, int capacity, int n);
+
+/**
+ * @brief Free the buffers of a pool.
+ */
+void elite_pool_free(ElitePool *pool);
+
+/**
+ * @brief Remove every member.
+ */
+void elite_pool_clear(ElitePool *pool);
+
+/**
+ * @brief Offer a solution to the pool (infeasible solutions are ignored).
+ * @return true if the solution entered the pool.
+ */
+bool elite_pool_offer(ElitePool *pool, const Solution *sol);
+
+/**
+ * @brief Index of the best member, or -1 if the pool is empty.
+ */
+int elite_pool_best(const ElitePool *pool);
+
+/**
+ * @brief Hamming distance between two members.
+ */
+int elite_pool_distance(const ElitePool *pool, int a, int b);
+
+/**
+ * @brief Whether item j is selected in member e.
+ */
+static inline bool elite_pool_selected(const ElitePool *pool, const int e, const int j) {
+    return (pool->bits[(size_t)e * pool->words + (j >> 6)] >> (j & 63)) & 1u;
+}
+
+/**
+ * @brief Copy member e into sol (x, value and feasible).
+ */
+void elite_pool_get(const ElitePool *pool, int e, Solution *sol);
+
+#endif // ELITE_H
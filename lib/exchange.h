@@ -0,0 +1,46 @@
+#ifndef EXCHANGE_H
+#define EXCHANGE_H
+
+#include <search_context.h>
+
+/** Number of add (best-ranked unselected) and drop (worst-ranked selected) candidates considered. */
+#define EXCHANGE_CANDIDATES 32
+
+/** Maximum number of ejections of an ejection chain. */
+#define EJECTION_DEPTH 3
+
+/*
+ * Compound neighborhoods, used as the deeper VND levels. All of them work on a restricted
+ * candidate set taken from candidate_list: the first EXCHANGE_CANDIDATES unselected items of the
+ * window (adds) and the last EXCHANGE_CANDIDATES selected items of the ordering (drops). Moves are
+ * checked against the slack of the current solution in O(m) each, and only feasible, strictly
+ * improving moves are applied (no repair). Each one loops until no move improves, then sets its
+ * don't-look bit; it returns at once if that bit is already set.
+ */
+
+/**
+ * @brief 2-1 exchanges: drop two selected items, add one unselected item.
+ * @param ctx The search context (ls_k and ls_mode are used, sol and usage are updated).
+ */
+void local_search_exchange_21_ctx(SearchContext *ctx);
+
+/**
+ * @brief 1-2 exchanges: drop one selected item, add two unselected items.
+ * @param ctx The search context (ls_k and ls_mode are used, sol and usage are updated).
+ */
+void local_search_exchange_12_ctx(SearchContext *ctx);
+
+/**
+ * @brief Ejection chains of at most EJECTION_DEPTH ejections.
+ *
+ * From each add candidate: add it, then eject drop candidates (the cheapest one that restores
+ * feasibility, else the one that relieves the most normalized excess per unit of profit) until
+ * the chain is feasible, then fill the slack greedily with the remaining add candidates. If the
+ * chain does not improve and ejections remain, the next add candidate is pushed in and the chain
+ * goes on.
+ *
+ * @param ctx The search context (ls_k and ls_mode are used, sol and usage are updated).
+ */
+void local_search_ejection_ctx(SearchContext *ctx);
+
+#endif // EXCHANGE_H
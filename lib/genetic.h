@@ -3,18 +3,20 @@
 
 #include "data_structure.h"
 #include "utils.h"
+#include "workspace.h"
+#include "step.h"
 
 /**
  * @brief Runs a Genetic Algorithm (GA) to solve the MKP.
  *
  * Steps:
- * - Initialize the population and evaluate each individual.
+ * - Initialize the population and evaluate it in one batch.
  * - Loop :
  *    - Identify and save the best individuals from the current population so they survive.
  *    - For each new offspring to be generated, select its parents, apply crossover and mutation.
  *    - Repair the offspring if necessary.
- *    - Evaluate the offspring.
  *    - Place the offspring in the new population.
+ *    - Evaluate all offspring of the generation in one batch (ws->evaluator).
  *
  * @param prob            The MKP problem instance.
  * @param best_sol        Output: the best solution found by the GA.
@@ -24,6 +26,8 @@
  * @param start           The start time (to check against max_time).
  * @param max_time        The maximum allowed time in seconds.
  * @param verbose         Verbosity level (NONE, INFO, DEBUG).
+ * @param seed            Optional warm-start solution injected into the initial population (may be NULL).
+ * @param ws              Workspace providing the population buffers and the random generator.
  *
  * @note On completion, best_sol will hold the best solution found.
  */
@@ -34,15 +38,89 @@ void genetic_algorithm(const Problem *prob,
                        float mutation_rate,
                        clock_t start,
                        float max_time,
-                       LogLevel verbose);
+                       LogLevel verbose,
+                       const Solution *seed,
+                       Workspace *ws);
 
 /**
- * @brief Randomly initialize the population, evaluate each individual.
+ * @brief Explicit state of a steppable GA run (see step.h).
+ *
+ * The population lives in the workspace's GA buffers; the state counts the generations.
+ */
+typedef struct {
+    const Problem *prob;       /**< The problem instance */
+    Workspace *ws;             /**< Workspace holding the population and the random generator */
+    Solution *best_sol;        /**< Output of ga_finalize */
+    int population_size;       /**< Individuals per generation */
+    int max_generations;       /**< Generations before the run is done */
+    int generation;            /**< Generations run so far */
+    float mutation_rate;       /**< Probability of mutating each bit of an offspring */
+    float best_elite_fitness;  /**< Best fitness of the initial population or at the start of a generation */
+    LogLevel verbose;          /**< Verbosity level */
+} GaState;
+
+/**
+ * @brief Start a GA run: initialize and evaluate the population, inject seed if given.
+ * @param st              The state to set up.
+ * @param prob            The MKP problem instance.
+ * @param best_sol        Output of ga_finalize: the best solution found by the GA.
+ * @param population_size The number of individuals in the population.
+ * @param max_generations The maximum number of generations to run.
+ * @param mutation_rate   Probability of mutating each bit (gene) in an offspring.
+ * @param verbose         Verbosity level (NONE, INFO, DEBUG).
+ * @param seed            Optional warm-start solution injected into the initial population (may be NULL).
+ * @param ws              Workspace providing the population buffers and the random generator.
+ */
+void ga_init(GaState *st, const Problem *prob, Solution *best_sol, int population_size, int max_generations,
+             float mutation_rate, LogLevel verbose, const Solution *seed, Workspace *ws);
+
+/**
+ * @brief Run generations until budget seconds are spent (at least one generation per call).
+ * @return true if the run is not done yet.
+ */
+bool ga_step(GaState *st, float budget);
+
+/**
+ * @brief Run at most units generations, within budget seconds (at least one generation per call).
+ * @return true if the run is not done yet.
+ */
+bool ga_step_units(GaState *st, uint64_t units, float budget);
+
+/**
+ * @brief Progress of a GA run (value is the best fitness of the population, O(population_size)).
+ */
+StepState ga_state(const GaState *st);
+
+/**
+ * @brief End a GA run: copy the fittest individual to best_sol and offer the population to the elite pool.
+ */
+void ga_finalize(GaState *st);
+
+/**
+ * @brief Fittest individual of a live GA run (valid until the next step), O(population_size).
+ */
+const Solution *ga_best(const GaState *st);
+
+/**
+ * @brief Replace the least fit individual of a live GA run by a (repaired) copy of sol.
+ */
+void ga_inject(GaState *st, const Solution *sol);
+
+/**
+ * @brief Randomly initialize the population (evaluate it with ga_evaluate_population).
  */
 void ga_init_population(const Problem *prob,
                                Individual *population,
                                int population_size,
-                               void (*eval_func)(const Problem*, Solution*));
+                               Rng *rng);
+
+/**
+ * @brief Evaluate count individuals with the workspace's batch evaluator (updates fitness).
+ */
+void ga_evaluate_population(const Problem *prob,
+                            Individual *individuals,
+                            int count,
+                            Workspace *ws);
 
 /**
  * @brief Evaluate an individual's solution (updates fitness).
@@ -57,14 +135,16 @@ void ga_evaluate_individual(const Problem *prob,
  * @param population       The current population.
  * @param population_size  Size of the population.
  * @param tournament_size  Number of individuals to consider in the tournament. Lower is more exploitative.
- * @param parent1          Output: first selected parent
- * @param parent2          Output: second selected parent
+ * @param rng              Random generator
+ * @param parent1          Output: index of the first selected parent
+ * @param parent2          Output: index of the second selected parent
  */
 void ga_tournament_selection(const Individual *population,
                                int population_size,
                                int tournament_size,
-                               Individual *parent1,
-                               Individual *parent2);
+                               Rng *rng,
+                               int *parent1,
+                               int *parent2);
 
 /**
  * @brief Single-point crossover.
@@ -73,8 +153,9 @@ void ga_tournament_selection(const Individual *population,
  * @param p1    Parent 1
  * @param p2    Parent 2
  * @param child Output: child
+ * @param rng   Random generator
  */
-void ga_single_point_crossover(const Problem *prob, const Individual *p1, const Individual *p2, Individual *child);
+void ga_single_point_crossover(const Problem *prob, const Individual *p1, const Individual *p2, Individual *child, Rng *rng);
 
 /**
  * @brief Bit-flip mutation.
@@ -82,8 +163,9 @@ void ga_single_point_crossover(const Problem *prob, const Individual *p1, const
  * @param prob          The problem instance (n dimension).
  * @param ind           The individual to mutate.
  * @param mutation_rate Probability of flipping each bit.
+ * @param rng           Random generator.
  */
-void ga_mutation(const Problem *prob, Individual *ind, float mutation_rate);
+void ga_mutation(const Problem *prob, Individual *ind, float mutation_rate, Rng *rng);
 
 /**
  * @brief Computes a penalty for a solution based on constraint violations.
@@ -102,9 +184,12 @@ float compute_penalty(const Problem *prob, const Solution *sol, const float pena
  * @brief Repair if the solution is infeasible.
  *
  * A simple approach: remove items with the worst "value/cost" ratio until feasible.
+ *
+ * @param usage Scratch buffer of length m.
  */
 void ga_repair(const Problem *prob,
-                                Individual *ind);
+                                Individual *ind,
+                                float *usage);
 
 /**
  * @brief Copy Individual (solution + fitness).
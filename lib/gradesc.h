@@ -4,13 +4,15 @@
 #include <time.h>
 #include <data_structure.h>
 #include <utils.h>
+#include <workspace.h>
+#include <step.h>
 
 
 /**
  * @brief Gradient Descent solver with momentum and optional item-freezing.
  *
  * Steps:
- *  1. Randomly initialize theta[i].
+ *  1. Initialize theta[i] randomly, or from a warm-start 0-1 solution.
  *  2. For each iteration:
  *     a) Compute x_hat[i] = sigmoid(theta[i]) for non-frozen items.
  *     b) Compute usage.
@@ -29,6 +31,9 @@
  * @param verbose       The verbosity level (NONE, INFO, DEBUG).
  * @param start         The start time for time limit.
  * @param max_time      The maximum allowed time.
+ * @param init          Optional warm-start solution for theta (NULL for a random start). It is
+ *                      returned instead of the GD result if the latter is worse.
+ * @param ws            Workspace providing the theta/momentum/usage buffers and the random generator.
  */
 void gradient_solver(const Problem *prob,
                      float lambda,
@@ -37,7 +42,97 @@ void gradient_solver(const Problem *prob,
                      Solution *out_sol,
                      LogLevel verbose,
                      clock_t start,
-                     float max_time);
+                     float max_time,
+                     const Solution *init,
+                     Workspace *ws);
+
+/**
+ * @brief Explicit state of a steppable gradient descent run (see step.h).
+ *
+ * Theta, momentum and the frozen flags live in the workspace's GD buffers; the 0-1 solution is
+ * only rounded and repaired by gd_finalize.
+ */
+typedef struct {
+    const Problem *prob;     /**< The problem instance */
+    Workspace *ws;           /**< Workspace holding theta, momentum and the frozen flags */
+    Solution *out_sol;       /**< Output of gd_finalize */
+    const Solution *init;    /**< Warm-start solution, returned instead of a worse result (or NULL) */
+    float lambda;            /**< Penalty coefficient for constraints */
+    float learning_rate;     /**< The step size for gradient updates */
+    int max_no_improvement;  /**< Iterations without loss improvement before the run is done */
+    int no_improvement;      /**< Current run of iterations without loss improvement */
+    int iter;                /**< Iterations run so far */
+    float previous_loss;     /**< Loss of the last iteration */
+    float profit;            /**< Profit of the relaxed solution at the last iteration */
+    LogLevel verbose;        /**< Verbosity level */
+} GdState;
+
+/**
+ * @brief Start a gradient descent run: theta from init (saturated) or random, no momentum, nothing frozen.
+ * @param st                 The state to set up.
+ * @param prob               Pointer to the MKP instance.
+ * @param lambda             Penalty coefficient for constraints.
+ * @param learning_rate      The step size for gradient updates.
+ * @param max_no_improvement The number of iterations without improvement before stopping.
+ * @param out_sol            Output of gd_finalize.
+ * @param verbose            The verbosity level (NONE, INFO, DEBUG).
+ * @param init               Optional warm-start solution (NULL for a random start); it must outlive the state.
+ * @param ws                 Workspace providing the theta/momentum/usage buffers and the random generator.
+ */
+void gd_init(GdState *st, const Problem *prob, float lambda, float learning_rate, int max_no_improvement,
+             Solution *out_sol, LogLevel verbose, const Solution *init, Workspace *ws);
+
+/**
+ * @brief Run gradient iterations for at most budget seconds.
+ * @return true if the run is not done yet.
+ */
+bool gd_step(GdState *st, float budget);
+
+/**
+ * @brief Run at most units gradient iterations, within budget seconds.
+ * @return true if the run is not done yet.
+ */
+bool gd_step_units(GdState *st, uint64_t units, float budget);
+
+/**
+ * @brief Progress of a gradient descent run (value is the profit of the relaxed solution).
+ */
+StepState gd_state(const GdState *st);
+
+/**
+ * @brief End a gradient descent run: round theta to a 0-1 solution in out_sol and repair it.
+ */
+void gd_finalize(GdState *st);
+
+/**
+ * @brief Batched gradient descent: evolves several independent theta vectors at once.
+ *
+ * Same update as gradient_solver, but the usage of all rows is one matrix product
+ * X_hat * W^T and the penalty gradient another one, mask * W (see linalg.h), instead of one
+ * matrix-vector product per start. Each row stops on its own no-improvement counter; the call
+ * returns when every row stopped or the time is up.
+ *
+ * @param prob          Pointer to the MKP instance.
+ * @param lambda        Penalty coefficient for constraints.
+ * @param learning_rate The step size for gradient updates.
+ * @param max_no_improvement The number of iterations without improvement before a row stops.
+ * @param batch         Number of rows (at most the workspace's gd_batch_capacity).
+ * @param verbose       The verbosity level (NONE, INFO, DEBUG).
+ * @param start         The start time for time limit.
+ * @param max_time      The maximum allowed time.
+ * @param init          Optional warm-start solution for row 0 (NULL for random rows only).
+ * @param ws            Workspace; results are written to ws->start_solutions[0..batch-1].
+ */
+void gradient_solver_batched(const Problem *prob,
+                             float lambda,
+                             float learning_rate,
+                             int max_no_improvement,
+                             int batch,
+                             LogLevel verbose,
+                             clock_t start,
+                             float max_time,
+                             const Solution *init,
+                             Workspace *ws);
 
 #endif // GRADESC_H
 
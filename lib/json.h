@@ -0,0 +1,71 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Minimal JSON reader used by the request protocol of mkp_server.
+ *
+ * Supports the full JSON grammar (objects, arrays, strings with escapes, numbers, booleans, null)
+ * but keeps numbers as double and strings as raw UTF-8 (\\u escapes above 0x7f are replaced by '?').
+ */
+typedef enum {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+} JsonType;
+
+typedef struct JsonValue {
+    JsonType type;
+    double number;              /**< JSON_NUMBER, JSON_BOOL (0 or 1) */
+    char *string;               /**< JSON_STRING */
+    int count;                  /**< Number of items (JSON_ARRAY) or members (JSON_OBJECT) */
+    struct JsonValue *items;    /**< Array items or object member values, length count */
+    char **keys;                /**< Object member names, length count */
+} JsonValue;
+
+/**
+ * @brief Parse a JSON document.
+ * @param text  The text to parse (NUL-terminated).
+ * @param out   Output: the parsed value (free with json_free).
+ * @param error Output: a static error message on failure (may be NULL).
+ * @return 0 on success, non-zero otherwise.
+ */
+int json_parse(const char *text, JsonValue *out, const char **error);
+
+/**
+ * @brief Free everything owned by a parsed value.
+ */
+void json_free(JsonValue *value);
+
+/**
+ * @brief Member of an object by name, or NULL if absent (or value is not an object).
+ */
+const JsonValue *json_get(const JsonValue *object, const char *key);
+
+/**
+ * @brief Number member of an object, or def if absent / not a number.
+ */
+double json_get_number(const JsonValue *object, const char *key, double def);
+
+/**
+ * @brief String member of an object, or def if absent / not a string.
+ */
+const char *json_get_string(const JsonValue *object, const char *key, const char *def);
+
+/**
+ * @brief Copy a JSON array of numbers into a float array.
+ * @return The number of elements copied, or -1 if value is not an array of numbers of length count.
+ */
+int json_to_floats(const JsonValue *array, float *out, int count);
+
+/**
+ * @brief Write a string as a JSON string literal (with escapes).
+ */
+void json_write_string(FILE *fout, const char *str);
+
+#endif // JSON_H
@@ -0,0 +1,37 @@
+#ifndef LINALG_H
+#define LINALG_H
+
+/**
+ * @brief Dense single-precision kernels used by the batched methods.
+ *
+ * Matrices are row-major. With -DMKP_USE_OPENBLAS=ON the kernels call CBLAS (OpenBLAS),
+ * otherwise a built-in cache-blocked implementation is used.
+ */
+
+/**
+ * @brief C = A * B.
+ *
+ * Zero entries of A are skipped by the built-in kernel, which makes products with sparse
+ * left operands (e.g. violated-constraint masks) cheap.
+ *
+ * @param M   Rows of A and C.
+ * @param N   Columns of B and C.
+ * @param K   Columns of A, rows of B.
+ * @param A   M x K matrix.
+ * @param lda Leading dimension (row stride) of A.
+ * @param B   K x N matrix.
+ * @param ldb Leading dimension of B.
+ * @param C   Output, M x N matrix (overwritten).
+ * @param ldc Leading dimension of C.
+ */
+void linalg_sgemm(int M, int N, int K,
+                  const float *A, int lda,
+                  const float *B, int ldb,
+                  float *C, int ldc);
+
+/**
+ * @brief Name of the backend the kernels were built with ("openblas" or "blocked").
+ */
+const char *linalg_backend(void);
+
+#endif // LINALG_H
@@ -3,19 +3,23 @@
 
 #include <time.h>
 #include <utils.h>
+#include <workspace.h>
+#include <search_context.h>
 
 /**
  * @brief Perform a local search using a flip-based neighborhood.
  *
  * This local search attempts to flip items from 0->1 to find an improving move.
- * If a 0->1 flip causes infeasibility, the repair procedure is called.
+ * Items that fit in the remaining capacity are added directly; when none fits, the best item is
+ * added and the repair procedure is called.
  *
  * @param prob        Pointer to the MKP problem instance.
  * @param current_sol Pointer to the current solution (will be modified in place).
  * @param max_checks  Maximum number of flips to try (or number of items to explore).
  * @param mode        Local search mode: LS_FIRST_IMPROVEMENT or LS_BEST_IMPROVEMENT.
+ * @param ws          Workspace providing the candidate solution and usage buffers.
  */
-void local_search_flip(const Problem *prob, Solution *current_sol, int max_checks, LSMode mode);
+void local_search_flip(const Problem *prob, Solution *current_sol, int max_checks, LSMode mode, Workspace *ws);
 
 
 /**
@@ -28,8 +32,38 @@ void local_search_flip(const Problem *prob, Solution *current_sol, int max_check
  * @param current_sol The current solution (will be modified in place)
  * @param max_checks  How many items to check from candidate_list
  * @param mode        LS_FIRST_IMPROVEMENT or LS_BEST_IMPROVEMENT
+ * @param ws          Workspace providing the candidate solution and usage buffers
  */
-void local_search_swap(const Problem *prob, Solution *current_sol, int max_checks, LSMode mode);
+void local_search_swap(const Problem *prob, Solution *current_sol, int max_checks, LSMode mode, Workspace *ws);
+
+/**
+ * @brief Flip local search on a search context (no usage recomputation).
+ *
+ * Works on an add-feasible set: the unselected items of the window that fit in the current
+ * slack, built once and filtered after each addition (items that stopped fitting are not looked
+ * at again). Flips from it are applied in place without repair; only when it is empty is the
+ * best unselected item added and repaired through the workspace candidate. Returns at once if
+ * ctx->flip_optimal is set.
+ *
+ * @param ctx The search context (ls_k and ls_mode are used, sol and usage are updated).
+ */
+void local_search_flip_ctx(SearchContext *ctx);
+
+/**
+ * @brief Swap local search on a search context (no usage recomputation).
+ *
+ * The best feasible improving swap is applied in place. For each selected item, only the
+ * unselected items of the window that would beat the best delta are checked: one by one in
+ * profit order when they are few, with one batched move_fit_mask call otherwise. Only when no
+ * feasible swap improves is the most profitable one repaired.
+ * On instances of at least SWAP_PARALLEL_MIN items, the scan over the selected items is split
+ * over the workspace's thread pool (if any): each thread keeps its own best, shared through a
+ * bound that prunes the others, and the bests are reduced at the end (in first improvement mode,
+ * the first thread to find an improving swap stops them all).
+ * Returns at once if ctx->swap_optimal is set.
+ * @param ctx The search context (ls_k and ls_mode are used, sol and usage are updated).
+ */
+void local_search_swap_ctx(SearchContext *ctx);
 
 #endif
 
@@ -0,0 +1,211 @@
+#ifndef MKP_H
+#define MKP_H
+
+/**
+ * @file mkp.h
+ * @brief Public interface of libmkp: an embeddable MKP solver.
+ *
+ * An MkpSolver owns a parsed Problem, a preallocated Workspace, its random generator and, when
+ * params.threads > 1, a work-stealing pool of threads used by the parallel neighborhood scans, the
+ * multi-start, the PORTFOLIO slices and the COOP workers, with one more Workspace per extra thread.
+ * Once created, repeated calls to mkp_solve() reuse the same memory: no heap allocation
+ * happens during a solve (the GA population and the GD batch are reserved at creation from the
+ * given params, and only grow if a later call asks for more).
+ *
+ * Typical use:
+ * @code
+ *   MkpParams params;
+ *   mkp_default_params(&params);
+ *   MkpSolver *solver = mkp_solver_create("instance.txt", &params, 42);
+ *   mkp_solve(solver, MKP_METHOD_VNS, &params, 1.0f);
+ *   const Solution *best = mkp_solver_solution(solver);
+ *   mkp_solver_destroy(solver);
+ * @endcode
+ */
+
+#include <stdint.h>
+#include <data_structure.h>
+#include <utils.h>
+#include <delta.h>
+#include <order.h>
+
+/**
+ * @brief Available solving methods.
+ */
+typedef enum {
+    MKP_METHOD_LS_FLIP,
+    MKP_METHOD_LS_SWAP,
+    MKP_METHOD_VND,
+    MKP_METHOD_VNS,
+    MKP_METHOD_GD,
+    MKP_METHOD_MULTI_GD_VNS,
+    MKP_METHOD_GA,
+    MKP_METHOD_PATH_RELINK,
+    MKP_METHOD_TABU,
+    MKP_METHOD_PORTFOLIO,
+    MKP_METHOD_COOP,
+    MKP_METHOD_COUNT
+} MkpMethod;
+
+/**
+ * @brief Tuning parameters of the methods.
+ */
+typedef struct {
+    int        use_gpu;          /**< 1 = GPU evaluation path, 0 = CPU */
+    int        num_starts;       /**< Number of random starts */
+    float      lambda;           /**< Penalty parameter for gradient solver */
+    float      learning_rate;    /**< Learning rate for gradient solver */
+    int        ls_max_checks;    /**< Local search 'k' param (max_checks) */
+    LSMode     ls_mode;          /**< Local search mode (first or best improvement) */
+    ItemOrder  order;            /**< Item ordering whose first ls_max_checks items local search explores */
+    int        threads;          /**< Threads for parallel neighborhood scans, VNS, multi-start, PORTFOLIO slices and COOP workers (1 = sequential; default $MKP_THREADS) */
+    VnsParallel vns_parallel;    /**< Acceptance of parallel VNS, when threads > 1 */
+    bool       deterministic;    /**< Same result for a given seed and thread count, whatever the timing (see mkp_solve) */
+    int        max_no_improv;    /**< Max iterations without improvement for GD/VND/VNS */
+    int        k_max;            /**< Max k for VNS */
+    int        population_size;  /**< Population size for genetic algorithm */
+    int        max_generations;  /**< Max generations for genetic algorithm */
+    float      mutation_rate;    /**< Mutation rate for genetic algorithm */
+    LogLevel   log_level;        /**< Verbosity level */
+} MkpParams;
+
+/** Opaque solver handle. */
+typedef struct MkpSolver MkpSolver;
+
+/**
+ * @brief Fill params with the default values (same as the command-line defaults).
+ */
+void mkp_default_params(MkpParams *params);
+
+/**
+ * @brief Copy the method parameters of parsed command-line arguments.
+ */
+void mkp_params_from_args(const Arguments *args, MkpParams *params);
+
+/**
+ * @brief Look up a method by its command-line name (e.g. "VNS", "MULTI-GD-VNS").
+ * @return 0 on success, non-zero if the name is unknown.
+ */
+int mkp_method_from_name(const char *name, MkpMethod *method);
+
+/**
+ * @brief Command-line name of a method.
+ */
+const char *mkp_method_name(MkpMethod method);
+
+/**
+ * @brief Create a solver from an instance file.
+ * @param instance_file Path to the instance.
+ * @param params        Parameters used to size the workspace (GA population, GD batch).
+ * @param seed          Seed of the solver's random generator.
+ * @return The solver, or NULL on error.
+ */
+MkpSolver *mkp_solver_create(const char *instance_file, const MkpParams *params, uint64_t seed);
+
+/**
+ * @brief Create a solver that cooperates with other processes through a shared-memory segment.
+ *
+ * The first process to use shm_name parses the instance into the segment, the others read it
+ * from there (see shm.h). Every solve then starts from the best solution on the segment's board
+ * when it beats the warm start, publishes its result there, and ends with the best solution of
+ * the board if another process found a better one. COOP workers exchange solutions with the
+ * other processes through that board during the whole solve. The instance cannot change
+ * (mkp_solver_apply_delta fails).
+ *
+ * @param instance_file Path to the instance (only its file name is used when joining).
+ * @param shm_name      Name of the segment, e.g. "mkp-run1".
+ * @param params        Parameters used to size the workspace (GA population, GD batch).
+ * @param seed          Seed of the solver's random generator (give each process its own).
+ * @return The solver, or NULL on error.
+ */
+MkpSolver *mkp_solver_create_shared(const char *instance_file, const char *shm_name, const MkpParams *params,
+                                    uint64_t seed);
+
+/**
+ * @brief Create a solver from an already loaded problem.
+ *
+ * The solver takes ownership of the problem's arrays (they are freed by mkp_solver_destroy).
+ *
+ * @return The solver, or NULL on error.
+ */
+MkpSolver *mkp_solver_create_from_problem(Problem *prob, const MkpParams *params, uint64_t seed);
+
+/**
+ * @brief Free a solver and everything it owns.
+ */
+void mkp_solver_destroy(MkpSolver *solver);
+
+/**
+ * @brief Reseed the solver's random generator.
+ */
+void mkp_solver_seed(MkpSolver *solver, uint64_t seed);
+
+/**
+ * @brief Set a warm-start solution used by the following solves.
+ *
+ * The solution is copied, its usage rebuilt once and it is repaired if infeasible (e.g. after the
+ * instance changed). LS, VND and VNS then start from it, GA injects it into its initial population,
+ * GD uses it as its initial theta and MULTI-GD-VNS uses it for its first start. PATH-RELINK
+ * seeds its elite pool from it, TABU, PORTFOLIO and COOP start from it.
+ *
+ * @return 0 on success, non-zero if the solution does not match the instance size.
+ */
+int mkp_solver_set_initial(MkpSolver *solver, const Solution *init);
+
+/**
+ * @brief Load a warm-start solution from a file written by save_solution.
+ * @return 0 on success, non-zero otherwise.
+ */
+int mkp_solver_load_initial(MkpSolver *solver, const char *filename);
+
+/**
+ * @brief Go back to random initial solutions.
+ */
+void mkp_solver_clear_initial(MkpSolver *solver);
+
+/**
+ * @brief Apply a small change of the instance in place (see ProblemDelta).
+ *
+ * The problem's derived arrays are updated incrementally and the solution of the last solve is
+ * remapped, repaired from its cached usage vector, and set as the warm-start solution: the next
+ * mkp_solve() re-optimizes it instead of starting from scratch. Buffers are only reallocated
+ * when items are added or removed.
+ *
+ * @return 0 on success, non-zero if the delta is invalid or on allocation error.
+ */
+int mkp_solver_apply_delta(MkpSolver *solver, const ProblemDelta *delta);
+
+/**
+ * @brief Run a method from a fresh (or warm-start) initial solution.
+ *
+ * With params->deterministic, the result only depends on the seed, the thread count, the warm
+ * start and the parameters, as long as the time limit does not stop the run:
+ * - the random generators are reseeded at the start of every solve (one stream per thread);
+ * - parallel VNS is synchronous;
+ * - MULTI-GD-VNS gives start s to thread s % threads, in order;
+ * - PORTFOLIO slices and COOP steps are bounded by iterations instead of seconds, and a fixed
+ *   number of rounds is run;
+ * - the COOP workers exchange solutions in thread order between rounds, and stop after
+ *   COOP_PATIENCE rounds without a better board solution.
+ * The time limit is then only checked between rounds and units. A board shared with other
+ * processes (mkp_solver_create_shared) makes the result depend on them.
+ *
+ * @param solver   The solver.
+ * @param method   The method to run.
+ * @param params   The method parameters.
+ * @param max_time Time budget in seconds.
+ * @return 0 on success, non-zero otherwise.
+ */
+int mkp_solve(MkpSolver *solver, MkpMethod method, const MkpParams *params, float max_time);
+
+/**
+ * @brief The problem owned by the solver.
+ */
+const Problem *mkp_solver_problem(const MkpSolver *solver);
+
+/**
+ * @brief The solution of the last mkp_solve() call (owned by the solver).
+ */
+const Solution *mkp_solver_solution(const MkpSolver *solver);
+
+#endif // MKP_H
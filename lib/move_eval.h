@@ -0,0 +1,61 @@
+#ifndef MOVE_EVAL_H
+#define MOVE_EVAL_H
+
+#include <stdint.h>
+#include <data_structure.h>
+
+/**
+ * @brief Batched feasibility of add and swap moves.
+ *
+ * Instead of testing candidate moves one by one, the kernel compares a block of 64 consecutive
+ * items against the slack of each constraint at once, reading the row-major weights with SIMD
+ * vectors of MOVE_EVAL_LANES floats (GCC/Clang vector extensions: 16 lanes with AVX-512, 8 with
+ * AVX, 4 otherwise; configure with -DMKP_NATIVE=ON to use the host's width). A block stops
+ * early once no item of it fits any more.
+ */
+
+/** Floats compared per vector operation: the native SIMD width of the build target. */
+#if defined(__AVX512F__)
+#define MOVE_EVAL_LANES 16
+#elif defined(__AVX__)
+#define MOVE_EVAL_LANES 8
+#else
+#define MOVE_EVAL_LANES 4
+#endif
+
+/** Items per mask word. */
+#define MOVE_EVAL_BLOCK 64
+
+/**
+ * @brief Number of 64-bit words of a mask over n items.
+ */
+static inline int move_mask_words(const int n) {
+    return (n + MOVE_EVAL_BLOCK - 1) / MOVE_EVAL_BLOCK;
+}
+
+/**
+ * @brief Test bit j of a mask.
+ */
+static inline bool move_mask_test(const uint64_t *mask, const int j) {
+    return (mask[j / MOVE_EVAL_BLOCK] >> (j % MOVE_EVAL_BLOCK)) & 1u;
+}
+
+/**
+ * @brief Feasibility bitmask of adding each item to a solution, optionally after removing one.
+ *
+ * Bit j of mask is set iff usage_i - removed_i + w_ij <= capacity_i for every constraint i.
+ * Only items whose bit is set in filter are evaluated (words of filter equal to 0 are skipped
+ * entirely), the others are left 0.
+ *
+ * @param prob    The problem instance.
+ * @param usage   Usage of the solution, length m.
+ * @param removed Weights of the removed item (a row of weights_by_item), or NULL for adds.
+ * @param filter  Items to evaluate, move_mask_words(n) words, or NULL for all items.
+ * @param slack   Scratch buffer, length m.
+ * @param mask    Output, move_mask_words(n) words.
+ * @return Number of feasible moves (bits set in mask).
+ */
+int move_fit_mask(const Problem *prob, const float *usage, const float *removed,
+                  const uint64_t *filter, float *slack, uint64_t *mask);
+
+#endif // MOVE_EVAL_H
@@ -0,0 +1,53 @@
+#ifndef ORDER_H
+#define ORDER_H
+
+#include <data_structure.h>
+
+/**
+ * @brief Item orderings of a problem.
+ *
+ * Local search only examines the first ls_max_checks entries of prob->candidate_list, so the
+ * ordering decides which moves are looked at. Every ordering is computed once (at load time,
+ * and kept up to date by problem_apply_delta), and switching between them is O(1).
+ *
+ * - ORDER_RATIO:  c_j / sum_i w_ij (plain ratio).
+ * - ORDER_SCALED: c_j / sum_i (w_ij / b_i), surrogate ratio with capacity-normalised weights.
+ * - ORDER_DUAL:   c_j / sum_i (mu_i w_ij), surrogate ratio weighted by an estimate mu of the
+ *                 LP relaxation's dual prices (subgradient descent on its Lagrangian dual), so
+ *                 that tight constraints weigh more than loose ones.
+ * - ORDER_PROFIT: c_j.
+ */
+
+/**
+ * @brief Compute the dual prices, the keys of every item and all the orderings.
+ * @return 0 on success, non-zero on allocation error (the orderings are then left unsorted).
+ */
+int problem_build_orders(Problem *prob);
+
+/**
+ * @brief Recompute the ratio, scaled and dual keys of item j (c, weights and duals unchanged).
+ */
+void problem_update_item_keys(Problem *prob, int j);
+
+/**
+ * @brief Sort key of item j in an ordering (orderings are by decreasing key).
+ */
+float problem_order_key(const Problem *prob, ItemOrder order, int j);
+
+/**
+ * @brief Make an ordering the active one (prob->candidate_list).
+ */
+void problem_set_order(Problem *prob, ItemOrder order);
+
+/**
+ * @brief Look up an ordering by name ("ratio", "scaled", "dual" or "profit").
+ * @return 0 on success, non-zero if the name is unknown.
+ */
+int order_from_name(const char *name, ItemOrder *order);
+
+/**
+ * @brief Name of an ordering.
+ */
+const char *order_name(ItemOrder order);
+
+#endif // ORDER_H
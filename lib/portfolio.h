@@ -0,0 +1,61 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <time.h>
+#include <mkp.h>
+#include <workspace.h>
+
+/** Number of time slices the budget is cut into (per thread). */
+#define PORTFOLIO_SLICES 40
+
+/** Shortest time slice, in seconds. */
+#define PORTFOLIO_MIN_SLICE 0.05f
+
+/** Iterations of each method in a slice of a deterministic run (which runs PORTFOLIO_SLICES rounds). */
+#define PORTFOLIO_SLICE_UNITS 50
+
+/**
+ * @brief Components the portfolio gives time slices to.
+ */
+typedef enum {
+    PORTFOLIO_LS,     /**< VND from the incumbent */
+    PORTFOLIO_VNS,    /**< VNS from the incumbent */
+    PORTFOLIO_GA,     /**< GA seeded with the incumbent */
+    PORTFOLIO_GD,     /**< GD from a random start, then VND */
+    PORTFOLIO_TABU,   /**< Tabu search from the incumbent */
+    PORTFOLIO_ARMS
+} PortfolioArm;
+
+/**
+ * @brief Algorithm portfolio: time slices of every component, scheduled by a bandit.
+ *
+ * The budget is run as rounds of one slice per thread. Each slice runs one component from the
+ * shared incumbent on the thread's own workspace; at the end of the round the best result
+ * replaces the incumbent if it is better. A component is rewarded for a slice (reward 1, else 0)
+ * when it improved on the incumbent it started from. Components are chosen by discounted UCB:
+ * each is tried once, then the one with the best discounted mean reward plus exploration bonus
+ * runs, so the budget moves to the components that improved the incumbent recently. Within a
+ * round, each pick counts as a pull with no reward for the next picks, which spreads the threads
+ * over several components.
+ *
+ * With params->deterministic, slice t of a round runs on thread t, slices end after
+ * PORTFOLIO_SLICE_UNITS iterations of their methods (tabu search after its own stopping rule)
+ * instead of a time share, and PORTFOLIO_SLICES rounds are run unless time is up first.
+ *
+ * @param prob     The problem instance.
+ * @param params   Parameters of the components.
+ * @param best_sol The incumbent (feasible), updated in place.
+ * @param start    The start time for the time limit.
+ * @param max_time The maximum allowed time in seconds.
+ * @param ws       Workspace of the calling thread; its pool, if any, runs the slices of a round.
+ * @param workers  Workspaces of the other pool threads, thread_pool_size(ws->pool) - 1 of them.
+ */
+void portfolio(const Problem *prob, const MkpParams *params, Solution *best_sol,
+               clock_t start, float max_time, Workspace *ws, Workspace *workers);
+
+/**
+ * @brief Name of a portfolio component (e.g. "VNS"), for logs.
+ */
+const char *portfolio_arm_name(PortfolioArm arm);
+
+#endif // PORTFOLIO_H
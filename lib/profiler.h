@@ -0,0 +1,82 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Cycle-accurate scoped zones (opt-in, removed at compile time).
+ *
+ * Build with -DMKP_PROFILE=ON to enable. Each zone reads the time-stamp counter on entry and on
+ * scope exit, charges the elapsed cycles to its node in a per-thread call tree (so nested calls
+ * such as multi-start -> GD -> VNS -> VND -> LS keep their full call path), and records a
+ * trace event. Without MKP_PROFILE, PROFILE_ZONE expands to nothing.
+ *
+ * Usage:
+ * @code
+ *   void vns(...) {
+ *       PROFILE_ZONE("vns");
+ *       ...
+ *   }
+ * @endcode
+ */
+
+/**
+ * @brief An open zone; closed automatically when it goes out of scope.
+ */
+typedef struct {
+    uint64_t start; /**< Time-stamp counter on entry */
+    int node;       /**< Call-tree node of this zone, or -1 if it could not be recorded */
+    int event;      /**< Trace event slot, or -1 once the trace buffer is full */
+} ProfileZone;
+
+#ifdef MKP_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t profile_ticks(void) {
+    return __rdtsc();
+}
+#else
+#include <time.h>
+static inline uint64_t profile_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+ProfileZone profile_zone_begin(const char *name);
+void profile_zone_end(const ProfileZone *zone);
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) \
+    __attribute__((cleanup(profile_zone_end))) const ProfileZone PROFILE_CONCAT(prof_zone_, __LINE__) = profile_zone_begin(name)
+
+#else
+
+#define PROFILE_ZONE(name)
+
+#endif
+
+/**
+ * @brief Whether zones were compiled in (MKP_PROFILE).
+ */
+bool profile_enabled(void);
+
+/**
+ * @brief Write the collected zones.
+ *
+ * Writes two files:
+ * - <prefix>.folded : collapsed stacks ("vns;vnd;local_search_swap <self cycles>"), readable by flamegraph.pl
+ * - <prefix>.trace.json : Chrome trace-event JSON (chrome://tracing, Perfetto)
+ *
+ * Only threads that already finished their zones are fully reported; call from the main thread
+ * once the workers are joined.
+ *
+ * @param prefix Output path prefix.
+ * @return 0 on success, non-zero otherwise (including when profiling is compiled out).
+ */
+int profile_write(const char *prefix);
+
+#endif // PROFILER_H
@@ -0,0 +1,48 @@
+#ifndef RELINK_H
+#define RELINK_H
+
+#include <time.h>
+#include <utils.h>
+#include <workspace.h>
+
+/**
+ * @brief Walk from elite member from toward elite member to, keeping the best intermediate point.
+ *
+ * Every step flips one item where the two members differ: the most profitable add that fits in
+ * the current slack, or else the drop with the lowest ratio. Each candidate flip is checked in
+ * O(m) against the usage of the current point, and every point of the path stays feasible. The
+ * best point strictly between the two ends is written to ws->pr_current, with its usage in
+ * ws->pr_usage.
+ *
+ * @param prob The problem instance.
+ * @param from Index of the initiating member in ws->elite.
+ * @param to   Index of the guiding member in ws->elite.
+ * @param ws   Workspace holding the elite pool and the path buffers.
+ * @return true if the path has an intermediate point (the members differ by at least two items).
+ */
+bool path_relink(const Problem *prob, int from, int to, Workspace *ws);
+
+/**
+ * @brief Path relinking intensification on the workspace's elite pool.
+ *
+ * best_sol is first improved by VND and offered to ws->elite; while the pool is not full, VND
+ * optima of shaken copies of best_sol are offered too. Then every pair of members (in both
+ * directions) with at least one member new since the last round is relinked, the best point of
+ * each path is improved by VND and offered back to the pool. A round that adds no member is
+ * followed by one more shaken VND optimum of best_sol; the search stops after max_no_improvement
+ * such rounds, or when time is up.
+ *
+ * @param prob               The problem instance.
+ * @param best_sol           The solution to improve (feasible), updated in place.
+ * @param max_no_improvement Rounds without a new elite member before stopping.
+ * @param ls_k               Number of items of candidate_list explored by local search.
+ * @param ls_mode            The local search mode (first or best improvement).
+ * @param start              The start time for the time limit.
+ * @param max_time           The maximum allowed time in seconds.
+ * @param verbose            Verbosity level.
+ * @param ws                 Workspace holding the elite pool and the scratch buffers.
+ */
+void path_relinking(const Problem *prob, Solution *best_sol, int max_no_improvement, int ls_k, LSMode ls_mode,
+                    clock_t start, float max_time, LogLevel verbose, Workspace *ws);
+
+#endif // RELINK_H
@@ -0,0 +1,56 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * @brief Small, fast pseudo-random generator (PCG32).
+ *
+ * Each solver / workspace owns its own generator instead of sharing the global rand() state,
+ * so independent solvers can run side by side and a given seed always replays the same search.
+ */
+typedef struct {
+    uint64_t state; /**< Internal state */
+    uint64_t inc;   /**< Stream selector (always odd) */
+} Rng;
+
+/**
+ * @brief Next 32 random bits.
+ */
+static inline uint32_t rng_next_u32(Rng *rng) {
+    const uint64_t old = rng->state;
+    rng->state = old * 6364136223846793005ull + rng->inc;
+    const uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+    const uint32_t rot = (uint32_t)(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31u));
+}
+
+/**
+ * @brief Seed a generator.
+ * @param rng    The generator.
+ * @param seed   The seed.
+ * @param stream Stream id: generators with the same seed and different streams are independent.
+ */
+static inline void rng_seed(Rng *rng, const uint64_t seed, const uint64_t stream) {
+    rng->state = 0u;
+    rng->inc = (stream << 1u) | 1u;
+    rng_next_u32(rng);
+    rng->state += seed;
+    rng_next_u32(rng);
+}
+
+/**
+ * @brief Uniform integer in [0, bound). bound must be > 0.
+ */
+static inline int rng_below(Rng *rng, const int bound) {
+    return (int)(((uint64_t)rng_next_u32(rng) * (uint64_t)bound) >> 32);
+}
+
+/**
+ * @brief Uniform float in [0, 1).
+ */
+static inline float rng_uniform(Rng *rng) {
+    return (float)(rng_next_u32(rng) >> 8) * 0x1p-24f;
+}
+
+#endif // RNG_H
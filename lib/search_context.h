@@ -0,0 +1,51 @@
+#ifndef SEARCH_CONTEXT_H
+#define SEARCH_CONTEXT_H
+
+#include <time.h>
+#include <utils.h>
+#include <workspace.h>
+#include "data_structure.h"
+
+/**
+ * @brief State shared down the VNS -> VND -> local search chain.
+ *
+ * Holds the solution under search together with its exact usage, so that no level recomputes
+ * usage or copies the solution to hand it to the next one. Accepted moves that need a scratch
+ * candidate are handed back by swapping pointers with the workspace buffers; sol and usage may
+ * therefore point to different buffers after a call, and callers must read them back from the
+ * context. The workspace provides the scratch buffers and the random generator, counters go to
+ * the thread's stats.
+ *
+ * The *_optimal flags let a neighborhood that already failed on the current solution be skipped
+ * (e.g. on the next VND iteration). Each local search sets its own flag when it stops and clears
+ * the others when it changes sol; code that modifies sol outside of them must clear them all
+ * with search_context_invalidate().
+ */
+typedef struct {
+    const Problem *prob;   /**< The problem instance */
+    Workspace *ws;         /**< Scratch candidates, usage vectors and random generator */
+    Solution *sol;         /**< Solution under search, improved in place */
+    float *usage;          /**< Usage of sol, length m, kept exact by every move */
+    int ls_k;              /**< Number of items of candidate_list explored by local search */
+    LSMode ls_mode;        /**< First or best improvement */
+    clock_t start;         /**< Start time for the time limit */
+    float max_time;        /**< Maximum allowed time in seconds */
+    bool flip_optimal;     /**< Don't-look bit: sol is a local optimum of flip search */
+    bool swap_optimal;     /**< Don't-look bit: sol is a local optimum of swap search */
+    bool drop2_optimal;    /**< Don't-look bit: sol is a local optimum of 2-1 exchanges */
+    bool add2_optimal;     /**< Don't-look bit: sol is a local optimum of 1-2 exchanges */
+    bool chain_optimal;    /**< Don't-look bit: sol is a local optimum of ejection chains */
+} SearchContext;
+
+/**
+ * @brief Clear every don't-look bit (sol was changed).
+ */
+static inline void search_context_invalidate(SearchContext *ctx) {
+    ctx->flip_optimal = false;
+    ctx->swap_optimal = false;
+    ctx->drop2_optimal = false;
+    ctx->add2_optimal = false;
+    ctx->chain_optimal = false;
+}
+
+#endif // SEARCH_CONTEXT_H
@@ -0,0 +1,59 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <stddef.h>
+#include <data_structure.h>
+#include <board.h>
+
+/** Longest segment name, including the leading '/'. */
+#define SHM_NAME_MAX 64
+
+/** Milliseconds a process waits for the creator of a segment to fill it. */
+#define SHM_WAIT_MS 10000
+
+/**
+ * @brief A POSIX shared-memory segment through which several solver processes cooperate.
+ *
+ * The segment holds a header, the instance as parsed by the first process (profits, capacities
+ * and the m x n weights) and a solution board (see board.h). The first process to open a name
+ * parses its instance file into the segment; the following ones wait until it is filled, check
+ * that it was made from an instance of the same file name, and read the instance from it without
+ * parsing. The processes may run different methods, seeds or thread counts: they only exchange
+ * solutions through the board, whose atomics are address-free. The last process to close the
+ * segment removes its name; a process that opens the name meanwhile waits until it is gone and
+ * creates a new segment. A process killed while attached leaves the name behind
+ * (/dev/shm/<name> on Linux): remove it before reusing the name for another instance. A board
+ * slot it was writing is emptied by the next publisher, which tells a dead process by its pid:
+ * every process sharing a segment must run in the same PID namespace (in containers, share the
+ * host's or one common PID namespace, not only /dev/shm).
+ */
+typedef struct {
+    char name[SHM_NAME_MAX];    /**< Name of the segment, with a leading '/' */
+    void *base;                 /**< The mapping, or NULL */
+    size_t size;                /**< Length of the mapping in bytes */
+    bool created;               /**< Whether this process created the segment */
+    int n;                      /**< Number of items of the shared instance */
+    int m;                      /**< Number of constraints of the shared instance */
+    const float *c;             /**< Shared profits, n */
+    const float *capacities;    /**< Shared capacities, m */
+    const float *weights;       /**< Shared weights, m x n */
+    SolutionBoard board;        /**< Board attached to the segment */
+} ShmSegment;
+
+/**
+ * @brief Create the segment of a name from an instance file, or join it if it exists.
+ * @param seg           The segment to open.
+ * @param name          Segment name (a leading '/' is added if missing).
+ * @param instance_file Instance parsed by the creator; joiners only compare its file name.
+ * @param prob          Receives the instance (owned by the caller): parsed by the creator, or
+ *                      copied from the segment by a joiner.
+ * @return 0 on success, non-zero on error (nothing is then left open or allocated).
+ */
+int shm_segment_open(ShmSegment *seg, const char *name, const char *instance_file, Problem *prob);
+
+/**
+ * @brief Unmap the segment, and remove its name if no other process is attached (NULL is allowed).
+ */
+void shm_segment_close(ShmSegment *seg);
+
+#endif // SHM_H
@@ -0,0 +1,147 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Search counters tracked during a run.
+ *
+ * Counters are incremented in a thread-local block (no atomics, no locks on the hot path)
+ * and merged into a process-wide total with stats_flush_thread().
+ */
+typedef enum {
+    STAT_FULL_EVALS,        /**< Full O(m*n) evaluations of a solution */
+    STAT_INCREMENTAL_MOVES, /**< Moves evaluated through an O(1)/O(m) delta */
+    STAT_REPAIRS,           /**< Calls to repair_solution on an infeasible solution */
+    STAT_REPAIR_DROPS,      /**< Items removed by repair_solution */
+    STAT_LS_ITERATIONS,     /**< Iterations of local_search_flip / local_search_swap */
+    STAT_LS_IMPROVEMENTS,   /**< Improving moves applied by local search and the exchange neighbourhoods */
+    STAT_VND_ITERATIONS,    /**< Iterations of the VND loop */
+    STAT_VNS_SHAKES,        /**< Calls to shake */
+    STAT_GA_GENERATIONS,    /**< Generations of the genetic algorithm */
+    STAT_GA_OFFSPRING,      /**< Offspring created by the genetic algorithm */
+    STAT_INCUMBENT_IMPROVEMENTS, /**< Improvements of the incumbent of VNS, the GA, tabu search or path relinking */
+    STAT_ELITE_INSERTS,     /**< Solutions that entered the elite pool */
+    STAT_RELINK_PATHS,      /**< Paths walked by path relinking */
+    STAT_TABU_ITERATIONS,   /**< Moves of the tabu search */
+    STAT_PORTFOLIO_SLICES,  /**< Time slices run by the portfolio */
+    STAT_BOARD_PUBLISHES,   /**< Solutions that entered the shared solution board */
+    STAT_BOARD_IMPORTS,     /**< Solutions copied out of the shared solution board */
+    STAT_COUNT
+} StatCounter;
+
+/**
+ * @brief Phases whose wall-clock time is accumulated.
+ */
+typedef enum {
+    PHASE_PARSE,
+    PHASE_GD,
+    PHASE_VNS,
+    PHASE_GA,
+    PHASE_COUNT
+} StatPhase;
+
+/** NUMA nodes told apart by the per-node counters (threads of higher nodes count into the last one). */
+#define STATS_MAX_NODES 8
+
+/**
+ * @brief A block of counters and phase timers.
+ */
+typedef struct {
+    uint64_t counters[STAT_COUNT];      /**< Event counts, indexed by StatCounter */
+    uint64_t phase_ns[PHASE_COUNT];     /**< Accumulated wall-clock time per phase, in nanoseconds */
+    uint64_t phase_calls[PHASE_COUNT];  /**< Number of times each phase was entered */
+    uint64_t node_evals[STATS_MAX_NODES]; /**< Full evaluations made by the threads of each NUMA node */
+    uint64_t node_moves[STATS_MAX_NODES]; /**< Incremental moves evaluated by the threads of each NUMA node */
+} SearchStats;
+
+/** Per-thread counters, merged into the global totals by stats_flush_thread(). */
+extern thread_local SearchStats tls_stats;
+
+/**
+ * @brief Increment a counter of the calling thread.
+ */
+static inline void stats_inc(const StatCounter c) {
+    tls_stats.counters[c]++;
+}
+
+/**
+ * @brief Add an amount to a counter of the calling thread.
+ */
+static inline void stats_add(const StatCounter c, const uint64_t amount) {
+    tls_stats.counters[c] += amount;
+}
+
+/**
+ * @brief Monotonic wall-clock time in nanoseconds.
+ */
+uint64_t stats_now_ns(void);
+
+/**
+ * @brief Start timing a phase. Returns the timestamp to pass to stats_phase_end().
+ */
+static inline uint64_t stats_phase_begin(void) {
+    return stats_now_ns();
+}
+
+/**
+ * @brief Stop timing a phase started with stats_phase_begin().
+ * @param phase The phase to charge.
+ * @param t0    The value returned by stats_phase_begin().
+ */
+static inline void stats_phase_end(const StatPhase phase, const uint64_t t0) {
+    tls_stats.phase_ns[phase] += stats_now_ns() - t0;
+    tls_stats.phase_calls[phase]++;
+}
+
+/**
+ * @brief Set the NUMA node the calling thread's evaluations and moves are charged to (0 by default).
+ */
+void stats_set_node(int node);
+
+/**
+ * @brief Merge the calling thread's counters into the global totals and reset them.
+ *
+ * Must be called by every thread before it exits (and by the main thread before reporting).
+ */
+void stats_flush_thread(void);
+
+/**
+ * @brief Flush the calling thread and copy the global totals into out.
+ */
+void stats_snapshot(SearchStats *out);
+
+/**
+ * @brief Reset the global totals and the calling thread's counters.
+ */
+void stats_reset(void);
+
+/**
+ * @brief Name of a counter, as used in the JSON output.
+ */
+const char *stats_counter_name(StatCounter c);
+
+/**
+ * @brief Name of a phase, as used in the JSON output.
+ */
+const char *stats_phase_name(StatPhase p);
+
+/**
+ * @brief Write stats as a compact one-line JSON object ({"counters": {...}, "phases": {...}, "nodes": [...]}).
+ */
+void stats_fprint_json(FILE *fout, const SearchStats *stats);
+
+/**
+ * @brief Write stats as a JSON object to a file (per-node counters with their rates over total_seconds).
+ * @param filename      Output file path.
+ * @param stats         The (merged) stats to write.
+ * @param instance      Instance name, or NULL.
+ * @param method        Method name, or NULL.
+ * @param total_seconds Total run time.
+ * @return 0 on success, non-zero otherwise.
+ */
+int stats_write_json(const char *filename, const SearchStats *stats,
+                     const char *instance, const char *method, double total_seconds);
+
+#endif // STATS_H
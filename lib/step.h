@@ -0,0 +1,31 @@
+#ifndef STEP_H
+#define STEP_H
+
+#include <stdint.h>
+
+/**
+ * @file step.h
+ * @brief Progress report shared by the steppable methods (VND, VNS, GA, GD).
+ *
+ * A steppable method is split into init / step / state / finalize around an explicit state
+ * object. init sets the state up from the workspace's buffers (no allocation); step(budget) runs
+ * the method for at most budget seconds of wall time, and the next step resumes exactly where it
+ * paused; state reports progress; finalize writes the result and hands the workspace buffers
+ * back. The one-call functions (vnd, vns, genetic_algorithm, gradient_solver) are init, one step
+ * with the remaining time, and finalize.
+ *
+ * step_units(units, budget) also stops after units iterations (the unit of the method's stopping
+ * rule). Unlike seconds, iterations do not depend on the machine or its load: a run whose steps
+ * are bounded by units, with a budget that does not run out, does the same work on every run.
+ *
+ * A state keeps pointers into its workspace. It may be stepped from any thread, but by one
+ * thread at a time, and at most one state of each method may be live on a workspace. States of
+ * different methods on the same workspace may be interleaved.
+ */
+typedef struct {
+    float value;          /**< Objective of the method's best solution so far */
+    uint64_t iterations;  /**< Iterations run so far (the unit of the method's stopping rule) */
+    bool done;            /**< The method met its own stopping rule: further steps do nothing */
+} StepState;
+
+#endif // STEP_H
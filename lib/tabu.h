@@ -0,0 +1,34 @@
+#ifndef TABU_H
+#define TABU_H
+
+#include <time.h>
+#include <utils.h>
+#include <workspace.h>
+
+/** Shortest tabu tenure, in iterations. */
+#define TABU_MIN_TENURE 7
+
+/** Tabu moves are single flips: iterations without a new best allowed per unit of max_no_improv. */
+#define TABU_PATIENCE 10
+
+/**
+ * @brief Flip tabu search from sol, keeping the best solution met.
+ *
+ * Every iteration makes one move from the current (always feasible) point: the most profitable
+ * unselected item of the window that fits in the slack is added, or, if none fits, the selected
+ * item ranked last by candidate_list is dropped. The flipped item may not be flipped back for a
+ * random tenure of TABU_MIN_TENURE to TABU_MIN_TENURE + n/20 iterations, unless adding it gives a
+ * new best (aspiration). Each move is checked in O(m) against the usage of the current point.
+ *
+ * @param prob               The problem instance.
+ * @param sol                The starting solution (feasible), replaced by the best one met.
+ * @param ls_k               Number of items of candidate_list considered for adds.
+ * @param max_no_improvement Iterations without a new best before stopping.
+ * @param start              The start time for the time limit.
+ * @param max_time           The maximum allowed time in seconds.
+ * @param ws                 Workspace providing the current point, its usage, the tabu list and the random generator.
+ */
+void tabu_search(const Problem *prob, Solution *sol, int ls_k, int max_no_improvement,
+                 clock_t start, float max_time, Workspace *ws);
+
+#endif // TABU_H
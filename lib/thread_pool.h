@@ -0,0 +1,107 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdatomic.h>
+
+/**
+ * @brief A fixed set of worker threads running parallel loops and task groups, by work stealing.
+ *
+ * Every thread owns a Chase-Lev deque of tasks: it pushes and pops its own tasks at the bottom
+ * (LIFO, cache-warm), and when it runs out it steals the oldest task from the top of another
+ * thread's deque. A parallel loop is pushed by the thread that starts it, so the other threads
+ * take its tasks one at a time from the far end. Workers are started once, spin briefly when
+ * they find nothing to run, then sleep until a task is posted, so a parallel loop costs one
+ * wake-up instead of a thread creation. The calling thread takes part in every job as worker 0;
+ * a pool of size 1 (or a NULL pool) runs everything inline. A pool is driven by one outside
+ * thread at a time (the one that created it).
+ *
+ * On Linux, workers are placed round-robin over the NUMA nodes of the CPUs the process may run
+ * on, starting with the node of the creating thread, and pinned to their CPU when there are at
+ * least as many CPUs as threads. An oversubscribed pool is not pinned (that only makes threads
+ * queue), but each worker is kept on the CPUs of its node, so that the node it reports is the
+ * one its memory is first touched on.
+ *
+ * Tasks count into the workers' own thread-local stats, which a worker flushes after each task:
+ * once a loop or a group wait returns, the global totals include the counters of its tasks.
+ */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief Body of a task.
+ * @param arg    The argument given with the task.
+ * @param task   Index of the task (in [0, tasks) for a parallel loop).
+ * @param worker Index of the thread running it, in [0, thread_pool_size()), for per-worker scratch.
+ */
+typedef void (*ThreadPoolTask)(void *arg, int task, int worker);
+
+/**
+ * @brief A set of submitted tasks that can be waited for.
+ */
+typedef struct {
+    _Atomic int pending;  /**< Submitted tasks not finished yet */
+} ThreadPoolGroup;
+
+/**
+ * @brief Start a pool.
+ * @param threads Total number of threads, including the caller (threads - 1 workers are started).
+ * @return The pool, or NULL on error.
+ */
+ThreadPool *thread_pool_create(int threads);
+
+/**
+ * @brief Number of threads of the pool, including the caller (1 for a NULL pool).
+ */
+int thread_pool_size(const ThreadPool *pool);
+
+/**
+ * @brief NUMA node a thread of the pool was placed on (0 without NUMA information or a NULL pool).
+ */
+int thread_pool_node(const ThreadPool *pool, int worker);
+
+/**
+ * @brief Run fn for every task in [0, tasks) and wait for all of them.
+ *
+ * Tasks are claimed one at a time (the caller from task 0 up, thieves from the last task down),
+ * so uneven tasks balance across the threads. May be called from a task: the nested loop is a
+ * task group of the calling thread (see thread_pool_wait).
+ */
+void thread_pool_run(ThreadPool *pool, ThreadPoolTask fn, void *arg, int tasks);
+
+/**
+ * @brief Run fn once on every thread of the pool (task == worker) and wait for all of them.
+ *
+ * For jobs whose task t must use the scratch and random generator of thread t, e.g. so that the
+ * result does not depend on which thread claimed which task. Needs every thread: it must not be
+ * called from a task.
+ */
+void thread_pool_run_each(ThreadPool *pool, ThreadPoolTask fn, void *arg);
+
+/**
+ * @brief Set up an empty task group.
+ */
+static inline void thread_pool_group_init(ThreadPoolGroup *group) {
+    atomic_init(&group->pending, 0);
+}
+
+/**
+ * @brief Add task (fn, arg, task) to a group, on the calling thread's deque.
+ *
+ * Another thread may steal it at once. Without a pool, or when the deque is full, the task runs
+ * inline before this returns.
+ */
+void thread_pool_submit(ThreadPool *pool, ThreadPoolGroup *group, ThreadPoolTask fn, void *arg, int task);
+
+/**
+ * @brief Wait until every task of the group has run, running tasks of the group meanwhile.
+ *
+ * The waiting thread only runs tasks of this group (its own, or stolen), so a task that waits for
+ * a nested group is never resumed on top of an unrelated task using the same per-worker scratch.
+ */
+void thread_pool_wait(ThreadPool *pool, ThreadPoolGroup *group);
+
+/**
+ * @brief Stop the workers and free the pool (NULL is allowed).
+ */
+void thread_pool_destroy(ThreadPool *pool);
+
+#endif // THREAD_POOL_H
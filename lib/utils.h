@@ -3,6 +3,7 @@
 
 #include <time.h>
 #include <data_structure.h>
+#include <workspace.h>
 
 /**
  * @brief Represents the local search mode.
@@ -12,6 +13,14 @@ typedef enum {
     LS_BEST_IMPROVEMENT
 } LSMode;
 
+/**
+ * @brief How parallel VNS (threads > 1) accepts the results of its threads.
+ */
+typedef enum {
+    VNS_SYNC,   /**< Rounds of one shake per thread; the best result of a round is accepted */
+    VNS_ASYNC   /**< Threads search independently and publish each improvement at once */
+} VnsParallel;
+
 typedef enum {
     NONE,
     INFO,
@@ -32,12 +41,21 @@ typedef struct {
     float      learning_rate;    /**< Learning rate for gradient solver */
     int        ls_max_checks;    /**< Local search 'k' param (max_checks, etc.) */
     LSMode     ls_mode;          /**< Local search mode (first or best improvement) */
+    ItemOrder  order;            /**< Item ordering explored by local search (see order.h) */
+    int        threads;          /**< Threads of the parallel methods and scans (1 = sequential) */
+    VnsParallel vns_parallel;    /**< Acceptance of parallel VNS (sync or async) */
+    bool       deterministic;    /**< Parallel methods give the same result for a given seed and thread count */
     int        max_no_improv;    /**< Max no improvement for VND/VNS : The number of iterations without improvement before stopping */
     int        k_max;            /**< Max k for VNS : the number of neighborhoods to explore */
     int        population_size;  /**< Population size for genetic algorithm */
     int        max_generations;  /**< Max generations for genetic algorithm */
     float      mutation_rate;    /**< Mutation rate for genetic algorithm */
     LogLevel   log_level;        /**< Verbosity level */
+    const char *stats_file;      /**< If set, search counters and phase timers are written there as JSON */
+    const char *profile_prefix;  /**< If set, profiler zones are written to <prefix>.folded and <prefix>.trace.json */
+    const char *init_file;       /**< If set, methods start from this solution file (save_solution format) */
+    const char *coop_shm;        /**< If set, name of a shared-memory segment through which solver processes cooperate */
+    uint64_t   seed;             /**< Seed of the random generators */
 } Arguments;
 
 /**
@@ -45,7 +63,7 @@ typedef struct {
  *
  * Usage example:
  *   ./mkp_solver instance.txt [--cpu|--gpu]
- *       [--method=LS-FLIP|LS-SWAP|VND|VNS|GD|MULTI-GD-VNS|GA]
+ *       [--method=LS-FLIP|LS-SWAP|VND|VNS|GD|MULTI-GD-VNS|GA|PATH-RELINK|TABU|PORTFOLIO|COOP]
  *       [--output=solution.txt]
  *       [--max_time=10.0]
  *       [--num_starts=5]
@@ -53,20 +71,47 @@ typedef struct {
  *       [--lr=1e-3]
  *       [--max_iters=1000]
  *       [--ls_max_checks=500]
+ *       [--order=ratio|scaled|dual|profit]
+ *       [--threads=1]  (default: the MKP_THREADS environment variable, else 1)
+ *       [--vns_parallel=sync|async]
+ *       [--deterministic]  (reproducible parallel runs: exchanges at iteration counts, not times)
  *       [--max_no_improv=100]
  *       [--k_max=500]
  *       [--population_size=500]
  *       [--max_generations=1000]
  *       [--mutation_rate=0.01]
  *       [--verbose=NONE|INFO|DEBUG]
+ *       [--stats=stats.json]
+ *       [--profile=prefix]  (requires a build with -DMKP_PROFILE=ON)
+ *       [--init=solution.txt]
+ *       [--coop-shm=name]  (processes given the same name share the instance and a solution board)
+ *       [--seed=42]
  */
 Arguments parse_cmd_args(int argc, char *argv[]);
 
 /**
- * @brief Checks if we exceeded the max_time. Returns 1 if time is up, else 0.
+ * @brief Default thread count: the MKP_THREADS environment variable if it is a positive integer, else 1.
+ */
+int default_threads(void);
+
+/**
+ * @brief Monotonic wall-clock time, in clock_t ticks (CLOCKS_PER_SEC per second).
+ *
+ * Unlike clock(), it does not add up the CPU time of the other threads of the process, so a time
+ * budget lasts as long with N threads as with one.
+ */
+clock_t wall_clock(void);
+
+/**
+ * @brief Checks if we exceeded the max_time since start (a wall_clock() time). Returns 1 if time is up, else 0.
  */
 int time_is_up(clock_t start, float max_time);
 
+/**
+ * @brief Seconds left of max_time since start (a wall_clock() time), 0 if time is up.
+ */
+float time_remaining(clock_t start, float max_time);
+
 
 /**
  * @brief Parse an MKP instance from a given file.
@@ -76,6 +121,29 @@ int time_is_up(clock_t start, float max_time);
  */
 int parse_instance(const char *filename, Problem *prob);
 
+/**
+ * @brief Build a problem from in-memory data (copies the arrays and precomputes ratios and candidate list).
+ * @param prob       Problem structure to fill.
+ * @param n          Number of items.
+ * @param m          Number of constraints.
+ * @param c          Objective coefficients, length n.
+ * @param capacities Capacities, length m.
+ * @param weights    Weights, length m*n, row-major.
+ * @return 0 on success, non-zero otherwise.
+ */
+int problem_from_arrays(Problem *prob, int n, int m,
+                        const float *c, const float *capacities, const float *weights);
+
+/**
+ * @brief Deep copy of a problem (same arrays, orderings and active ordering).
+ *
+ * The arrays are allocated and written by the calling thread, so on a NUMA machine their pages
+ * are placed on that thread's node (first touch).
+ *
+ * @return 0 on success, non-zero on allocation error (dst is then empty).
+ */
+int copy_problem(const Problem *src, Problem *dst);
+
 /**
  * @brief Free memory allocated for a problem and set pointers to NULL.
  * @param prob The problem to free.
@@ -90,7 +158,11 @@ void free_problem(Problem *prob);
 void evaluate_solution_cpu(const Problem *prob, Solution *sol);
 
 /**
- * @brief Evaluate a solution on GPU using cuBLAS (placeholder).
+ * @brief Evaluate a solution on the --gpu path.
+ *
+ * Populations and start solutions of the --gpu path are scored by the workspace's dense
+ * BatchEvaluator (see batch_eval.h). A single solution gains nothing from a matrix product,
+ * so it is scored like evaluate_solution_cpu.
  * @param prob The problem instance.
  * @param sol The solution to evaluate. On return, value and feasibility are updated.
  */
@@ -102,10 +174,13 @@ void evaluate_solution_gpu(const Problem *prob, Solution *sol);
  * @param sol The solution to initialize.
  * @param eval_func Pointer to evaluation function (CPU or GPU).
  * @param num_starts Number of random starts or attempts.
+ * @param ws Workspace providing the start buffers, the batch evaluator and the random generator;
+ *           it must hold num_starts start buffers (see workspace_reserve_gd_batch, done by mkp_solve).
  */
 void construct_initial_solution(const Problem *prob, Solution *sol,
                                 void (*eval_func)(const Problem*, Solution*),
-                                int num_starts);
+                                int num_starts,
+                                Workspace *ws);
 
 /**
  * @brief Check feasibility of a solution (called after evaluation to confirm constraint satisfaction).
@@ -125,6 +200,25 @@ bool check_feasibility(const Problem *prob, const Solution *sol);
  */
 void save_solution(const char *filename, const Solution *sol);
 
+/**
+ * @brief Read a solution written by save_solution (e.g. to warm-start a method).
+ *
+ * The value on line 1 is ignored: the solution is re-evaluated against prob, so a solution
+ * saved for a slightly different instance can still be loaded (it may come back infeasible).
+ *
+ * @param filename The solution file path.
+ * @param prob     The problem the solution is for (items must be in 1..n).
+ * @param sol      Output: an allocated solution of size prob->n.
+ * @return 0 on success, non-zero otherwise.
+ */
+int read_solution(const char *filename, const Problem *prob, Solution *sol);
+
+/**
+ * @brief qsort comparator of (key, index) float pairs, by key in descending order, then by index
+ *        in ascending order (a total order, whatever the qsort implementation).
+ */
+int compare_pairs_descending(const void *a, const void *b);
+
 /**
  * @brief Repairs the solution if it violates capacity constraints.
  *
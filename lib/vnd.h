@@ -3,12 +3,16 @@
 
 #include <time.h>
 #include <utils.h>
+#include <workspace.h>
+#include <search_context.h>
+#include <step.h>
 
 #include "data_structure.h"
 
 /**
  * @brief Variable Neighborhood Descent routine.
- * Uses two local search procedures and systematically changes neighborhoods.
+ * Goes through the neighborhoods flip, swap, 2-1, 1-2 and ejection chains (exchange.h), moving to
+ * the next one only when the previous ones fail to improve.
  * @param prob                  The problem instance.
  * @param sol                   The solution (improved in place if a better solution is found).
  * @param max_no_improvement    Maximum number of iterations without improvement before stopping.
@@ -16,7 +20,61 @@
  * @param ls_k                  The number of items to consider in local search.
  * @param start                 The start time for time limit.
  * @param max_time              The maximum allowed time.
+ * @param ws                    Workspace providing scratch buffers.
  */
-void vnd(const Problem *prob, Solution *sol, const int max_no_improvement, const int ls_k, const LSMode ls_mode, const clock_t start, const float max_time);
+void vnd(const Problem *prob, Solution *sol, const int max_no_improvement, const int ls_k, const LSMode ls_mode, const clock_t start, const float max_time, Workspace *ws);
+
+/**
+ * @brief VND on a search context: every neighborhood runs on ctx->sol and its usage directly,
+ *        without copying the solution or recomputing usage.
+ * @param ctx                The search context (sol and usage are updated).
+ * @param max_no_improvement Maximum number of iterations without improvement before stopping.
+ */
+void vnd_ctx(SearchContext *ctx, int max_no_improvement);
+
+/**
+ * @brief Explicit state of a steppable VND run (see step.h).
+ */
+typedef struct {
+    SearchContext ctx;       /**< Solution under descent, its usage and the don't-look bits */
+    int max_no_improvement;  /**< Iterations without improvement before the descent is done */
+    int no_improvement;      /**< Current run of iterations without improvement */
+    uint64_t iterations;     /**< Iterations run so far */
+} VndState;
+
+/**
+ * @brief Start a VND run on sol (the usage is computed once, into the workspace's ls_usage).
+ * @param st                 The state to set up.
+ * @param prob               The problem instance.
+ * @param sol                The solution to improve in place; it must outlive the state.
+ * @param max_no_improvement Maximum number of iterations without improvement before stopping.
+ * @param ls_k               The number of items to consider in local search.
+ * @param ls_mode            The local search mode (first or best improvement).
+ * @param ws                 Workspace providing scratch buffers.
+ */
+void vnd_init(VndState *st, const Problem *prob, Solution *sol, int max_no_improvement, int ls_k, LSMode ls_mode,
+              Workspace *ws);
+
+/**
+ * @brief Run VND iterations for at most budget seconds.
+ * @return true if the descent is not done yet.
+ */
+bool vnd_step(VndState *st, float budget);
+
+/**
+ * @brief Run at most units VND iterations, within budget seconds.
+ * @return true if the descent is not done yet.
+ */
+bool vnd_step_units(VndState *st, uint64_t units, float budget);
+
+/**
+ * @brief Progress of a VND run.
+ */
+StepState vnd_state(const VndState *st);
+
+/**
+ * @brief End a VND run: sol holds its result, the usage buffer goes back to the workspace.
+ */
+void vnd_finalize(VndState *st);
 
 #endif
@@ -3,6 +3,9 @@
 
 #include <time.h>
 #include <utils.h>
+#include <workspace.h>
+#include <search_context.h>
+#include <step.h>
 #include "data_structure.h"
 
 /**
@@ -17,6 +20,7 @@
  * @param start                 The start time for time limit.
  * @param max_time              The maximum allowed time.
  * @param verbose               Verbosity level.
+ * @param ws                    Workspace providing scratch buffers and the random generator.
  */
 void vns(const Problem *prob,
     Solution *sol,
@@ -26,8 +30,129 @@ void vns(const Problem *prob,
     LSMode ls_mode,
     clock_t start,
     float max_time,
-    LogLevel verbose);
+    LogLevel verbose,
+    Workspace *ws);
 
-void shake(const Problem *p, const Solution *s, Solution *candidate, int k);
+/**
+ * @brief VNS with replicated shaking: every thread of ws->pool shakes the incumbent and runs VND.
+ *
+ * Each thread works on its own workspace (ws for the caller, workers[t - 1] for thread t) with
+ * its own random stream, so the threads share nothing but the incumbent.
+ * - VNS_SYNC: rounds where thread t shakes the incumbent with k + t, so a round covers T
+ *   consecutive neighborhoods; the best improving result (the smallest k on ties) is accepted at
+ *   the end of the round and k goes back to 0, else k moves on by T. For a given seed and thread
+ *   count, the search depends only on the time limit, not on thread timing.
+ * - VNS_ASYNC: every thread runs its own VNS from a private copy of the incumbent, publishes each
+ *   improvement under a lock right away and re-imports the shared incumbent (restarting at k = 0)
+ *   whenever another thread published a better one. Threads stop on their own no-improvement
+ *   counts or when time is up.
+ *
+ * The pool runs the threads, so the VND of each thread scans sequentially. With a single-thread
+ * pool (or none), this is vns().
+ *
+ * @param prob                  The problem instance.
+ * @param sol                   The solution to improve (feasible).
+ * @param max_no_improvement    Sweeps over k without improvement before stopping.
+ * @param k_max                 Maximum number of neighborhoods to try.
+ * @param ls_k                  Number of items to consider in local search.
+ * @param ls_mode               The local search mode (first or best improvement).
+ * @param mode                  Synchronous or asynchronous acceptance.
+ * @param start                 The start time for time limit.
+ * @param max_time              The maximum allowed time.
+ * @param verbose               Verbosity level.
+ * @param ws                    Workspace of the calling thread, whose pool runs the search.
+ * @param workers               Workspaces of the other pool threads, thread_pool_size(ws->pool) - 1 of them.
+ */
+void parallel_vns(const Problem *prob,
+    Solution *sol,
+    int max_no_improvement,
+    int k_max,
+    int ls_k,
+    LSMode ls_mode,
+    VnsParallel mode,
+    clock_t start,
+    float max_time,
+    LogLevel verbose,
+    Workspace *ws,
+    Workspace *workers);
+
+/**
+ * @brief Explicit state of a steppable VNS run (see step.h).
+ *
+ * The unit of work is one shake of the incumbent at the current k followed by VND; a sweep goes
+ * from k = 0 to k_max (back to 0 on every improvement), and the run is done after
+ * max_no_improvement sweeps without improvement. The VND of a unit stops at the step's deadline
+ * too; a run split into steps bounded by units only (an unreachable deadline) gives the same
+ * result however it is split.
+ */
+typedef struct {
+    const Problem *prob;     /**< The problem instance */
+    Workspace *ws;           /**< Workspace providing the buffers and the random generator */
+    Solution *sol;           /**< The incumbent, improved in place */
+    float *sol_usage;        /**< Usage of sol, length m */
+    SearchContext ctx;       /**< Shaken candidate under VND, and its usage */
+    int max_no_improvement;  /**< Sweeps without improvement before the run is done */
+    int k_max;               /**< Largest shake of a sweep */
+    int k;                   /**< Shake size of the next unit */
+    bool improved;           /**< The current sweep improved the incumbent */
+    int no_improvement;      /**< Current run of sweeps without improvement */
+    int sweeps;              /**< Sweeps completed */
+    uint64_t shakes;         /**< Units (shake + VND) run so far */
+    LogLevel verbose;        /**< Verbosity level */
+} VnsState;
+
+/**
+ * @brief Start a VNS run on sol (its usage is computed once, into the workspace's vns_usage).
+ * @param st                 The state to set up.
+ * @param prob               The problem instance.
+ * @param sol                The solution to improve in place (feasible); it must outlive the state.
+ * @param max_no_improvement Maximum number of sweeps without improvement before stopping.
+ * @param k_max              Maximum number of neighborhoods to try.
+ * @param ls_k               Number of items to consider in local search.
+ * @param ls_mode            The local search mode (first or best improvement).
+ * @param verbose            Verbosity level.
+ * @param ws                 Workspace providing scratch buffers and the random generator.
+ */
+void vns_init(VnsState *st, const Problem *prob, Solution *sol, int max_no_improvement, int k_max, int ls_k,
+              LSMode ls_mode, LogLevel verbose, Workspace *ws);
+
+/**
+ * @brief Run shakes and VND for at most budget seconds.
+ * @return true if the run is not done yet.
+ */
+bool vns_step(VnsState *st, float budget);
+
+/**
+ * @brief Run at most units shakes (each followed by VND), within budget seconds.
+ * @return true if the run is not done yet.
+ */
+bool vns_step_units(VnsState *st, uint64_t units, float budget);
+
+/**
+ * @brief Progress of a VNS run (iterations counts the shakes).
+ */
+StepState vns_state(const VnsState *st);
+
+/**
+ * @brief End a VNS run: sol holds its result, the usage buffers go back to the workspace.
+ */
+void vns_finalize(VnsState *st);
+
+/**
+ * @brief Perturb a solution by flipping k random distinct items, then repair if infeasible.
+ *
+ * Runs in O(k*m) plus the repair: the k items are drawn by a partial Fisher-Yates shuffle of the
+ * workspace's persistent permutation, and value and usage are updated per flipped item.
+ *
+ * @param p               The problem instance.
+ * @param s               The solution to perturb.
+ * @param s_usage         Usage of s, length m.
+ * @param candidate       Output: the perturbed solution.
+ * @param candidate_usage Output: usage of the perturbed solution, length m.
+ * @param k               Number of items to flip.
+ * @param ws              Workspace providing the permutation and the random generator.
+ */
+void shake(const Problem *p, const Solution *s, const float *s_usage,
+           Solution *candidate, float *candidate_usage, int k, Workspace *ws);
 
 #endif
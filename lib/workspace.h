@@ -0,0 +1,190 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <data_structure.h>
+#include <rng.h>
+#include <batch_eval.h>
+#include <thread_pool.h>
+#include <elite.h>
+#include <board.h>
+
+/**
+ * @brief Scratch buffers and running best of one thread of the swap search scan.
+ */
+typedef struct {
+    uint64_t *filter;    /**< Candidate adds of the item under scan, move_mask_words(n) */
+    uint64_t *fit_mask;  /**< Feasible adds returned by move_fit_mask, move_mask_words(n) */
+    float *slack;        /**< Slack scratch of move_fit_mask, length m */
+    int best_i;          /**< Item to remove of the best swap found, -1 if none */
+    int best_j;          /**< Item to add of the best swap found */
+    float best_delta;    /**< Gain of the best swap found */
+} SwapScan;
+
+/**
+ * @brief Preallocated scratch memory for all solver methods.
+ *
+ * Every method takes a Workspace instead of allocating its own buffers, so that once a workspace
+ * is set up (and its GA population reserved), running any method performs no heap allocation.
+ * Each nesting level (multi-start -> VNS -> VND -> LS) has its own buffers, so methods can call
+ * each other with the same workspace.
+ *
+ * A workspace is not thread-safe: use one per thread. Its pool, if any, is only used from inside a
+ * method, with per-thread scratch slots (ls_scans) for each pool thread.
+ */
+typedef struct {
+    int n;                        /**< Number of items the buffers are sized for */
+    int m;                        /**< Number of constraints the buffers are sized for */
+    Rng rng;                      /**< Random generator used by all methods */
+    ThreadPool *pool;             /**< Threads for parallel neighborhood scans (not owned), or NULL */
+    const Problem *local_prob;    /**< Copy of the instance on this thread's NUMA node (not owned), or NULL */
+
+    // Batch evaluation
+    BatchBackend eval_backend;    /**< Backend of evaluator */
+    BatchEvaluator *evaluator;    /**< Scores populations and start solutions in one call */
+    int eval_capacity;            /**< Length of eval_batch */
+    Solution **eval_batch;        /**< Pointers to the solutions of a batch_evaluate call */
+
+    // Initial construction / multi-start
+    Solution init_candidate;      /**< Candidate in construct_initial_solution */
+    Solution start_candidate;     /**< Candidate of each multi-start run */
+
+    // Local search
+    Solution ls_candidate;        /**< Neighbor under evaluation */
+    float *ls_usage;              /**< Usage of the current solution, length m */
+    float *ls_candidate_usage;    /**< Usage of the neighbor, length m */
+    int *ls_fit;                  /**< Add-feasible set of flip search (items that fit in the slack), length n */
+    float (*ls_profit_pairs)[2];  /**< (profit, item) pairs sorted by swap search, length n */
+    float *ls_slack;              /**< Slack scratch of move_fit_mask, length m */
+    uint64_t *ls_window_mask;     /**< Items to evaluate (filter of move_fit_mask), move_mask_words(n) */
+    uint64_t *ls_fit_mask;        /**< Feasible moves returned by move_fit_mask, move_mask_words(n) */
+    int ls_scan_count;            /**< Number of swap scan slots (at least one per pool thread) */
+    SwapScan *ls_scans;           /**< Per-thread swap scan scratch, slot 0 is the calling thread's */
+
+    // Compound neighborhoods (2-1, 1-2, ejection chains)
+    float *ex_slack;              /**< Slack of the current solution, length m */
+    float *ex_residual;           /**< Slack once the dropped items are removed, length m */
+    float *ex_chain_usage;        /**< Usage of the ejection chain under construction, length m */
+
+    // VND / VNS
+    Solution vns_candidate;       /**< Shaken candidate of VNS */
+    float *vns_usage;             /**< Usage of the VNS incumbent, length m */
+    int *shake_indices;           /**< Persistent index permutation sampled by shake, length n */
+    float *shake_usage;           /**< Usage of the shaken candidate, length m */
+    Solution pvns_incumbent;      /**< This thread's copy of the shared incumbent in asynchronous parallel VNS */
+    float *pvns_usage;            /**< Usage of pvns_incumbent, length m */
+
+    // Elite pool and path relinking
+    ElitePool elite;              /**< Good, diverse local optima fed by VNS, GA and multi-start */
+    Solution pr_current;          /**< Point of the path being walked, then its best point */
+    float *pr_usage;              /**< Usage of pr_current, length m */
+    int *pr_path;                 /**< Items where the two ends of the path differ, length n */
+
+    // Tabu search
+    Solution tabu_current;        /**< Current point of the tabu search */
+    float *tabu_usage;            /**< Usage of tabu_current, length m */
+    int *tabu_until;              /**< Iteration until which flipping each item back is tabu, length n */
+
+    // Portfolio
+    Solution slice_candidate;     /**< Result of the portfolio slice being run on this workspace */
+    Solution slice_best;          /**< Best result of the slices run on this workspace in the current round */
+
+    // Cooperative search
+    SolutionBoard board;          /**< Solutions shared by the COOP workers (the caller's board is used) */
+    Solution coop_vns;            /**< Incumbent of this thread's VNS worker */
+    Solution coop_ls;             /**< GD result under VND, of this thread's LS worker */
+    Solution coop_import;         /**< Solution read from the board */
+
+    // Gradient descent
+    float *gd_theta;              /**< Logits, length n */
+    float *gd_velocity;           /**< Momentum, length n */
+    float *gd_x_hat;              /**< Relaxed solution, length n */
+    float *gd_mask;               /**< Violated constraints (0/1), length m */
+    float *gd_usage;              /**< Relaxed usage, length m */
+    bool *gd_frozen;              /**< Frozen items, length n */
+
+    // Batched gradient descent and construction (one row / solution per start)
+    int gd_batch_capacity;        /**< Number of rows (and start solutions) allocated */
+    float *gd_batch_theta;        /**< Logits, batch x n */
+    float *gd_batch_velocity;     /**< Momentum, batch x n */
+    float *gd_batch_x_hat;        /**< Relaxed solutions, batch x n */
+    float *gd_batch_grad;         /**< Penalty gradients, batch x n */
+    float *gd_batch_usage;        /**< Relaxed usages, batch x m */
+    float *gd_batch_mask;         /**< Violated constraints (0/1), batch x m */
+    bool *gd_batch_frozen;        /**< Frozen items, batch x n */
+    float *gd_batch_loss;         /**< Previous loss of each row, length batch */
+    int *gd_batch_no_improv;      /**< Iterations without improvement of each row, length batch */
+    Solution *start_solutions;    /**< Construction candidates, then GD results, length batch */
+
+    // Genetic algorithm
+    int ga_capacity;              /**< Number of individuals allocated */
+    Individual *ga_population;    /**< Current population */
+    Individual *ga_new_population;/**< Next population */
+    Individual **ga_sorted;       /**< Pointers to the population, sorted by fitness */
+    float *ga_usage;              /**< Usage buffer for offspring repair, length m */
+} Workspace;
+
+/**
+ * @brief Allocate all buffers of a workspace for a problem.
+ * @param ws   The workspace to set up.
+ * @param prob The problem the workspace will be used with.
+ * @param seed Seed of the workspace's random generator.
+ * @return 0 on success, non-zero otherwise.
+ */
+int workspace_init(Workspace *ws, const Problem *prob, uint64_t seed);
+
+/**
+ * @brief Switch the batch evaluation backend (only allocates if it changes).
+ * @return 0 on success, non-zero otherwise.
+ */
+int workspace_set_backend(Workspace *ws, const Problem *prob, BatchBackend backend);
+
+/**
+ * @brief Attach a thread pool (or NULL to scan sequentially) and size its per-thread scratch.
+ *
+ * Only allocates when the pool has more threads than the workspace has slots.
+ *
+ * @return 0 on success, non-zero otherwise.
+ */
+int workspace_set_pool(Workspace *ws, ThreadPool *pool);
+
+/**
+ * @brief The instance a method running on ws should read: ws's NUMA-local copy if it has one, else prob.
+ */
+static inline const Problem *workspace_problem(const Workspace *ws, const Problem *prob) {
+    return ws->local_prob ? ws->local_prob : prob;
+}
+
+/**
+ * @brief Make sure the GA population buffers can hold population_size individuals.
+ *
+ * Only allocates when the population grows beyond the current capacity.
+ *
+ * @return 0 on success, non-zero otherwise.
+ */
+int workspace_reserve_population(Workspace *ws, int population_size);
+
+/**
+ * @brief Make sure the batched gradient descent buffers can hold batch rows.
+ *
+ * Only allocates when the batch grows beyond the current capacity.
+ *
+ * @return 0 on success, non-zero otherwise.
+ */
+int workspace_reserve_gd_batch(Workspace *ws, int batch);
+
+/**
+ * @brief Reallocate a workspace for a problem whose number of items changed.
+ *
+ * The random generator state, the evaluation backend, the thread pool, the GA population and GD
+ * batch capacities are kept. The elite pool is emptied (its members no longer match the items).
+ *
+ * @return 0 on success, non-zero otherwise.
+ */
+int workspace_resize(Workspace *ws, const Problem *prob);
+
+/**
+ * @brief Free all buffers of a workspace.
+ */
+void workspace_free(Workspace *ws);
+
+#endif // WORKSPACE_H
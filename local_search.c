@@ -1,10 +1,25 @@
 #include <local_search.h>
 #include <utils.h>
+#include <move_eval.h>
+#include <stats.h>
+#include <profiler.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Below this many candidate adds, swap search tests them one by one in profit order (stopping at
+// the first that fits) rather than computing a batched feasibility mask
+#define SWAP_BATCH_MIN MOVE_EVAL_BLOCK
+
+// Below this many items, swap search scans sequentially even if the workspace has a thread pool
+#define SWAP_PARALLEL_MIN 2048
+
+// Tasks per thread of a parallel swap scan: smaller tasks balance the uneven cost of the items
+#define SWAP_TASKS_PER_THREAD 4
+
 void repair_solution(const Problem *prob, Solution *sol, float *usage, float *cur_value) {
+    PROFILE_ZONE("repair_solution");
     // We can remove up to n items
     for (int iteration = 0; iteration < prob->n; iteration++) {
         // Check feasibility
@@ -19,6 +34,7 @@ void repair_solution(const Problem *prob, Solution *sol, float *usage, float *cu
             sol->feasible = true;
             break;
         }
+        if (iteration == 0) stats_inc(STAT_REPAIRS);
 
         // Not feasible => remove one "worst" item by ratio
         int worst_item = -1;
@@ -41,208 +57,441 @@ void repair_solution(const Problem *prob, Solution *sol, float *usage, float *cu
         }
 
         // Remove this worst-ratio item
+        stats_inc(STAT_REPAIR_DROPS);
         sol->x[worst_item] = 0.0f;
         *cur_value -= prob->c[worst_item];
 
+        const float *w = &prob->weights_by_item[worst_item * prob->m];
         for (int i = 0; i < prob->m; i++) {
-            usage[i] -= prob->weights[i * prob->n + worst_item];
+            usage[i] -= w[i];
         }
     }
 }
 
-void local_search_flip(const Problem *prob, Solution *current_sol, const int max_checks, const LSMode mode) {
-    // Usage of the current solution
-    auto current_usage = (float*)malloc(prob->m * sizeof(float));
-    if (!current_usage) {
-        fprintf(stderr, "Memory allocation error in local_search.\n");
-        exit(EXIT_FAILURE);
+/* Internal helper to check whether swapping out the item of weights w_i for item j fits */
+static inline bool swap_fits(const Problem *prob, const float *usage, const float *w_i, const int j) {
+    const float *w_j = &prob->weights_by_item[j * prob->m];
+    for (int k = 0; k < prob->m; k++) {
+        if (usage[k] - w_i[k] + w_j[k] > prob->capacities[k]) {
+            return false;
+        }
     }
+    return true;
+}
 
-    // Compute initial usage
+/* Internal helper to set the feasibility of a solution from its usage */
+static inline void set_feasibility(const Problem *prob, Solution *sol, const float *usage) {
+    bool feasible = true;
     for (int i = 0; i < prob->m; i++) {
-        float weighted_sum = 0.0f;
-        for (int j = 0; j < prob->n; j++) {
-            weighted_sum += prob->weights[i * prob->n + j] * current_sol->x[j];
+        if (usage[i] > prob->capacities[i]) {
+            feasible = false;
+            break;
         }
-        current_usage[i] = weighted_sum;
     }
+    sol->feasible = feasible;
+}
 
-    float current_value = current_sol->value;
-    bool improved = true;
+/* Internal helper to check whether item j fits in the slack of usage */
+static inline bool item_fits(const Problem *prob, const float *usage, const int j) {
+    const float *w = &prob->weights_by_item[j * prob->m];
+    for (int i = 0; i < prob->m; i++) {
+        if (usage[i] + w[i] > prob->capacities[i]) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    // Candidate solution + usage
-    Solution candidate_sol;
-    allocate_solution(&candidate_sol, prob->n);
+/* Internal helper to fill ws->ls_window_mask with the unselected items of the window */
+static void build_window_mask(const Problem *prob, const Solution *sol, const int limit, Workspace *ws) {
+    uint64_t *window = ws->ls_window_mask;
+    memset(window, 0, move_mask_words(prob->n) * sizeof(uint64_t));
+    for (int idx = 0; idx < limit; idx++) {
+        const int j = prob->candidate_list[idx];
+        if (sol->x[j] < 0.5f) {
+            window[j / MOVE_EVAL_BLOCK] |= (uint64_t)1 << (j % MOVE_EVAL_BLOCK);
+        }
+    }
+}
 
-    float *candidate_usage = malloc(prob->m * sizeof(float));
-    if (!candidate_usage) {
-        free_solution(&candidate_sol);
-        free(current_usage);
-        fprintf(stderr, "Memory allocation error in local_search.\n");
-        exit(EXIT_FAILURE);
+/* Internal helper to build the add-feasible set: unselected items of the window that fit, in window order */
+static int build_fit_set(const Problem *prob, const Solution *sol, const float *usage, const int limit, int *fit,
+                         Workspace *ws) {
+    build_window_mask(prob, sol, limit, ws);
+    if (move_fit_mask(prob, usage, nullptr, ws->ls_window_mask, ws->ls_slack, ws->ls_fit_mask) == 0) {
+        return 0;
     }
+    int count = 0;
+    for (int idx = 0; idx < limit; idx++) {
+        const int j = prob->candidate_list[idx];
+        if (move_mask_test(ws->ls_fit_mask, j)) {
+            fit[count++] = j;
+        }
+    }
+    return count;
+}
 
-    // Only explore top-max_checks items from candidate_list
-    const int limit = (max_checks <= prob->n) ? max_checks : prob->n;
-    while (improved) {
-        improved = false;
+/* Internal helper: whether a swap of gain delta removing item i beats the best one so far */
+static inline bool swap_is_better(const float delta, const int i, const float best_delta, const int best_i) {
+    return best_i == -1 ? delta > best_delta : (delta > best_delta || (delta == best_delta && i < best_i));
+}
 
-        // Copy "current" -> "candidate"
-        copy_solution(current_sol, &candidate_sol);
-        memcpy(candidate_usage, current_usage, prob->m * sizeof(float));
-        const auto candidate_value = current_value;
+/* Shared state of one feasible-swap scan over the selected items */
+typedef struct {
+    const Problem *prob;
+    const Solution *sol;
+    const float *usage;
+    const float (*out)[2];   // (c_j, j) of the unselected items of the window, by profit descending
+    int out_count;
+    LSMode mode;
+    int chunk;               // items per task of a parallel scan
+    SwapScan *scans;         // per-thread scratch and bests
+    _Atomic float bound;     // best gain found by any thread so far (prunes the others)
+    atomic_bool stop;        // first improvement: some thread found an improving swap
+} SwapScanJob;
+
+/* Internal helper: raise the shared bound of a scan to delta */
+static void publish_bound(SwapScanJob *job, const float delta) {
+    float bound = atomic_load_explicit(&job->bound, memory_order_relaxed);
+    while (delta > bound &&
+           !atomic_compare_exchange_weak_explicit(&job->bound, &bound, delta,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
 
-        int   best_item = -1;
-        float best_value_increase = 0.0f;
-        for (int idx = 0; idx < limit; idx++) {
-            const int j = (int)prob->candidate_list[idx];
-            // Skip items already in the solution (we only do 0 -> 1)
-            if (candidate_sol.x[j] > 0.5f) {
-                continue;
-            }
+/* Internal helper to find the best feasible improving swap removing an item of [begin, end), merged into scan */
+static void scan_swaps(SwapScanJob *job, const int begin, const int end, SwapScan *scan) {
+    const Problem *prob = job->prob;
+    const Solution *sol = job->sol;
+    const float (*out)[2] = job->out;
+    const int out_count = job->out_count;
+    const int m = prob->m;
+    const float best_c_out = (out_count > 0) ? out[0][0] : 0.0f;
+    const int words = move_mask_words(prob->n);
+    uint64_t *filter = scan->filter;
+
+    int best_i = -1;
+    int best_j = -1;
+    float best_delta = 0.0f;
+    uint64_t moves = 0;
+    for (int i = begin; i < end; i++) {
+        if (sol->x[i] < 0.5f) {
+            continue; // skip items not in the solution
+        }
+        if (job->mode == LS_FIRST_IMPROVEMENT && atomic_load_explicit(&job->stop, memory_order_relaxed)) {
+            break;
+        }
+        const float ci = prob->c[i]; // value of the item in solution
 
-            // Proposed flip => from 0 to 1
-            const float delta_value = prob->c[j];
-            const float new_value   = candidate_value + delta_value;
+        // Gains below the shared bound cannot win; equal ones still can (smaller i)
+        const float bound = atomic_load_explicit(&job->bound, memory_order_relaxed);
+        if (best_c_out - ci <= best_delta || best_c_out - ci < bound) {
+            continue; // no j can beat the best delta
+        }
 
-            // If new_value is strictly better
-            if (new_value > candidate_value) {
-                // First improvement => break on first better
-                if (mode == LS_FIRST_IMPROVEMENT) {
-                    best_item = j;
-                    break;
+        // The j that would beat the best delta are a prefix of the profit order
+        int candidates = 0;
+        while (candidates < out_count && out[candidates][0] - ci > best_delta && out[candidates][0] - ci >= bound) {
+            candidates++;
+        }
+        const float *w_i = &prob->weights_by_item[i * m];
+        bool found = false;
+
+        if (candidates < SWAP_BATCH_MIN) {
+            // Short prefix: in profit order (ties by index), the first j that fits is the best one for
+            // this i, whatever the length of the prefix
+            for (int o = 0; o < candidates && !found; o++) {
+                const int j = (int)out[o][1];
+                moves++;
+                if (swap_fits(prob, job->usage, w_i, j)) {
+                    best_i = i;
+                    best_j = j;
+                    best_delta = out[o][0] - ci;
+                    found = true;
                 }
-                // Best improvement => track maximum
-                if (mode == LS_BEST_IMPROVEMENT) {
-                    if (delta_value > best_value_increase) {
-                        best_item = j;
-                        best_value_increase = delta_value;
+            }
+        }
+        else {
+            // Long prefix: one batched feasibility mask over it
+            memset(filter, 0, words * sizeof(uint64_t));
+            for (int o = 0; o < candidates; o++) {
+                const int j = (int)out[o][1];
+                filter[j / MOVE_EVAL_BLOCK] |= (uint64_t)1 << (j % MOVE_EVAL_BLOCK);
+            }
+            // The same j as the short prefix: the first one that fits, in profit order
+            if (move_fit_mask(prob, job->usage, w_i, filter, scan->slack, scan->fit_mask) > 0) {
+                for (int o = 0; o < candidates && !found; o++) {
+                    const int j = (int)out[o][1];
+                    if ((scan->fit_mask[j / MOVE_EVAL_BLOCK] >> (j % MOVE_EVAL_BLOCK)) & 1) {
+                        best_i = i;
+                        best_j = j;
+                        best_delta = out[o][0] - ci; // how much we gain by removing i and adding j
+                        found = true;
                     }
                 }
             }
         }
 
-        // If we found no improvement, stop
-        if (best_item == -1) {
-            break;
+        if (found) {
+            publish_bound(job, best_delta);
+            // If first improvement mode found an improvement, stop searching (every thread)
+            if (job->mode == LS_FIRST_IMPROVEMENT) {
+                atomic_store_explicit(&job->stop, true, memory_order_relaxed);
+                break;
+            }
         }
+    }
 
-        // Apply flip to candidate
-        candidate_sol.x[best_item] = 1.0f;
-        float new_candidate_value = candidate_value + prob->c[best_item];
+    stats_add(STAT_INCREMENTAL_MOVES, moves);
+    if (best_i != -1 && swap_is_better(best_delta, best_i, scan->best_delta, scan->best_i)) {
+        scan->best_i = best_i;
+        scan->best_j = best_j;
+        scan->best_delta = best_delta;
+    }
+}
 
-        // Update usage : add weights of the new item. Improvement means it cannot be an already used item, or an unused.
-        for (int i = 0; i < prob->m; i++) {
-            const float w_j = prob->weights[i * prob->n + best_item];
-            candidate_usage[i] += w_j;
-        }
+/* Internal helper: one task of a parallel swap scan (a chunk of items) */
+static void swap_scan_task(void *arg, const int task, const int worker) {
+    SwapScanJob *job = arg;
+    const int begin = task * job->chunk;
+    const int end = (begin + job->chunk < job->prob->n) ? begin + job->chunk : job->prob->n;
+    if (begin < end) {
+        scan_swaps(job, begin, end, &job->scans[worker]);
+    }
+}
 
-        // Repair if infeasible
-        bool infeasible = false;
-        for (int i = 0; i < prob->m; i++) {
-            if (candidate_usage[i] > prob->capacities[i]) {
-                infeasible = true;
+void local_search_flip_ctx(SearchContext *ctx) {
+    PROFILE_ZONE("local_search_flip");
+    // Nothing changed since the last flip search stopped
+    if (ctx->flip_optimal) {
+        return;
+    }
+    const Problem *prob = ctx->prob;
+    const int m = prob->m;
+    Workspace *ws = ctx->ws;
+
+    // Current solution and its usage, maintained incrementally
+    Solution *current_sol = ctx->sol;
+    float *current_usage = ctx->usage;
+
+    // Scratch candidate + usage, only filled when a move needs a repair
+    Solution candidate_sol = ws->ls_candidate;
+    float *candidate_usage = ws->ls_candidate_usage;
+
+    // Only explore top-max_checks items from candidate_list. The add-feasible set holds those that
+    // are unselected and fit in the current slack, in candidate_list order. Adding items only
+    // shrinks the slack, so an item that stopped fitting is never looked at again until a
+    // repair frees capacity and the set is rebuilt.
+    const int limit = (ctx->ls_k <= prob->n) ? ctx->ls_k : prob->n;
+    int *fit = ws->ls_fit;
+    int fit_count = build_fit_set(prob, current_sol, current_usage, limit, fit, ws);
+    bool changed = false;
+
+    while (true) {
+        stats_inc(STAT_LS_ITERATIONS);
+        const float current_value = current_sol->value;
+
+        if (fit_count > 0) {
+            // Feasible flip: first improvement takes the best-ranked item, best improvement the
+            // most profitable one. Both are strictly improving and need no repair.
+            int best_pos = 0;
+            if (ctx->ls_mode == LS_BEST_IMPROVEMENT) {
+                for (int f = 1; f < fit_count; f++) {
+                    if (prob->c[fit[f]] > prob->c[fit[best_pos]]) {
+                        best_pos = f;
+                    }
+                }
+            }
+            const int best_item = fit[best_pos];
+            if (prob->c[best_item] <= 0.0f) {
                 break;
             }
-        }
-        if (infeasible) {
-            repair_solution(prob, &candidate_sol, candidate_usage, &new_candidate_value);
-        }
-
-        // Revert if not strictly better
-        if (new_candidate_value <= candidate_value) {
-            // do nothing (don't apply candidate to current) => revert
-        } else {
-            // Accept => update current solution
-            improved = true;
-            candidate_sol.value = new_candidate_value;
 
-            // Check final feasibility after repair
-            bool feasible_sol = true;
-            for (int i = 0; i < prob->m; i++) {
-                if (candidate_usage[i] > prob->capacities[i]) {
-                    feasible_sol = false;
-                    break;
+            // Apply the flip in place
+            const float *w = &prob->weights_by_item[best_item * m];
+            current_sol->x[best_item] = 1.0f;
+            current_sol->value = current_value + prob->c[best_item];
+            for (int i = 0; i < m; i++) {
+                current_usage[i] += w[i];
+            }
+            changed = true;
+            stats_inc(STAT_LS_IMPROVEMENTS);
+
+            // Keep the items that still fit, in order
+            int kept = 0;
+            for (int f = 0; f < fit_count; f++) {
+                const int j = fit[f];
+                if (j != best_item && item_fits(prob, current_usage, j)) {
+                    fit[kept++] = j;
                 }
             }
-            candidate_sol.feasible = feasible_sol;
+            stats_add(STAT_INCREMENTAL_MOVES, (uint64_t)fit_count);
+            fit_count = kept;
+            continue;
+        }
 
-            // Swap solutions & usage
-            swap_solutions(current_sol, &candidate_sol);
-            float *tmp_usage = current_usage;
-            current_usage = candidate_usage;
-            candidate_usage = tmp_usage;
+        // No item fits: try adding the best unselected item of the window and repairing
+        int best_item = -1;
+        for (int idx = 0; idx < limit; idx++) {
+            const int j = prob->candidate_list[idx];
+            if (current_sol->x[j] > 0.5f || prob->c[j] <= 0.0f) {
+                continue;
+            }
+            if (ctx->ls_mode == LS_FIRST_IMPROVEMENT) {
+                best_item = j;
+                break;
+            }
+            if (best_item == -1 || prob->c[j] > prob->c[best_item]) {
+                best_item = j;
+            }
+        }
+        stats_add(STAT_INCREMENTAL_MOVES, (uint64_t)limit);
+        if (best_item == -1) {
+            break;
+        }
 
-            // Update local
-            current_value = current_sol->value;
+        const float *w = &prob->weights_by_item[best_item * m];
+        copy_solution(current_sol, &candidate_sol);
+        memcpy(candidate_usage, current_usage, m * sizeof(float));
+        candidate_sol.x[best_item] = 1.0f;
+        float new_candidate_value = current_value + prob->c[best_item];
+        for (int i = 0; i < m; i++) {
+            candidate_usage[i] += w[i];
         }
-    }
+        repair_solution(prob, &candidate_sol, candidate_usage, &new_candidate_value);
 
-    // Final feasibility check
-    bool feasible = true;
-    for (int i = 0; i < prob->m; i++) {
-        if (current_usage[i] > prob->capacities[i]) {
-            feasible = false;
+        // Accept only if strictly better (otherwise the candidate is discarded and we stop)
+        if (new_candidate_value <= current_value) {
             break;
         }
+        stats_inc(STAT_LS_IMPROVEMENTS);
+        candidate_sol.value = new_candidate_value;
+        set_feasibility(prob, &candidate_sol, candidate_usage);
+
+        // Swap solutions & usage
+        swap_solutions(current_sol, &candidate_sol);
+        float *tmp_usage = current_usage;
+        current_usage = candidate_usage;
+        candidate_usage = tmp_usage;
+        changed = true;
+
+        // The repair freed capacity: rebuild the add-feasible set
+        fit_count = build_fit_set(prob, current_sol, current_usage, limit, fit, ws);
     }
-    current_sol->feasible = feasible;
 
-    // Cleanup
-    free(candidate_usage);
-    free_solution(&candidate_sol);
-    free(current_usage);
-}
+    // Final feasibility check
+    set_feasibility(prob, current_sol, current_usage);
 
-void local_search_swap(const Problem *prob, Solution *current_sol, const int max_checks, const LSMode mode) {
-    // Compute the usage of the current solution
-    auto current_usage = (float*)malloc(prob->m * sizeof(float));
-    if (!current_usage) {
-        fprintf(stderr, "Memory allocation error in local_search_swap.\n");
-        exit(EXIT_FAILURE);
-    }
-    for (int i = 0; i < prob->m; i++) {
-        float sum_w = 0.0f;
-        for (int j = 0; j < prob->n; j++) {
-            sum_w += prob->weights[i * prob->n + j] * current_sol->x[j];
-        }
-        current_usage[i] = sum_w;
+    // Update the don't-look bits
+    if (changed) {
+        search_context_invalidate(ctx);
     }
+    ctx->flip_optimal = true;
 
-    float current_value = current_sol->value;
-    bool improved = true;
-
-    // Allocate candidate solution and usage
-    Solution candidate_sol;
-    allocate_solution(&candidate_sol, prob->n);
+    // Hand the (possibly swapped) buffers back
+    ctx->usage = current_usage;
+    ws->ls_candidate = candidate_sol;
+    ws->ls_candidate_usage = candidate_usage;
+}
 
-    auto candidate_usage = (float*)malloc(prob->m * sizeof(float));
-    if (!candidate_usage) {
-        free_solution(&candidate_sol);
-        free(current_usage);
-        fprintf(stderr, "Memory allocation error in local_search_swap.\n");
-        exit(EXIT_FAILURE);
+void local_search_swap_ctx(SearchContext *ctx) {
+    PROFILE_ZONE("local_search_swap");
+    // Nothing changed since the last swap search stopped
+    if (ctx->swap_optimal) {
+        return;
     }
+    const Problem *prob = ctx->prob;
+    const int m = prob->m;
+    Workspace *ws = ctx->ws;
+
+    // Current solution and its usage, maintained incrementally
+    Solution *current_sol = ctx->sol;
+    float *current_usage = ctx->usage;
+
+    // Scratch candidate + usage, only filled when a move needs a repair
+    Solution candidate_sol = ws->ls_candidate;
+    float *candidate_usage = ws->ls_candidate_usage;
 
     // We only explore top-max_checks items from candidate_list
-    const int limit = (max_checks <= prob->n) ? max_checks : prob->n;
+    const int limit = (ctx->ls_k <= prob->n) ? ctx->ls_k : prob->n;
 
     // Main local search loop
+    bool changed = false;
+    bool improved = true;
     while (improved) {
         improved = false;
-
-        // Copy current -> candidate
-        copy_solution(current_sol, &candidate_sol);
-        memcpy(candidate_usage, current_usage, prob->m * sizeof(float));
-        const float candidate_value = current_value;
+        stats_inc(STAT_LS_ITERATIONS);
+        const float current_value = current_sol->value;
 
         int best_i = -1; // item to remove
         int best_j = -1; // item to add
         float best_delta = 0.0f;
 
-        // Explore swaps: i in solution, j not in solution (from candidate_list)
+        // Feasible swaps first. The unselected items of the window are sorted by profit once; then
+        // for each i in the solution, only the j that would beat the best delta are checked.
+        float (*out)[2] = ws->ls_profit_pairs; // (c_j, j) of the unselected items, by profit descending then index
+        int out_count = 0;
+        for (int idx = 0; idx < limit; idx++) {
+            const int j = prob->candidate_list[idx];
+            if (current_sol->x[j] < 0.5f) {
+                out[out_count][0] = prob->c[j];
+                out[out_count][1] = (float)j;
+                out_count++;
+            }
+        }
+        qsort(out, out_count, sizeof(*out), compare_pairs_descending);
+
+        // Scan the selected items, split over the pool threads on large instances
+        SwapScanJob job = {
+            .prob = prob, .sol = current_sol, .usage = current_usage,
+            .out = (const float (*)[2])out, .out_count = out_count, .mode = ctx->ls_mode,
+            .scans = ws->ls_scans
+        };
+        atomic_init(&job.bound, 0.0f);
+        atomic_init(&job.stop, false);
+        const int threads = (prob->n >= SWAP_PARALLEL_MIN) ? thread_pool_size(ws->pool) : 1;
+        for (int t = 0; t < threads; t++) {
+            ws->ls_scans[t].best_i = -1;
+            ws->ls_scans[t].best_delta = 0.0f;
+        }
+        if (threads > 1) {
+            const int tasks = threads * SWAP_TASKS_PER_THREAD;
+            job.chunk = (prob->n + tasks - 1) / tasks;
+            thread_pool_run(ws->pool, swap_scan_task, &job, tasks);
+        } else {
+            scan_swaps(&job, 0, prob->n, &ws->ls_scans[0]);
+        }
+
+        // Reduce the per-thread bests (ties go to the smallest i, as in a sequential scan)
+        for (int t = 0; t < threads; t++) {
+            const SwapScan *scan = &ws->ls_scans[t];
+            if (scan->best_i != -1 && swap_is_better(scan->best_delta, scan->best_i, best_delta, best_i)) {
+                best_i = scan->best_i;
+                best_j = scan->best_j;
+                best_delta = scan->best_delta;
+            }
+        }
+
+        if (best_i != -1) {
+            // Feasible swap: strictly improving, apply it in place
+            const float *w_i = &prob->weights_by_item[best_i * m];
+            const float *w_j = &prob->weights_by_item[best_j * m];
+            current_sol->x[best_i] = 0.0f;
+            current_sol->x[best_j] = 1.0f;
+            current_sol->value = current_value + best_delta;
+            for (int k = 0; k < m; k++) {
+                current_usage[k] = current_usage[k] - w_i[k] + w_j[k];
+            }
+            improved = true;
+            changed = true;
+            stats_inc(STAT_LS_IMPROVEMENTS);
+            continue;
+        }
+
+        // No feasible improving swap: take the most profitable one and repair it
+        uint64_t moves_evaluated = 0;
         for (int i = 0; i < prob->n; i++) {
-            if (candidate_sol.x[i] < 0.5f) {
+            if (current_sol->x[i] < 0.5f) {
                 continue; // skip items not in the solution
             }
             const float ci = prob->c[i]; // value of the item in solution
@@ -250,40 +499,24 @@ void local_search_swap(const Problem *prob, Solution *current_sol, const int max
             // Iterate over the top-limit items in candidate_list as "j"
             bool break_outer_loop = false; // boolean to break when a first improvement is found
             for (int idx = 0; idx < limit; idx++) {
-                const int j = (int) prob->candidate_list[idx];
-                if (candidate_sol.x[j] > 0.5f) {
+                const int j = prob->candidate_list[idx];
+                if (current_sol->x[j] > 0.5f) {
                     // j is already in the solution, skip
                     continue;
                 }
 
-                const float cj = prob->c[j];  // item value not in solution
-                const float delta = cj - ci;  // how much we gain by removing i and adding j
+                moves_evaluated++;
+                const float delta = prob->c[j] - ci;  // how much we gain by removing i and adding j
 
                 // We only consider strictly positive deltas (for a direct improvement)
-                if (delta <= 0.0f) {
-                    continue; // Find next j
-                }
-
-                // Improvement found
-                const float new_value = candidate_value + delta;
-                if (new_value > candidate_value) {
-                    // We found a potential improvement
-                    if (mode == LS_FIRST_IMPROVEMENT) {
-                        // Record and break immediately
-                        best_i = i;
-                        best_j = j;
-                        best_delta = delta;
+                if (delta > best_delta) {
+                    best_i = i;
+                    best_j = j;
+                    best_delta = delta;
+                    if (ctx->ls_mode == LS_FIRST_IMPROVEMENT) {
                         break_outer_loop = true;
                         break;
                     }
-                    if (mode == LS_BEST_IMPROVEMENT) {
-                        // Track best improvement
-                        if (delta > best_delta) {
-                            best_i = i;
-                            best_j = j;
-                            best_delta = delta;
-                        }
-                    }
                 }
             } // end of inner loop (comparing with item j)
 
@@ -293,71 +526,77 @@ void local_search_swap(const Problem *prob, Solution *current_sol, const int max
             }
         }
 
+        stats_add(STAT_INCREMENTAL_MOVES, moves_evaluated);
+
         // If no improvement found, exit the global loop
         if (best_i == -1 || best_j == -1) {
             break;
         }
 
-        // Apply the chosen swap to candidate
+        const float *w_i = &prob->weights_by_item[best_i * m];
+        const float *w_j = &prob->weights_by_item[best_j * m];
+
+        // Infeasible swap: apply it to the candidate and repair, the current solution stays intact
+        copy_solution(current_sol, &candidate_sol);
+        memcpy(candidate_usage, current_usage, m * sizeof(float));
         candidate_sol.x[best_i] = 0.0f;
         candidate_sol.x[best_j] = 1.0f;
-        float new_candidate_value = candidate_value + best_delta;
-
-        // Update usage
-        for (int k = 0; k < prob->m; k++) {
-            candidate_usage[k] = candidate_usage[k] - prob->weights[k * prob->n + best_i] + prob->weights[k * prob->n + best_j];
-        }
-
-        // Repair if infeasible
-        bool infeasible = false;
-        for (int k = 0; k < prob->m; k++) {
-            if (candidate_usage[k] > prob->capacities[k]) {
-                infeasible = true;
-                break;
-            }
-        }
-        if (infeasible) {
-            repair_solution(prob, &candidate_sol, candidate_usage, &new_candidate_value);
+        float new_candidate_value = current_value + best_delta;
+        for (int k = 0; k < m; k++) {
+            candidate_usage[k] = candidate_usage[k] - w_i[k] + w_j[k];
         }
+        repair_solution(prob, &candidate_sol, candidate_usage, &new_candidate_value);
 
         // Accept the move only if strictly better
-        if (new_candidate_value > candidate_value) {
+        if (new_candidate_value > current_value) {
             improved = true;
+            changed = true;
+            stats_inc(STAT_LS_IMPROVEMENTS);
             candidate_sol.value = new_candidate_value;
-
-            // final feasibility check
-            bool feasible_sol = true;
-            for (int k = 0; k < prob->m; k++) {
-                if (candidate_usage[k] > prob->capacities[k]) {
-                    feasible_sol = false;
-                    break;
-                }
-            }
-            candidate_sol.feasible = feasible_sol;
+            set_feasibility(prob, &candidate_sol, candidate_usage);
 
             // Swap solutions & usage
             swap_solutions(current_sol, &candidate_sol);
             float *tmp_usage = current_usage;
             current_usage = candidate_usage;
             candidate_usage = tmp_usage;
-
-            current_value = current_sol->value;
         }
-        // otherwise, we discard candidate_sol changes and continue
+        // otherwise, we discard candidate_sol changes and stop
     }
 
     // Final feasibility check on current_sol
-    bool feasible = true;
-    for (int i = 0; i < prob->m; i++) {
-        if (current_usage[i] > prob->capacities[i]) {
-            feasible = false;
-            break;
-        }
+    set_feasibility(prob, current_sol, current_usage);
+
+    // Update the don't-look bits
+    if (changed) {
+        search_context_invalidate(ctx);
     }
-    current_sol->feasible = feasible;
+    ctx->swap_optimal = true;
+
+    // Hand the (possibly swapped) buffers back
+    ctx->usage = current_usage;
+    ws->ls_candidate = candidate_sol;
+    ws->ls_candidate_usage = candidate_usage;
+}
+
+void local_search_flip(const Problem *prob, Solution *current_sol, const int max_checks, const LSMode mode,
+                       Workspace *ws) {
+    compute_usage_from_solution(prob, current_sol, ws->ls_usage);
+    SearchContext ctx = {
+        .prob = prob, .ws = ws, .sol = current_sol, .usage = ws->ls_usage,
+        .ls_k = max_checks, .ls_mode = mode
+    };
+    local_search_flip_ctx(&ctx);
+    ws->ls_usage = ctx.usage;
+}
 
-    // Cleanup
-    free(candidate_usage);
-    free_solution(&candidate_sol);
-    free(current_usage);
+void local_search_swap(const Problem *prob, Solution *current_sol, const int max_checks, const LSMode mode,
+                       Workspace *ws) {
+    compute_usage_from_solution(prob, current_sol, ws->ls_usage);
+    SearchContext ctx = {
+        .prob = prob, .ws = ws, .sol = current_sol, .usage = ws->ls_usage,
+        .ls_k = max_checks, .ls_mode = mode
+    };
+    local_search_swap_ctx(&ctx);
+    ws->ls_usage = ctx.usage;
 }
@@ -6,88 +6,10 @@
 
 #include <data_structure.h>
 #include <utils.h>          // parse args, parse_instance, free_problem,...
-#include <local_search.h>
-#include <vnd.h>
-#include <vns.h>
-#include <gradesc.h>
-#include <genetic.h>
-
-
-/* Multi-start approach: for each random init, we run GD, then VNS, keep the best solution */
-static void multi_start_gd_vns(const Problem *prob, const Arguments *args,
-                               void (*eval_func)(const Problem*, Solution*),
-                               Solution *best_sol) {
-    Solution candidate;
-    allocate_solution(&candidate, prob->n);
-
-    // We can keep track of time
-    const clock_t start_time = clock();
-
-    best_sol->value = -INFINITY;
-    best_sol->feasible = false;
-
-    // For multiple starts, we do random init => GD => VNS => compare
-    for (int s = 0; s < args->num_starts; s++) {
-        if (time_is_up(start_time, args->max_time)) break;
-
-        // Construct a random solution
-        for (int j = 0; j < prob->n; j++) {
-            candidate.x[j] = (rand() % 2) ? 1.0f : 0.0f;
-        }
-        eval_func(prob, &candidate);
-
-        // Run gradient descent if time remains
-        if (!time_is_up(start_time, args->max_time)) {
-            gradient_solver(prob,
-                            args->lambda,
-                            args->learning_rate,
-                            args->max_no_improv,
-                            &candidate,
-                            args->log_level,
-                            start_time, args->max_time);
-        }
-
-        // Run VNS if time remains
-        if (!time_is_up(start_time, args->max_time)) {
-            vns(prob,
-                &candidate,
-                args->max_no_improv,
-                args->k_max,
-                args->ls_max_checks,
-                LS_BEST_IMPROVEMENT,
-                start_time,
-                args->max_time,
-                args->log_level);
-        }
-
-        // Runs GenAlg if time remains
-        if (!time_is_up(start_time, args->max_time)) {
-            genetic_algorithm(prob,
-                              &candidate,
-                              args->population_size,
-                              args->max_generations,
-                              args->mutation_rate,
-                              start_time,
-                              args->max_time,
-                              args->log_level);
-        }
-
-        // Evaluate or re-check feasibility if needed
-        eval_func(prob, &candidate);
-        candidate.feasible = check_feasibility(prob, &candidate);
-
-        // Compare with best
-        if ((candidate.feasible && !best_sol->feasible) ||
-            (candidate.feasible == best_sol->feasible && candidate.value > best_sol->value)) {
-            copy_solution(&candidate, best_sol);
-            if (args->log_level >= INFO) {
-                printf("New best solution: %.2f\n", best_sol->value);
-            }
-        }
-    }
+#include <mkp.h>           // solver handle, methods
+#include <stats.h>
+#include <profiler.h>
 
-    free_solution(&candidate);
-}
 
 /**
  * @brief Main entry point
@@ -99,34 +21,46 @@ int main(const int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    // Read the MKP instance
-    Problem prob;
-    if (parse_instance(args.instance_file, &prob) != 0) {
+    // Wall-clock reference for the stats report (includes parsing)
+    const uint64_t wall_start = stats_now_ns();
+
+    // Read the MKP instance (or take it from the shared segment) and set up the solver (workspace, RNG)
+    MkpParams params;
+    mkp_params_from_args(&args, &params);
+    MkpSolver *solver = args.coop_shm
+        ? mkp_solver_create_shared(args.instance_file, args.coop_shm, &params, args.seed)
+        : mkp_solver_create(args.instance_file, &params, args.seed);
+    if (!solver) {
         return EXIT_FAILURE;
     }
 
-    // Choose evaluation function
-    void (*eval_func)(const Problem*, Solution*) =
-        args.use_gpu ? evaluate_solution_gpu : evaluate_solution_cpu;
-
-    // Seed RNG
-    srand(42);
+    // Warm start from a previously saved solution
+    if (args.init_file && mkp_solver_load_initial(solver, args.init_file) != 0) {
+        mkp_solver_destroy(solver);
+        return EXIT_FAILURE;
+    }
 
     // Keep track of overall time
-    const clock_t start = clock();
-
-    // Allocate a solution structure
-    Solution sol;
-    allocate_solution(&sol, prob.n);
+    const clock_t start = wall_clock();
 
     printf("--- MKP Solver ---\n");
     printf("Instance: %s\n", args.instance_file);
     printf("Method:   %s\n", args.method);
     printf("Max Time: %.2f sec\n", args.max_time);
+    if (args.init_file) {
+        printf("Init:     %s\n", args.init_file);
+    }
+    if (args.coop_shm) {
+        printf("Shared:   %s\n", args.coop_shm);
+    }
     printf("Verbosity: %s\n", args.log_level == NONE ? "NONE" : args.log_level == INFO ? "INFO" : "DEBUG");
 
     // Decide which approach to run
-    if (strcmp(args.method, "MULTI-GD-VNS") == 0) {
+    MkpMethod method = MKP_METHOD_LS_FLIP;
+    if (mkp_method_from_name(args.method, &method) != 0) {
+        fprintf(stderr, "Unknown method %s. Using LS-FLIP.\n", args.method);
+    }
+    if (method == MKP_METHOD_MULTI_GD_VNS) {
         printf("\nStarting Multi-start GD-VNS with these parameters:\n");
         printf("Num starts: %d\n", args.num_starts);
         printf("Lambda: %f\n", args.lambda);
@@ -135,99 +69,73 @@ int main(const int argc, char *argv[]) {
         printf("K max: %d\n", args.k_max);
         printf("LS k: %d\n", args.ls_max_checks);
         printf("LS mode: %s\n", args.ls_mode == LS_FIRST_IMPROVEMENT ? "First" : "Best");
-        multi_start_gd_vns(&prob, &args, eval_func, &sol);
     }
-    else if (strcmp(args.method, "LS-FLIP") == 0) {
+    else if (method == MKP_METHOD_LS_FLIP) {
         printf("\nStarting LS-FLIP with these parameters:\n");
         printf("LS max checks: %d\n", args.ls_max_checks);
         printf("Num starts: %d\n", args.num_starts);
-        construct_initial_solution(&prob, &sol, eval_func, args.num_starts);
-        local_search_flip(&prob, &sol, args.ls_max_checks, LS_BEST_IMPROVEMENT);
     }
-    else if (strcmp(args.method, "LS-SWAP") == 0) {
+    else if (method == MKP_METHOD_LS_SWAP) {
         printf("\nStarting LS-SWAP with these parameters:\n");
         printf("LS max checks: %d\n", args.ls_max_checks);
         printf("Num starts: %d\n", args.num_starts);
-        construct_initial_solution(&prob, &sol, eval_func, args.num_starts);
-        local_search_swap(&prob, &sol, args.ls_max_checks, LS_BEST_IMPROVEMENT);
     }
-    else if (strcmp(args.method, "GD") == 0) {
+    else if (method == MKP_METHOD_GD) {
         printf("\nStarting Gradient descent with these parameters:\n");
         printf("Lambda: %f\n", args.lambda);
         printf("Learning rate: %f\n", args.learning_rate);
         printf("Max no improvement: %d\n", args.max_no_improv);
-        construct_initial_solution(&prob, &sol, eval_func, args.num_starts);
-        gradient_solver(&prob,
-            args.lambda,
-            args.learning_rate,
-            args.max_no_improv,
-            &sol,
-            args.log_level,
-            start,
-            args.max_time);
     }
-    else if (strcmp(args.method, "VNS") == 0) {
+    else if (method == MKP_METHOD_VNS) {
         printf("\nStarting Variable Neighborhood Search with these parameters:\n");
         printf("Max no improvement: %d\n", args.max_no_improv);
         printf("K max: %d\n", args.k_max);
         printf("LS k: %d\n", args.ls_max_checks);
         printf("LS mode: %s\n", args.ls_mode == LS_FIRST_IMPROVEMENT ? "First" : "Best");
-        construct_initial_solution(&prob, &sol, eval_func, args.num_starts);
-        vns(&prob,
-            &sol,
-            args.max_no_improv,
-            args.k_max,
-            args.ls_max_checks,
-            LS_BEST_IMPROVEMENT,
-            start,
-            args.max_time,
-            args.log_level);
     }
-    else if (strcmp(args.method, "VND") == 0) {
+    else if (method == MKP_METHOD_VND) {
         printf("\nStarting Variable Neighborhood Descent with these parameters:\n");
         printf("Max no improvement: %d\n", args.max_no_improv);
         printf("LS k: %d\n", args.ls_max_checks);
         printf("LS mode: %s\n", args.ls_mode == LS_FIRST_IMPROVEMENT ? "First" : "Best");
-        construct_initial_solution(&prob, &sol, eval_func, args.num_starts);
-        vnd(&prob, &sol, args.max_no_improv, args.ls_max_checks, LS_BEST_IMPROVEMENT, start, args.max_time);
     }
-    else if (strcmp(args.method, "GA") == 0) {
+    else if (method == MKP_METHOD_GA) {
         printf("\nStarting Genetic Algorithm with these parameters:\n");
         printf("Population size: %d\n", args.population_size);
         printf("Max generations: %d\n", args.max_generations);
         printf("Mutation rate: %.2f\n", args.mutation_rate);
-        construct_initial_solution(&prob, &sol, eval_func, args.num_starts);
-        genetic_algorithm(&prob,
-            &sol,
-            args.population_size,
-            args.max_generations,
-            args.mutation_rate,
-            start,
-            args.max_time,
-            args.log_level);
-    }
-    else {
-        fprintf(stderr, "Unknown method %s. Using LS-FLIP.\n", args.method);
-        construct_initial_solution(&prob, &sol, eval_func, args.num_starts);
-        local_search_flip(&prob, &sol, args.ls_max_checks, LS_BEST_IMPROVEMENT);
     }
+    mkp_solve(solver, method, &params, args.max_time);
+    const Solution *sol = mkp_solver_solution(solver);
 
     // Measure elapsed time
-    const clock_t end = clock();
-    const double cpu_time_used = (double)(end - start) / CLOCKS_PER_SEC;
+    const clock_t end = wall_clock();
+    const double elapsed = (double)(end - start) / CLOCKS_PER_SEC;
 
     // Print final solution info
     printf("\nFinal Solution:\n");
-    printf("Value: %.2f\n", sol.value);
-    printf("Feasible: %s\n", sol.feasible ? "Yes" : "No");
-    printf("Time: %f seconds\n", cpu_time_used);
+    printf("Value: %.2f\n", sol->value);
+    printf("Feasible: %s\n", sol->feasible ? "Yes" : "No");
+    printf("Time: %f seconds\n", elapsed);
 
     // Save solution
-    save_solution(args.out_file, &sol);
+    save_solution(args.out_file, sol);
+
+    // Dump search counters and phase timers
+    if (args.stats_file) {
+        SearchStats stats;
+        stats_snapshot(&stats);
+        const double wall_seconds = (double)(stats_now_ns() - wall_start) * 1e-9;
+        stats_write_json(args.stats_file, &stats, args.instance_file, args.method, wall_seconds);
+    }
+
+    // Dump profiler zones (flamegraph + trace)
+    if (args.profile_prefix) {
+        profile_write(args.profile_prefix);
+    }
 
     // Cleanup
-    free_solution(&sol);
-    free_problem(&prob);
+    mkp_solver_destroy(solver);
 
     return EXIT_SUCCESS;
 }
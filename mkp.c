@@ -0,0 +1,693 @@
+//
+// libmkp: solver handle owning a problem, a workspace and an RNG.
+// Dispatches to the individual methods (LS, VND, VNS, GD, GA, multi-start).
+//
+#include <mkp.h>
+#include <workspace.h>
+#include <delta.h>
+#include <local_search.h>
+#include <vnd.h>
+#include <vns.h>
+#include <gradesc.h>
+#include <genetic.h>
+#include <relink.h>
+#include <tabu.h>
+#include <portfolio.h>
+#include <coop.h>
+#include <shm.h>
+#include <profiler.h>
+#include <thread_pool.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct MkpSolver {
+    Problem prob;     /**< The instance (owned) */
+    Workspace ws;     /**< Scratch buffers and RNG for all methods */
+    ThreadPool *pool; /**< Threads of the parallel scans (params->threads > 1), or NULL */
+    Workspace *workers; /**< Workspaces of the pool threads other than the caller, threads - 1 of them */
+    int num_workers;
+    Problem *replicas; /**< NUMA-local copies of prob, indexed by node (empty for the caller's node), or NULL */
+    int num_replicas;
+    uint64_t seed;    /**< Seed of the random generators (stream 0 for ws, t for workers[t - 1]) */
+    Solution best;    /**< Solution of the last solve */
+    float *usage;     /**< Usage of best, length m (kept in sync by mkp_solver_apply_delta) */
+    Solution initial; /**< Warm-start solution (repaired, feasible), valid if has_initial */
+    bool has_initial;
+    ShmSegment *shm;  /**< Segment shared with other solver processes, or NULL */
+    Solution imported; /**< Solution read from the shared board (allocated only with shm) */
+};
+
+static const char *method_names[MKP_METHOD_COUNT] = {
+    [MKP_METHOD_LS_FLIP]      = "LS-FLIP",
+    [MKP_METHOD_LS_SWAP]      = "LS-SWAP",
+    [MKP_METHOD_VND]          = "VND",
+    [MKP_METHOD_VNS]          = "VNS",
+    [MKP_METHOD_GD]           = "GD",
+    [MKP_METHOD_MULTI_GD_VNS] = "MULTI-GD-VNS",
+    [MKP_METHOD_GA]           = "GA",
+    [MKP_METHOD_PATH_RELINK]  = "PATH-RELINK",
+    [MKP_METHOD_TABU]         = "TABU",
+    [MKP_METHOD_PORTFOLIO]    = "PORTFOLIO",
+    [MKP_METHOD_COOP]         = "COOP",
+};
+
+void mkp_default_params(MkpParams *params) {
+    params->use_gpu         = 0;
+    params->num_starts      = 5;
+    params->lambda          = 1e-2f;
+    params->learning_rate   = 1e-2f;
+    params->ls_max_checks   = 500;
+    params->ls_mode         = LS_BEST_IMPROVEMENT;
+    params->order           = ORDER_RATIO;
+    params->threads         = default_threads();
+    params->vns_parallel    = VNS_SYNC;
+    params->deterministic   = false;
+    params->max_no_improv   = 100;
+    params->k_max           = 100;
+    params->population_size = 1000;
+    params->max_generations = 1000;
+    params->mutation_rate   = 0.01f;
+    params->log_level       = INFO;
+}
+
+void mkp_params_from_args(const Arguments *args, MkpParams *params) {
+    params->use_gpu         = args->use_gpu;
+    params->num_starts      = args->num_starts;
+    params->lambda          = args->lambda;
+    params->learning_rate   = args->learning_rate;
+    params->ls_max_checks   = args->ls_max_checks;
+    params->ls_mode         = args->ls_mode;
+    params->order           = args->order;
+    params->threads         = args->threads;
+    params->vns_parallel    = args->vns_parallel;
+    params->deterministic   = args->deterministic;
+    params->max_no_improv   = args->max_no_improv;
+    params->k_max           = args->k_max;
+    params->population_size = args->population_size;
+    params->max_generations = args->max_generations;
+    params->mutation_rate   = args->mutation_rate;
+    params->log_level       = args->log_level;
+}
+
+int mkp_method_from_name(const char *name, MkpMethod *method) {
+    for (int i = 0; i < MKP_METHOD_COUNT; i++) {
+        if (strcmp(name, method_names[i]) == 0) {
+            *method = (MkpMethod)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *mkp_method_name(const MkpMethod method) {
+    return (method >= 0 && method < MKP_METHOD_COUNT) ? method_names[method] : "UNKNOWN";
+}
+
+MkpSolver *mkp_solver_create(const char *instance_file, const MkpParams *params, const uint64_t seed) {
+    Problem prob;
+    if (parse_instance(instance_file, &prob) != 0) {
+        return nullptr;
+    }
+    MkpSolver *solver = mkp_solver_create_from_problem(&prob, params, seed);
+    if (!solver) {
+        free_problem(&prob);
+    }
+    return solver;
+}
+
+MkpSolver *mkp_solver_create_shared(const char *instance_file, const char *shm_name, const MkpParams *params,
+                                     const uint64_t seed) {
+    ShmSegment *shm = calloc(1, sizeof(ShmSegment));
+    if (!shm) {
+        fprintf(stderr, "Memory allocation error in mkp_solver_create_shared.\n");
+        return nullptr;
+    }
+    Problem prob;
+    if (shm_segment_open(shm, shm_name, instance_file, &prob) != 0) {
+        free(shm);
+        return nullptr;
+    }
+    MkpSolver *solver = mkp_solver_create_from_problem(&prob, params, seed);
+    if (!solver) {
+        free_problem(&prob);
+        shm_segment_close(shm);
+        free(shm);
+        return nullptr;
+    }
+    solver->shm = shm;
+    allocate_solution(&solver->imported, solver->prob.n);
+    return solver;
+}
+
+MkpSolver *mkp_solver_create_from_problem(Problem *prob, const MkpParams *params, const uint64_t seed) {
+    MkpSolver *solver = calloc(1, sizeof(MkpSolver));
+    if (!solver) {
+        fprintf(stderr, "Memory allocation error in mkp_solver_create.\n");
+        return nullptr;
+    }
+    solver->prob = *prob;
+    solver->seed = seed;
+
+    if (workspace_init(&solver->ws, &solver->prob, seed) != 0 ||
+        workspace_reserve_population(&solver->ws, params->population_size) != 0 ||
+        workspace_reserve_gd_batch(&solver->ws, params->num_starts) != 0) {
+        workspace_free(&solver->ws);
+        free(solver);
+        return nullptr;
+    }
+    solver->usage = (float*)calloc(solver->prob.m, sizeof(float));
+    if (!solver->usage) {
+        fprintf(stderr, "Memory allocation error in mkp_solver_create.\n");
+        workspace_free(&solver->ws);
+        free(solver);
+        return nullptr;
+    }
+    allocate_solution(&solver->best, solver->prob.n);
+    allocate_solution(&solver->initial, solver->prob.n);
+    memset(solver->best.x, 0, solver->prob.n * sizeof(float)); // empty until the first solve
+    solver->best.feasible = true;
+    solver->has_initial = false;
+    return solver;
+}
+
+/* Internal helper to free the NUMA-local copies of the instance */
+static void free_replicas(MkpSolver *solver) {
+    for (int node = 0; node < solver->num_replicas; node++) {
+        free_problem(&solver->replicas[node]);
+    }
+    free(solver->replicas);
+    solver->replicas = nullptr;
+    solver->num_replicas = 0;
+    for (int w = 0; w < solver->num_workers; w++) {
+        solver->workers[w].local_prob = nullptr;
+    }
+}
+
+/* Internal helper to free the workspaces of the pool threads */
+static void free_workers(MkpSolver *solver) {
+    free_replicas(solver);
+    for (int w = 0; w < solver->num_workers; w++) {
+        workspace_free(&solver->workers[w]);
+    }
+    free(solver->workers);
+    solver->workers = nullptr;
+    solver->num_workers = 0;
+}
+
+/* Internal helper: the first thread of each NUMA node other than the caller's copies the instance, so
+ * that the copy's pages are placed on that node */
+static void replicate_task(void *arg, const int task, const int worker) {
+    (void)task;
+    MkpSolver *solver = arg;
+    const int node = thread_pool_node(solver->pool, worker);
+    if (node == thread_pool_node(solver->pool, 0)) {
+        return;
+    }
+    for (int w = 1; w < worker; w++) {
+        if (thread_pool_node(solver->pool, w) == node) {
+            return;
+        }
+    }
+    // On failure the node's threads read the shared instance
+    copy_problem(&solver->prob, &solver->replicas[node]);
+}
+
+/* Internal helper to (re)build the per-node copies of the instance when the pool spans several
+ * NUMA nodes, and point the workspace of every thread to its node's copy */
+static int solver_replicate(MkpSolver *solver) {
+    free_replicas(solver);
+    int nodes = 1;
+    for (int t = 0; t < thread_pool_size(solver->pool); t++) {
+        const int node = thread_pool_node(solver->pool, t);
+        nodes = (node + 1 > nodes) ? node + 1 : nodes;
+    }
+    if (nodes == 1) {
+        return 0;
+    }
+    solver->replicas = (Problem*)calloc(nodes, sizeof(Problem));
+    if (!solver->replicas) {
+        fprintf(stderr, "Memory allocation error in solver_replicate.\n");
+        return -1;
+    }
+    solver->num_replicas = nodes;
+    thread_pool_run_each(solver->pool, replicate_task, solver);
+    for (int w = 0; w < solver->num_workers; w++) {
+        Problem *replica = &solver->replicas[thread_pool_node(solver->pool, w + 1)];
+        solver->workers[w].local_prob = replica->c ? replica : nullptr;
+    }
+    return 0;
+}
+
+void mkp_solver_destroy(MkpSolver *solver) {
+    if (!solver) return;
+    free_solution(&solver->best);
+    free_solution(&solver->initial);
+    free(solver->usage);
+    workspace_free(&solver->ws);
+    free_workers(solver);
+    thread_pool_destroy(solver->pool);
+    free_problem(&solver->prob);
+    if (solver->shm) {
+        free_solution(&solver->imported);
+        shm_segment_close(solver->shm);
+        free(solver->shm);
+    }
+    free(solver);
+}
+
+void mkp_solver_seed(MkpSolver *solver, const uint64_t seed) {
+    solver->seed = seed;
+    rng_seed(&solver->ws.rng, seed, 0);
+    for (int w = 0; w < solver->num_workers; w++) {
+        rng_seed(&solver->workers[w].rng, seed, (uint64_t)w + 1);
+    }
+}
+
+int mkp_solver_set_initial(MkpSolver *solver, const Solution *init) {
+    const Problem *prob = &solver->prob;
+    if (init->n != prob->n) {
+        fprintf(stderr, "Warm-start solution has %d items, instance has %d.\n", init->n, prob->n);
+        return -1;
+    }
+    copy_solution(init, &solver->initial);
+
+    // Rebuild the usage once and repair, so every method starts from a feasible point
+    float *usage = solver->ws.ls_usage;
+    compute_usage_from_solution(prob, &solver->initial, usage);
+    evaluate_solution_cpu(prob, &solver->initial);
+    if (!solver->initial.feasible) {
+        repair_solution(prob, &solver->initial, usage, &solver->initial.value);
+    }
+    solver->has_initial = true;
+    return 0;
+}
+
+int mkp_solver_load_initial(MkpSolver *solver, const char *filename) {
+    Solution *tmp = &solver->ws.init_candidate;
+    if (read_solution(filename, &solver->prob, tmp) != 0) {
+        return -1;
+    }
+    return mkp_solver_set_initial(solver, tmp);
+}
+
+void mkp_solver_clear_initial(MkpSolver *solver) {
+    solver->has_initial = false;
+}
+
+int mkp_solver_apply_delta(MkpSolver *solver, const ProblemDelta *delta) {
+    Problem *prob = &solver->prob;
+    Solution *best = &solver->best;
+    const int old_n = prob->n;
+    if (solver->shm) {
+        fprintf(stderr, "The instance is shared with other processes and cannot change.\n");
+        return -1;
+    }
+    if (problem_apply_delta(prob, delta, best, solver->usage) != 0) {
+        return -1;
+    }
+
+    // The item count changed: resize the per-item buffers (solves stay allocation-free)
+    if (prob->n != old_n) {
+        free_solution(&solver->initial);
+        allocate_solution(&solver->initial, prob->n);
+        if (workspace_resize(&solver->ws, prob) != 0) {
+            return -1;
+        }
+        for (int w = 0; w < solver->num_workers; w++) {
+            if (workspace_resize(&solver->workers[w], prob) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    // The copies on the other NUMA nodes follow the instance
+    if (solver->pool && solver_replicate(solver) != 0) {
+        return -1;
+    }
+
+    // Repair the incumbent from its cached usage, and warm-start the next solve from it
+    best->feasible = false;
+    repair_solution(prob, best, solver->usage, &best->value);
+    copy_solution(best, &solver->initial);
+    solver->has_initial = true;
+    return 0;
+}
+
+const Problem *mkp_solver_problem(const MkpSolver *solver) {
+    return &solver->prob;
+}
+
+const Solution *mkp_solver_solution(const MkpSolver *solver) {
+    return &solver->best;
+}
+
+/* Internal helper to (re)start the solver's pool and the workspaces of its threads for a thread
+ * count, only when it changes */
+static int solver_set_threads(MkpSolver *solver, const int threads) {
+    if (threads != thread_pool_size(solver->pool)) {
+        thread_pool_destroy(solver->pool);
+        solver->pool = nullptr;
+        free_workers(solver);
+        if (threads > 1) {
+            solver->pool = thread_pool_create(threads);
+            solver->workers = (Workspace*)calloc(threads - 1, sizeof(Workspace));
+            if (!solver->pool || !solver->workers) {
+                fprintf(stderr, "Memory allocation error in solver_set_threads.\n");
+                free(solver->workers);
+                solver->workers = nullptr;
+                workspace_set_pool(&solver->ws, nullptr);
+                return -1;
+            }
+            for (int w = 0; w < threads - 1; w++) {
+                if (workspace_init(&solver->workers[w], &solver->prob, 0) != 0) {
+                    free_workers(solver);
+                    workspace_set_pool(&solver->ws, nullptr);
+                    return -1;
+                }
+                rng_seed(&solver->workers[w].rng, solver->seed, (uint64_t)w + 1);
+                solver->num_workers = w + 1;
+            }
+            if (solver_replicate(solver) != 0) {
+                return -1;
+            }
+        }
+    }
+    return workspace_set_pool(&solver->ws, solver->pool);
+}
+
+/* Internal helper to size the workspaces of the pool threads like the caller's (only allocates
+ * when they grow) */
+static int solver_reserve_workers(MkpSolver *solver, const MkpParams *params) {
+    const BatchBackend backend = params->use_gpu ? BATCH_EVAL_DENSE : BATCH_EVAL_BITPACKED;
+    for (int w = 0; w < solver->num_workers; w++) {
+        Workspace *ws = &solver->workers[w];
+        if (workspace_set_backend(ws, &solver->prob, backend) != 0 ||
+            workspace_reserve_population(ws, params->population_size) != 0 ||
+            workspace_reserve_gd_batch(ws, params->num_starts) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Share of the multi-start time budget left to path relinking
+#define RELINK_TIME_SHARE 0.2f
+
+/* The VNS and GA stages of the multi-start, one task per start */
+typedef struct {
+    const Problem *prob;
+    const MkpParams *params;
+    Workspace *ws;                 // workspace of thread 0, holding the starts
+    Workspace *workers;            // workspaces of threads 1 and up
+    void (*eval_func)(const Problem*, Solution*);
+    clock_t start;
+    float max_time;
+} MultiStartJob;
+
+/* Internal helper: VNS then GA on start s, in place, with the scratch of the running thread; the
+ * result goes to that thread's elite pool */
+static void multi_start_task(void *arg, const int s, const int worker) {
+    const MultiStartJob *job = arg;
+    const MkpParams *params = job->params;
+    Workspace *ws = (worker == 0) ? job->ws : &job->workers[worker - 1];
+    const Problem *prob = workspace_problem(ws, job->prob);
+    Solution *candidate = &job->ws->start_solutions[s];
+
+    // Run VNS if time remains
+    if (!time_is_up(job->start, job->max_time)) {
+        vns(prob,
+            candidate,
+            params->max_no_improv,
+            params->k_max,
+            params->ls_max_checks,
+            LS_BEST_IMPROVEMENT,
+            job->start,
+            job->max_time,
+            params->log_level,
+            ws);
+    }
+
+    // Runs GenAlg if time remains
+    if (!time_is_up(job->start, job->max_time)) {
+        genetic_algorithm(prob,
+                          candidate,
+                          params->population_size,
+                          params->max_generations,
+                          params->mutation_rate,
+                          job->start,
+                          job->max_time,
+                          params->log_level,
+                          nullptr,
+                          ws);
+    }
+
+    // Evaluate or re-check feasibility if needed
+    job->eval_func(prob, candidate);
+    candidate->feasible = check_feasibility(prob, candidate);
+    elite_pool_offer(&ws->elite, candidate);
+}
+
+/* Internal helper: the starts of one thread in a deterministic run (s % threads == worker), in
+ * order, so that the random draws and the elite pool of every thread are the same on every run */
+static void multi_start_static_task(void *arg, const int task, const int worker) {
+    (void)task;
+    const MultiStartJob *job = arg;
+    const int threads = thread_pool_size(job->ws->pool);
+    for (int s = worker; s < job->params->num_starts; s += threads) {
+        multi_start_task(arg, s, worker);
+    }
+}
+
+/* Multi-start approach: GD for all random inits at once, then VNS and GA on each start (in parallel on the
+ * pool threads), keep the best solution.
+ * Every start's result goes to the elite pool, and the remaining time is spent relinking its members. */
+static void multi_start_gd_vns(const Problem *prob, const MkpParams *params, const float max_time,
+                               void (*eval_func)(const Problem*, Solution*),
+                               const Solution *init,
+                               Workspace *ws, Workspace *workers, const int num_workers, Solution *best_sol) {
+    PROFILE_ZONE("multi_start_gd_vns");
+    Solution *candidate = &ws->start_candidate;
+
+    // We can keep track of time. The starts stop early enough to leave time for relinking
+    const clock_t start_time = wall_clock();
+    const float starts_time = max_time * (1.0f - RELINK_TIME_SHARE);
+
+    best_sol->value = -INFINITY;
+    best_sol->feasible = false;
+
+    // Gradient descent from every random init as one batch (the first row uses the warm-start solution, if any)
+    gradient_solver_batched(prob,
+                            params->lambda,
+                            params->learning_rate,
+                            params->max_no_improv,
+                            params->num_starts,
+                            params->log_level,
+                            start_time, starts_time,
+                            init,
+                            ws);
+
+    // Then for each start: VNS => GA, on the pool threads (the results found by the other threads go to
+    // the elite pools of their workspaces, merged below)
+    for (int w = 0; w < num_workers; w++) {
+        elite_pool_clear(&workers[w].elite);
+    }
+    MultiStartJob job = {
+        .prob = prob, .params = params, .ws = ws, .workers = workers, .eval_func = eval_func,
+        .start = start_time, .max_time = starts_time
+    };
+    if (params->deterministic) {
+        thread_pool_run_each(ws->pool, multi_start_static_task, &job);
+    } else {
+        thread_pool_run(ws->pool, multi_start_task, &job, params->num_starts);
+    }
+    for (int w = 0; w < num_workers; w++) {
+        const ElitePool *pool = &workers[w].elite;
+        for (int e = 0; e < pool->count; e++) {
+            elite_pool_get(pool, e, candidate);
+            elite_pool_offer(&ws->elite, candidate);
+        }
+    }
+
+    // Compare the starts in order
+    for (int s = 0; s < params->num_starts; s++) {
+        const Solution *result = &ws->start_solutions[s];
+
+        // Compare with best
+        if ((result->feasible && !best_sol->feasible) ||
+            (result->feasible == best_sol->feasible && result->value > best_sol->value)) {
+            copy_solution(result, best_sol);
+            if (params->log_level >= INFO) {
+                printf("New best solution: %.2f\n", best_sol->value);
+            }
+        }
+    }
+
+    // Relink the local optima of all starts with the remaining time
+    if (best_sol->feasible && !time_is_up(start_time, max_time)) {
+        path_relinking(prob,
+                       best_sol,
+                       params->max_no_improv,
+                       params->ls_max_checks,
+                       LS_BEST_IMPROVEMENT,
+                       start_time,
+                       max_time,
+                       params->log_level,
+                       ws);
+    }
+}
+
+int mkp_solve(MkpSolver *solver, const MkpMethod method, const MkpParams *params, const float max_time) {
+    problem_set_order(&solver->prob, params->order);
+    for (int node = 0; node < solver->num_replicas; node++) {
+        if (solver->replicas[node].c) {
+            problem_set_order(&solver->replicas[node], params->order);
+        }
+    }
+    const Problem *prob = &solver->prob;
+    Workspace *ws = &solver->ws;
+    Solution *sol = &solver->best;
+
+    // Choose evaluation function
+    void (*eval_func)(const Problem*, Solution*) =
+        params->use_gpu ? evaluate_solution_gpu : evaluate_solution_cpu;
+
+    // Only allocates if this call asks for a larger GA population (or GD batch), another backend or
+    // another number of threads
+    if (workspace_set_backend(ws, prob, params->use_gpu ? BATCH_EVAL_DENSE : BATCH_EVAL_BITPACKED) != 0 ||
+        solver_set_threads(solver, params->threads) != 0 ||
+        workspace_reserve_population(ws, params->population_size) != 0 ||
+        workspace_reserve_gd_batch(ws, params->num_starts) != 0 ||
+        solver_reserve_workers(solver, params) != 0) {
+        return -1;
+    }
+
+    // Solutions of previous solves do not seed this one
+    elite_pool_clear(&ws->elite);
+
+    // A reproducible solve does not depend on the random draws of the previous ones
+    if (params->deterministic) {
+        mkp_solver_seed(solver, solver->seed);
+    }
+
+    // Warm-start solution, if any
+    const Solution *init = solver->has_initial ? &solver->initial : nullptr;
+
+    // Cooperating processes: start from the best solution on the shared board when it is better
+    SolutionBoard *shared = solver->shm ? &solver->shm->board : nullptr;
+    if (shared) {
+        const int s = solution_board_best(shared);
+        if (s >= 0 && (!init || solution_board_value(shared, s) > init->value) &&
+            solution_board_read(shared, s, &solver->imported)) {
+            init = &solver->imported;
+        }
+    }
+
+    // Keep track of overall time
+    const clock_t start = wall_clock();
+
+    // Starting point of the single-trajectory methods
+    if (method != MKP_METHOD_MULTI_GD_VNS) {
+        if (init) {
+            copy_solution(init, sol);
+        } else {
+            construct_initial_solution(prob, sol, eval_func, params->num_starts, ws);
+        }
+    }
+
+    switch (method) {
+        case MKP_METHOD_MULTI_GD_VNS:
+            multi_start_gd_vns(prob, params, max_time, eval_func, init, ws, solver->workers, solver->num_workers, sol);
+            break;
+        case MKP_METHOD_LS_FLIP:
+            local_search_flip(prob, sol, params->ls_max_checks, LS_BEST_IMPROVEMENT, ws);
+            break;
+        case MKP_METHOD_LS_SWAP:
+            local_search_swap(prob, sol, params->ls_max_checks, LS_BEST_IMPROVEMENT, ws);
+            break;
+        case MKP_METHOD_GD:
+            gradient_solver(prob,
+                params->lambda,
+                params->learning_rate,
+                params->max_no_improv,
+                sol,
+                params->log_level,
+                start,
+                max_time,
+                init,
+                ws);
+            break;
+        case MKP_METHOD_VNS:
+            parallel_vns(prob,
+                sol,
+                params->max_no_improv,
+                params->k_max,
+                params->ls_max_checks,
+                LS_BEST_IMPROVEMENT,
+                params->deterministic ? VNS_SYNC : params->vns_parallel,
+                start,
+                max_time,
+                params->log_level,
+                ws,
+                solver->workers);
+            break;
+        case MKP_METHOD_VND:
+            vnd(prob, sol, params->max_no_improv, params->ls_max_checks, LS_BEST_IMPROVEMENT, start, max_time, ws);
+            break;
+        case MKP_METHOD_GA:
+            genetic_algorithm(prob,
+                sol,
+                params->population_size,
+                params->max_generations,
+                params->mutation_rate,
+                start,
+                max_time,
+                params->log_level,
+                init,
+                ws);
+            break;
+        case MKP_METHOD_TABU:
+            tabu_search(prob, sol, params->ls_max_checks, params->max_no_improv * TABU_PATIENCE, start, max_time, ws);
+            break;
+        case MKP_METHOD_PORTFOLIO:
+            portfolio(prob, params, sol, start, max_time, ws, solver->workers);
+            break;
+        case MKP_METHOD_COOP:
+            // A board shared with other processes keeps their solutions
+            if (!shared) {
+                solution_board_clear(&ws->board);
+            }
+            coop(prob, params, sol, start, max_time, shared ? shared : &ws->board, ws, solver->workers);
+            break;
+        case MKP_METHOD_PATH_RELINK:
+            path_relinking(prob,
+                sol,
+                params->max_no_improv,
+                params->ls_max_checks,
+                LS_BEST_IMPROVEMENT,
+                start,
+                max_time,
+                params->log_level,
+                ws);
+            break;
+        default:
+            fprintf(stderr, "Unknown method %d.\n", (int)method);
+            return -1;
+    }
+
+    // Cooperating processes: publish the result, and keep the best solution any of them found
+    if (shared) {
+        solution_board_publish(shared, sol);
+        const int s = solution_board_best(shared);
+        if (s >= 0 && solution_board_value(shared, s) > sol->value &&
+            solution_board_read(shared, s, &solver->imported)) {
+            copy_solution(&solver->imported, sol);
+        }
+    }
+
+    // Cache the usage of the result, for incremental updates of the instance
+    compute_usage_from_solution(prob, sol, solver->usage);
+    return 0;
+}
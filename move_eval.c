@@ -0,0 +1,109 @@
+//
+// Batched move feasibility: SIMD comparisons of item blocks against the constraint slacks.
+//
+#include <move_eval.h>
+#include <stats.h>
+#include <profiler.h>
+#include <string.h>
+
+typedef float   move_f32 __attribute__((vector_size(MOVE_EVAL_LANES * sizeof(float))));
+typedef int32_t move_i32 __attribute__((vector_size(MOVE_EVAL_LANES * sizeof(int32_t))));
+
+/* Internal helper: gather the low bit of each lane of ok */
+static inline uint64_t lane_bits(const move_i32 ok) {
+    uint64_t mask = 0;
+    for (int l = 0; l < MOVE_EVAL_LANES; l++) {
+        mask |= (uint64_t)(ok[l] & 1) << l;
+    }
+    return mask;
+}
+
+/* Internal helper: fit mask of the 4 * MOVE_EVAL_LANES items from j0 (four vectors per row, so
+ * each slack broadcast and loop step is shared by four comparisons) */
+static inline uint64_t fit_group(const Problem *prob, const float *slack, const int j0) {
+    const int n = prob->n;
+    const float *col = &prob->weights[j0];
+    move_i32 ok0 = (move_i32){} - 1, ok1 = ok0, ok2 = ok0, ok3 = ok0;
+    for (int i = 0; i < prob->m; i++) {
+        const float *row = &col[(size_t)i * n];
+        const move_f32 s = (move_f32){} + slack[i];
+        move_f32 w0, w1, w2, w3; // unaligned loads
+        memcpy(&w0, &row[0 * MOVE_EVAL_LANES], sizeof(w0));
+        memcpy(&w1, &row[1 * MOVE_EVAL_LANES], sizeof(w1));
+        memcpy(&w2, &row[2 * MOVE_EVAL_LANES], sizeof(w2));
+        memcpy(&w3, &row[3 * MOVE_EVAL_LANES], sizeof(w3));
+        ok0 &= (w0 <= s);
+        ok1 &= (w1 <= s);
+        ok2 &= (w2 <= s);
+        ok3 &= (w3 <= s);
+
+        // Stop as soon as no item fits (checked every 4 constraints)
+        if ((i & 3) == 3) {
+            const move_i32 any = ok0 | ok1 | ok2 | ok3;
+            uint64_t bits[sizeof(any) / sizeof(uint64_t)];
+            memcpy(bits, &any, sizeof(any));
+            uint64_t nonzero = 0;
+            for (size_t l = 0; l < sizeof(any) / sizeof(uint64_t); l++) {
+                nonzero |= bits[l];
+            }
+            if (nonzero == 0) {
+                return 0;
+            }
+        }
+    }
+    return lane_bits(ok0) | lane_bits(ok1) << MOVE_EVAL_LANES
+         | lane_bits(ok2) << (2 * MOVE_EVAL_LANES) | lane_bits(ok3) << (3 * MOVE_EVAL_LANES);
+}
+
+/* Internal helper: fit mask of the full block of items [j0, j0 + 64) */
+static uint64_t fit_block(const Problem *prob, const float *slack, const int j0) {
+    uint64_t mask = 0;
+    for (int g = 0; g < MOVE_EVAL_BLOCK; g += 4 * MOVE_EVAL_LANES) {
+        mask |= fit_group(prob, slack, j0 + g) << g;
+    }
+    return mask;
+}
+
+/* Internal helper: fit mask of the last, partial block of items [j0, n) */
+static uint64_t fit_tail(const Problem *prob, const float *slack, const int j0) {
+    uint64_t mask = 0;
+    for (int j = j0; j < prob->n; j++) {
+        const float *w = &prob->weights_by_item[(size_t)j * prob->m];
+        bool fits = true;
+        for (int i = 0; i < prob->m && fits; i++) {
+            fits = w[i] <= slack[i];
+        }
+        mask |= (uint64_t)fits << (j - j0);
+    }
+    return mask;
+}
+
+int move_fit_mask(const Problem *prob, const float *usage, const float *removed,
+                  const uint64_t *filter, float *slack, uint64_t *mask) {
+    PROFILE_ZONE("move_fit_mask");
+    for (int i = 0; i < prob->m; i++) {
+        slack[i] = prob->capacities[i] - usage[i] + (removed ? removed[i] : 0.0f);
+    }
+
+    const int words = move_mask_words(prob->n);
+    int count = 0;
+    uint64_t evaluated = 0;
+    for (int b = 0; b < words; b++) {
+        const int j0 = b * MOVE_EVAL_BLOCK;
+        const bool full = j0 + MOVE_EVAL_BLOCK <= prob->n;
+        uint64_t want = filter ? filter[b] : ~(uint64_t)0;
+        if (!full) {
+            want &= ((uint64_t)1 << (prob->n - j0)) - 1;
+        }
+        if (want == 0) {
+            mask[b] = 0;
+            continue;
+        }
+        const uint64_t fits = full ? fit_block(prob, slack, j0) : fit_tail(prob, slack, j0);
+        mask[b] = fits & want;
+        count += __builtin_popcountll(mask[b]);
+        evaluated += (uint64_t)__builtin_popcountll(want);
+    }
+    stats_add(STAT_INCREMENTAL_MOVES, evaluated);
+    return count;
+}
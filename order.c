@@ -0,0 +1,185 @@
+//
+// Item orderings: plain ratio, surrogate ratios (capacity-normalised, LP-dual weighted) and profit.
+//
+#include <order.h>
+#include <utils.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Subgradient iterations of the dual price estimate, and iterations without progress before the
+// step is halved
+#define DUAL_ITERATIONS 200
+#define DUAL_PATIENCE 10
+
+static const char *order_names[ORDER_COUNT] = {
+    [ORDER_RATIO]  = "ratio",
+    [ORDER_SCALED] = "scaled",
+    [ORDER_DUAL]   = "dual",
+    [ORDER_PROFIT] = "profit",
+};
+
+/* Internal helper: value of the greedy fill of the items in plain ratio order (lower bound) */
+static float greedy_value(const Problem *prob, float *usage) {
+    memset(usage, 0, prob->m * sizeof(float));
+    float value = 0.0f;
+    for (int idx = 0; idx < prob->n; idx++) {
+        const int j = prob->orders[ORDER_RATIO][idx];
+        const float *w = &prob->weights_by_item[j * prob->m];
+        bool fits = true;
+        for (int i = 0; i < prob->m && fits; i++) {
+            fits = usage[i] + w[i] <= prob->capacities[i];
+        }
+        if (!fits) continue;
+        for (int i = 0; i < prob->m; i++) {
+            usage[i] += w[i];
+        }
+        value += prob->c[j];
+    }
+    return value;
+}
+
+/* Internal helper: estimate the LP dual prices into prob->duals by projected subgradient descent on
+ * L(mu) = sum_i mu_i b_i + sum_j max(0, c_j - mu.w_j), whose minimum over mu >= 0 is the LP bound */
+static void estimate_duals(Problem *prob, float *mu, float *g) {
+    const int n = prob->n;
+    const int m = prob->m;
+
+    // Start from prices that make an average item's reduced profit about zero
+    float sum_c = 0.0f;
+    for (int j = 0; j < n; j++) sum_c += prob->c[j];
+    for (int i = 0; i < m; i++) {
+        float sum_w = 0.0f;
+        for (int j = 0; j < n; j++) sum_w += prob->weights[i * n + j];
+        mu[i] = (sum_w > 0.0f) ? sum_c / (m * sum_w) : 0.0f;
+    }
+    memcpy(prob->duals, mu, m * sizeof(float));
+
+    const float lower = greedy_value(prob, g);
+    float best = FLT_MAX;
+    float alpha = 2.0f;
+    int stall = 0;
+    for (int it = 0; it < DUAL_ITERATIONS; it++) {
+        float bound = 0.0f;
+        for (int i = 0; i < m; i++) {
+            bound += mu[i] * prob->capacities[i];
+            g[i] = prob->capacities[i];
+        }
+        for (int j = 0; j < n; j++) {
+            const float *w = &prob->weights_by_item[j * m];
+            float price = 0.0f;
+            for (int i = 0; i < m; i++) price += mu[i] * w[i];
+            if (prob->c[j] > price) {
+                bound += prob->c[j] - price;
+                for (int i = 0; i < m; i++) g[i] -= w[i];
+            }
+        }
+
+        if (bound < best) {
+            best = bound;
+            memcpy(prob->duals, mu, m * sizeof(float));
+            stall = 0;
+        } else if (++stall >= DUAL_PATIENCE) {
+            alpha *= 0.5f;
+            stall = 0;
+        }
+
+        // Projected step: prices at 0 with a positive subgradient stay at 0
+        float norm = 0.0f;
+        for (int i = 0; i < m; i++) {
+            if (mu[i] > 0.0f || g[i] < 0.0f) norm += g[i] * g[i];
+        }
+        if (norm == 0.0f || bound <= lower) break;
+        const float step = alpha * (bound - lower) / norm;
+        for (int i = 0; i < m; i++) {
+            mu[i] = fmaxf(0.0f, mu[i] - step * g[i]);
+        }
+    }
+}
+
+void problem_update_item_keys(Problem *prob, const int j) {
+    const float *w = &prob->weights_by_item[j * prob->m];
+    float scaled = 0.0f;
+    float priced = 0.0f;
+    for (int i = 0; i < prob->m; i++) {
+        scaled += w[i] / prob->capacities[i];
+        priced += prob->duals[i] * w[i];
+    }
+    prob->ratios[j] = prob->c[j] / prob->sum_of_weights[j];
+    prob->scaled_ratios[j] = prob->c[j] / scaled;
+    prob->dual_ratios[j] = prob->c[j] / fmaxf(priced, FLT_MIN);
+}
+
+float problem_order_key(const Problem *prob, const ItemOrder order, const int j) {
+    switch (order) {
+        case ORDER_SCALED: return prob->scaled_ratios[j];
+        case ORDER_DUAL:   return prob->dual_ratios[j];
+        case ORDER_PROFIT: return prob->c[j];
+        default:           return prob->ratios[j];
+    }
+}
+
+/* Internal helper to sort one ordering by decreasing key, using (key, index) pairs */
+static void sort_order(Problem *prob, const ItemOrder order, float (*pairs)[2]) {
+    for (int j = 0; j < prob->n; j++) {
+        pairs[j][0] = problem_order_key(prob, order, j);
+        pairs[j][1] = (float)j;
+    }
+    qsort(pairs, prob->n, sizeof(*pairs), compare_pairs_descending);
+    for (int idx = 0; idx < prob->n; idx++) {
+        prob->orders[order][idx] = (int)pairs[idx][1];
+    }
+}
+
+int problem_build_orders(Problem *prob) {
+    float (*pairs)[2] = malloc(prob->n * sizeof(*pairs));
+    float *scratch = malloc(2 * prob->m * sizeof(float));
+    if (!pairs || !scratch) {
+        fprintf(stderr, "Memory allocation error, item orderings left unsorted.\n");
+        for (int o = 0; o < ORDER_COUNT; o++) {
+            for (int j = 0; j < prob->n; j++) prob->orders[o][j] = j;
+        }
+        free(pairs);
+        free(scratch);
+        return -1;
+    }
+
+    // The plain ratio order comes first: the dual estimate uses its greedy fill as lower bound
+    for (int j = 0; j < prob->n; j++) {
+        prob->ratios[j] = prob->c[j] / prob->sum_of_weights[j];
+    }
+    sort_order(prob, ORDER_RATIO, pairs);
+    estimate_duals(prob, scratch, &scratch[prob->m]);
+
+    for (int j = 0; j < prob->n; j++) {
+        problem_update_item_keys(prob, j);
+    }
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        if (o != ORDER_RATIO) sort_order(prob, (ItemOrder)o, pairs);
+    }
+    free(pairs);
+    free(scratch);
+    problem_set_order(prob, prob->order);
+    return 0;
+}
+
+void problem_set_order(Problem *prob, const ItemOrder order) {
+    prob->order = order;
+    prob->candidate_list = prob->orders[order];
+}
+
+int order_from_name(const char *name, ItemOrder *order) {
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        if (strcmp(name, order_names[o]) == 0) {
+            *order = (ItemOrder)o;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *order_name(const ItemOrder order) {
+    return (order >= 0 && order < ORDER_COUNT) ? order_names[order] : "unknown";
+}
@@ -0,0 +1,243 @@
+//
+// Algorithm portfolio: time slices of LS, VNS, GA, GD and tabu search, scheduled by a
+// discounted UCB bandit on whether each slice improved the shared incumbent.
+//
+#include <portfolio.h>
+#include <vnd.h>
+#include <vns.h>
+#include <genetic.h>
+#include <gradesc.h>
+#include <tabu.h>
+#include <thread_pool.h>
+#include <stats.h>
+#include <profiler.h>
+#include <math.h>
+#include <stdio.h>
+
+// Most slices of one round (threads beyond this stay idle)
+#define PORTFOLIO_MAX_ROUND 64
+
+// Decay of the bandit statistics per slice: older rewards count for less
+#define BANDIT_DISCOUNT 0.97f
+
+// Weight of the exploration bonus
+#define BANDIT_EXPLORATION 0.2f
+
+static const char *arm_names[PORTFOLIO_ARMS] = {
+    [PORTFOLIO_LS]   = "LS",
+    [PORTFOLIO_VNS]  = "VNS",
+    [PORTFOLIO_GA]   = "GA",
+    [PORTFOLIO_GD]   = "GD",
+    [PORTFOLIO_TABU] = "TABU",
+};
+
+/* Discounted UCB statistics of the components */
+typedef struct {
+    float pulls[PORTFOLIO_ARMS];     // discounted number of slices
+    float rewards[PORTFOLIO_ARMS];   // discounted number of improving slices
+    int slices[PORTFOLIO_ARMS];      // slices run
+    int wins[PORTFOLIO_ARMS];        // improving slices
+} Bandit;
+
+/* The slices of one round, run in parallel on the pool */
+typedef struct {
+    const Problem *prob;
+    const MkpParams *params;
+    const Solution *incumbent;             // read-only during the round
+    Workspace *ws;                         // workspace of worker 0
+    Workspace *workers;                    // workspaces of workers 1 and up
+    float slice;                           // length of the slices, in seconds
+    uint64_t units;                        // iterations of each method per slice (deterministic runs)
+    int tasks;                             // slices of the round
+    PortfolioArm arms[PORTFOLIO_MAX_ROUND];
+    bool improved[PORTFOLIO_MAX_ROUND];
+} PortfolioRound;
+
+const char *portfolio_arm_name(const PortfolioArm arm) {
+    return (arm >= 0 && arm < PORTFOLIO_ARMS) ? arm_names[arm] : "UNKNOWN";
+}
+
+/* Internal helper to pick a component: untried ones first, then the best upper confidence bound.
+ * extra holds the picks already made in this round, counted as pulls without reward */
+static PortfolioArm bandit_choose(const Bandit *bandit, const float *extra) {
+    float total = 0.0f;
+    for (int a = 0; a < PORTFOLIO_ARMS; a++) {
+        if (bandit->slices[a] == 0 && extra[a] == 0.0f) {
+            return (PortfolioArm)a;
+        }
+        total += bandit->pulls[a] + extra[a];
+    }
+    int best = 0;
+    float best_score = -INFINITY;
+    for (int a = 0; a < PORTFOLIO_ARMS; a++) {
+        const float pulls = bandit->pulls[a] + extra[a];
+        const float score = bandit->rewards[a] / pulls + BANDIT_EXPLORATION * sqrtf(logf(total + 1.0f) / pulls);
+        if (score > best_score) {
+            best_score = score;
+            best = a;
+        }
+    }
+    return (PortfolioArm)best;
+}
+
+/* Internal helper to record the reward of one slice */
+static void bandit_update(Bandit *bandit, const PortfolioArm arm, const bool improved) {
+    for (int a = 0; a < PORTFOLIO_ARMS; a++) {
+        bandit->pulls[a] *= BANDIT_DISCOUNT;
+        bandit->rewards[a] *= BANDIT_DISCOUNT;
+    }
+    bandit->pulls[arm] += 1.0f;
+    bandit->rewards[arm] += improved ? 1.0f : 0.0f;
+    bandit->slices[arm]++;
+    bandit->wins[arm] += improved ? 1 : 0;
+}
+
+/* Internal helper to run one slice of a component from the incumbent into out, for at most slice
+ * seconds and units iterations of each method */
+static void run_slice(const Problem *prob, const MkpParams *params, const PortfolioArm arm,
+                      const Solution *incumbent, Solution *out, const float slice, const uint64_t units,
+                      Workspace *ws) {
+    const clock_t start = wall_clock();
+    switch (arm) {
+        case PORTFOLIO_LS: {
+            copy_solution(incumbent, out);
+            VndState st;
+            vnd_init(&st, prob, out, params->max_no_improv, params->ls_max_checks, LS_BEST_IMPROVEMENT, ws);
+            vnd_step_units(&st, units, slice);
+            vnd_finalize(&st);
+            break;
+        }
+        case PORTFOLIO_VNS: {
+            copy_solution(incumbent, out);
+            VnsState st;
+            vns_init(&st, prob, out, params->max_no_improv, params->k_max, params->ls_max_checks,
+                     LS_BEST_IMPROVEMENT, NONE, ws);
+            vns_step_units(&st, units, slice);
+            vns_finalize(&st);
+            break;
+        }
+        case PORTFOLIO_GA: {
+            GaState st;
+            ga_init(&st, prob, out, params->population_size, params->max_generations, params->mutation_rate,
+                    NONE, incumbent, ws);
+            ga_step_units(&st, units, slice);
+            ga_finalize(&st);
+            break;
+        }
+        case PORTFOLIO_GD: {
+            // From the saturated incumbent the gradient vanishes: start anywhere, then descend
+            GdState gd;
+            gd_init(&gd, prob, params->lambda, params->learning_rate, params->max_no_improv, out, NONE, nullptr, ws);
+            gd_step_units(&gd, units, slice);
+            gd_finalize(&gd);
+            VndState st;
+            vnd_init(&st, prob, out, params->max_no_improv, params->ls_max_checks, LS_BEST_IMPROVEMENT, ws);
+            vnd_step_units(&st, units, time_remaining(start, slice));
+            vnd_finalize(&st);
+            break;
+        }
+        case PORTFOLIO_TABU:
+            // Not steppable: runs until its own stopping rule within the slice
+            copy_solution(incumbent, out);
+            tabu_search(prob, out, params->ls_max_checks, params->max_no_improv * TABU_PATIENCE, start, slice, ws);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Internal helper: one slice of the round, keeping the best result of each worker in its workspace */
+static void portfolio_task(void *arg, const int task, const int worker) {
+    PortfolioRound *round = arg;
+    Workspace *ws = (worker == 0) ? round->ws : &round->workers[worker - 1];
+    Solution *candidate = &ws->slice_candidate;
+    run_slice(workspace_problem(ws, round->prob), round->params, round->arms[task], round->incumbent, candidate,
+              round->slice, round->units, ws);
+    stats_inc(STAT_PORTFOLIO_SLICES);
+
+    round->improved[task] = candidate->feasible && candidate->value > round->incumbent->value;
+    if (round->improved[task] && (!ws->slice_best.feasible || candidate->value > ws->slice_best.value)) {
+        swap_solutions(candidate, &ws->slice_best);
+    }
+}
+
+/* Internal helper: slice t of a deterministic round runs on thread t, with its workspace and random generator */
+static void portfolio_each_task(void *arg, const int task, const int worker) {
+    (void)task;
+    const PortfolioRound *round = arg;
+    if (worker < round->tasks) {
+        portfolio_task(arg, worker, worker);
+    }
+}
+
+void portfolio(const Problem *prob,
+               const MkpParams *params,
+               Solution *best_sol,
+               const clock_t start,
+               const float max_time,
+               Workspace *ws,
+               Workspace *workers) {
+    PROFILE_ZONE("portfolio");
+    ThreadPool *pool = ws->pool;
+    const int threads = thread_pool_size(pool);
+    const int tasks = (threads < PORTFOLIO_MAX_ROUND) ? threads : PORTFOLIO_MAX_ROUND;
+    const float slice = fmaxf(max_time / PORTFOLIO_SLICES, PORTFOLIO_MIN_SLICE);
+
+    // Each slice runs sequentially on its thread: the pool is busy running the round
+    ws->pool = nullptr;
+
+    Bandit bandit = {0};
+    PortfolioRound round = {
+        .prob = prob, .params = params, .incumbent = best_sol, .ws = ws, .workers = workers,
+        .units = params->deterministic ? PORTFOLIO_SLICE_UNITS : UINT64_MAX, .tasks = tasks
+    };
+    int rounds = 0;
+    while (!time_is_up(start, max_time) && (!params->deterministic || rounds < PORTFOLIO_SLICES)) {
+        // Deterministic slices end by iterations, the time limit only caps them
+        round.slice = params->deterministic ? time_remaining(start, max_time)
+                                            : fminf(slice, time_remaining(start, max_time));
+
+        // One pick per slice, each counted as a pull without reward for the next picks
+        float extra[PORTFOLIO_ARMS] = {0};
+        for (int t = 0; t < tasks; t++) {
+            round.arms[t] = bandit_choose(&bandit, extra);
+            extra[round.arms[t]] += 1.0f;
+        }
+        for (int t = 0; t < threads; t++) {
+            Workspace *w = (t == 0) ? ws : &workers[t - 1];
+            w->slice_best.feasible = false;
+        }
+        if (params->deterministic) {
+            thread_pool_run_each(pool, portfolio_each_task, &round);
+        } else {
+            thread_pool_run(pool, portfolio_task, &round, tasks);
+        }
+
+        // Rewards in slice order, then the best result of the round becomes the incumbent
+        const Solution *round_best = nullptr;
+        for (int t = 0; t < tasks; t++) {
+            bandit_update(&bandit, round.arms[t], round.improved[t]);
+        }
+        for (int t = 0; t < threads; t++) {
+            const Workspace *w = (t == 0) ? ws : &workers[t - 1];
+            if (w->slice_best.feasible && (!round_best || w->slice_best.value > round_best->value)) {
+                round_best = &w->slice_best;
+            }
+        }
+        if (round_best) {
+            copy_solution(round_best, best_sol);
+        }
+        rounds++;
+
+        if (params->log_level == DEBUG) {
+            printf("[PORTFOLIO] Round %d: best value = %.2f\n", rounds, best_sol->value);
+        }
+    }
+    ws->pool = pool;
+
+    if (params->log_level >= INFO) {
+        for (int a = 0; a < PORTFOLIO_ARMS; a++) {
+            printf("[PORTFOLIO] %-4s %4d slices, %4d improving\n", arm_names[a], bandit.slices[a], bandit.wins[a]);
+        }
+    }
+}
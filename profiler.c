@@ -0,0 +1,252 @@
+//
+// Scoped-zone profiler (compiled in with MKP_PROFILE).
+// Every thread keeps its own call tree and trace buffer; threads register themselves in a
+// lock-free list so profile_write() can walk them all at the end of the run.
+//
+#include <profiler.h>
+#include <stdio.h>
+
+#ifdef MKP_PROFILE
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PROFILE_MAX_NODES  4096
+#define PROFILE_MAX_DEPTH  64
+#define PROFILE_MAX_EVENTS (1 << 18)
+
+/**
+ * @brief A node of the per-thread call tree: one per distinct call path.
+ */
+typedef struct {
+    const char *name;
+    int parent;
+    int first_child;
+    int next_sibling;
+    uint64_t cycles;   /**< Inclusive cycles */
+    uint64_t children; /**< Cycles spent in child zones */
+    uint64_t calls;
+} ProfileNode;
+
+/**
+ * @brief A complete zone (begin + duration) for the trace output.
+ */
+typedef struct {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+} ProfileEvent;
+
+typedef struct ProfileThread {
+    int tid;
+    int num_nodes;
+    int depth;
+    int stack[PROFILE_MAX_DEPTH];
+    ProfileNode nodes[PROFILE_MAX_NODES];
+    ProfileEvent *events;
+    int num_events;
+    uint64_t dropped_events;
+    struct ProfileThread *next;
+} ProfileThread;
+
+static thread_local ProfileThread *tls_profile = nullptr;
+static _Atomic(ProfileThread *) profile_threads = nullptr;
+static atomic_int profile_next_tid = 0;
+
+// Calibration reference: first ticks / nanoseconds seen by any thread
+static atomic_uint_fast64_t calib_ticks = 0;
+static atomic_uint_fast64_t calib_ns = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Internal helper to create (and register) the calling thread's profile */
+static ProfileThread *profile_thread_init(void) {
+    ProfileThread *t = calloc(1, sizeof(ProfileThread));
+    if (!t) return nullptr;
+    t->events = malloc(PROFILE_MAX_EVENTS * sizeof(ProfileEvent));
+    if (!t->events) {
+        free(t);
+        return nullptr;
+    }
+    t->tid = atomic_fetch_add(&profile_next_tid, 1);
+
+    // Node 0 is the (unnamed) root of the call tree
+    t->nodes[0].name = nullptr;
+    t->nodes[0].parent = -1;
+    t->nodes[0].first_child = -1;
+    t->nodes[0].next_sibling = -1;
+    t->num_nodes = 1;
+    t->stack[0] = 0;
+    t->depth = 1;
+
+    uint_fast64_t expected = 0;
+    if (atomic_compare_exchange_strong(&calib_ticks, &expected, profile_ticks())) {
+        atomic_store(&calib_ns, now_ns());
+    }
+
+    // Lock-free push onto the global list
+    ProfileThread *head = atomic_load(&profile_threads);
+    do {
+        t->next = head;
+    } while (!atomic_compare_exchange_weak(&profile_threads, &head, t));
+
+    tls_profile = t;
+    return t;
+}
+
+/* Internal helper to find or create the child of parent named name */
+static int profile_child(ProfileThread *t, const int parent, const char *name) {
+    for (int c = t->nodes[parent].first_child; c != -1; c = t->nodes[c].next_sibling) {
+        if (t->nodes[c].name == name || strcmp(t->nodes[c].name, name) == 0) {
+            return c;
+        }
+    }
+    if (t->num_nodes >= PROFILE_MAX_NODES) return -1;
+
+    const int c = t->num_nodes++;
+    t->nodes[c].name = name;
+    t->nodes[c].parent = parent;
+    t->nodes[c].first_child = -1;
+    t->nodes[c].next_sibling = t->nodes[parent].first_child;
+    t->nodes[parent].first_child = c;
+    return c;
+}
+
+ProfileZone profile_zone_begin(const char *name) {
+    ProfileThread *t = tls_profile ? tls_profile : profile_thread_init();
+    ProfileZone zone = { .start = 0, .node = -1, .event = -1 };
+    if (!t || t->depth >= PROFILE_MAX_DEPTH) return zone;
+
+    const int node = profile_child(t, t->stack[t->depth - 1], name);
+    if (node < 0) return zone;
+
+    t->stack[t->depth++] = node;
+    zone.node = node;
+
+    // Reserve the trace slot on entry so that long outer zones survive a full buffer
+    if (t->num_events < PROFILE_MAX_EVENTS) {
+        zone.event = t->num_events++;
+        t->events[zone.event].name = name;
+        t->events[zone.event].end = 0;
+    } else {
+        t->dropped_events++;
+    }
+
+    zone.start = profile_ticks();
+    if (zone.event >= 0) t->events[zone.event].start = zone.start;
+    return zone;
+}
+
+void profile_zone_end(const ProfileZone *zone) {
+    const uint64_t end = profile_ticks();
+    ProfileThread *t = tls_profile;
+    if (!t || zone->node < 0) return;
+
+    const uint64_t elapsed = end - zone->start;
+    ProfileNode *node = &t->nodes[zone->node];
+    node->cycles += elapsed;
+    node->calls++;
+    if (node->parent > 0) {
+        t->nodes[node->parent].children += elapsed;
+    }
+    t->depth--;
+
+    if (zone->event >= 0) {
+        t->events[zone->event].end = end;
+    }
+}
+
+bool profile_enabled(void) {
+    return true;
+}
+
+/* Internal helper to print the path from the root to node, separated by ';' */
+static void fprint_path(FILE *fout, const ProfileThread *t, const int node) {
+    if (node <= 0) return;
+    if (t->nodes[node].parent > 0) {
+        fprint_path(fout, t, t->nodes[node].parent);
+        fputc(';', fout);
+    }
+    fputs(t->nodes[node].name, fout);
+}
+
+int profile_write(const char *prefix) {
+    const size_t len = strlen(prefix) + 16;
+    char *path = malloc(len);
+    if (!path) return -1;
+
+    // Ticks -> microseconds
+    const uint64_t t0 = atomic_load(&calib_ticks);
+    const uint64_t ns0 = atomic_load(&calib_ns);
+    const uint64_t dt = profile_ticks() - t0;
+    const uint64_t dns = now_ns() - ns0;
+    const double us_per_tick = (dt > 0) ? (double)dns / (double)dt * 1e-3 : 0.0;
+
+    // Collapsed stacks
+    snprintf(path, len, "%s.folded", prefix);
+    FILE *fout = fopen(path, "w");
+    if (!fout) {
+        fprintf(stderr, "Error opening profile file %s.\n", path);
+        free(path);
+        return -1;
+    }
+    for (const ProfileThread *t = atomic_load(&profile_threads); t; t = t->next) {
+        for (int n = 1; n < t->num_nodes; n++) {
+            const ProfileNode *node = &t->nodes[n];
+            const uint64_t self = node->cycles > node->children ? node->cycles - node->children : 0;
+            if (self == 0) continue;
+            fprint_path(fout, t, n);
+            fprintf(fout, " %llu\n", (unsigned long long)self);
+        }
+    }
+    fclose(fout);
+
+    // Chrome trace events
+    snprintf(path, len, "%s.trace.json", prefix);
+    fout = fopen(path, "w");
+    if (!fout) {
+        fprintf(stderr, "Error opening profile file %s.\n", path);
+        free(path);
+        return -1;
+    }
+    fprintf(fout, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    for (const ProfileThread *t = atomic_load(&profile_threads); t; t = t->next) {
+        for (int e = 0; e < t->num_events; e++) {
+            const ProfileEvent *ev = &t->events[e];
+            if (ev->end == 0) continue; // zone still open
+            fprintf(fout, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                    first ? "" : ",\n", ev->name, t->tid,
+                    (double)(ev->start - t0) * us_per_tick, (double)(ev->end - ev->start) * us_per_tick);
+            first = false;
+        }
+        if (t->dropped_events > 0) {
+            fprintf(stderr, "Profiler: thread %d dropped %llu trace events (buffer full).\n",
+                    t->tid, (unsigned long long)t->dropped_events);
+        }
+    }
+    fprintf(fout, "\n]}\n");
+    fclose(fout);
+
+    free(path);
+    return 0;
+}
+
+#else
+
+bool profile_enabled(void) {
+    return false;
+}
+
+int profile_write(const char *prefix) {
+    fprintf(stderr, "Profiling is not compiled in (configure with -DMKP_PROFILE=ON); %s not written.\n", prefix);
+    return -1;
+}
+
+#endif
@@ -0,0 +1,207 @@
+//
+// Path relinking between the members of the elite pool.
+//
+#include <relink.h>
+#include <elite.h>
+#include <vnd.h>
+#include <vns.h>
+#include <stats.h>
+#include <profiler.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Internal helper to flip item j of a path point, keeping value and usage exact */
+static inline void relink_flip(const Problem *prob, Solution *sol, float *usage, const int j) {
+    const bool add = sol->x[j] < 0.5f;
+    const float sign = add ? 1.0f : -1.0f;
+    const float *w = &prob->weights_by_item[j * prob->m];
+    sol->x[j] = add ? 1.0f : 0.0f;
+    sol->value += sign * prob->c[j];
+    for (int k = 0; k < prob->m; k++) {
+        usage[k] += sign * w[k];
+    }
+}
+
+/* Internal helper to check whether item j fits in the slack of usage */
+static inline bool relink_fits(const Problem *prob, const float *usage, const int j) {
+    const float *w = &prob->weights_by_item[j * prob->m];
+    for (int k = 0; k < prob->m; k++) {
+        if (usage[k] + w[k] > prob->capacities[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool path_relink(const Problem *prob, const int from, const int to, Workspace *ws) {
+    PROFILE_ZONE("path_relink");
+    const ElitePool *pool = &ws->elite;
+    Solution *current = &ws->pr_current;
+    float *usage = ws->pr_usage;
+    int *path = ws->pr_path;
+
+    // Items where the two members differ
+    int length = 0;
+    for (int j = 0; j < prob->n; j++) {
+        if (elite_pool_selected(pool, from, j) != elite_pool_selected(pool, to, j)) {
+            path[length++] = j;
+        }
+    }
+    if (length < 2) {
+        return false;
+    }
+    stats_inc(STAT_RELINK_PATHS);
+    elite_pool_get(pool, from, current);
+    compute_usage_from_solution(prob, current, usage);
+
+    // Walk: path[0, step) holds the flips applied so far, in order
+    float best_value = -INFINITY;
+    int best_step = 0;
+    int applied = 0;
+    uint64_t moves = 0;
+    for (int step = 0; step < length - 1; step++) {
+        // Most profitable add that fits, otherwise the lowest-ratio drop
+        int pick = -1;
+        bool pick_add = false;
+        for (int p = step; p < length; p++) {
+            const int j = path[p];
+            if (current->x[j] < 0.5f) {
+                moves++;
+                if ((!pick_add || prob->c[j] > prob->c[path[pick]]) && relink_fits(prob, usage, j)) {
+                    pick = p;
+                    pick_add = true;
+                }
+            } else if (!pick_add && (pick == -1 || prob->ratios[j] < prob->ratios[path[pick]])) {
+                pick = p;
+            }
+        }
+        if (pick == -1) {
+            break;
+        }
+
+        const int j = path[pick];
+        path[pick] = path[step];
+        path[step] = j;
+        relink_flip(prob, current, usage, j);
+        applied = step + 1;
+        if (current->value > best_value) {
+            best_value = current->value;
+            best_step = step + 1;
+        }
+    }
+    stats_add(STAT_INCREMENTAL_MOVES, moves);
+
+    // Undo the flips made after the best point (every point of the path is feasible); the walk
+    // may have stopped before the end of the path
+    for (int step = applied - 1; step >= best_step; step--) {
+        relink_flip(prob, current, usage, path[step]);
+    }
+    current->feasible = true;
+    return true;
+}
+
+/* Internal helper to offer a VND optimum of a shaken copy of best_sol to the pool */
+static bool offer_shaken(const Problem *prob, const Solution *best_sol, const float *best_usage,
+                         SearchContext *ctx, Workspace *ws) {
+    // Large enough to leave the basin of best_sol: 10% of the items
+    const int k = (prob->n / 10 > 2) ? prob->n / 10 : 2;
+    shake(prob, best_sol, best_usage, ctx->sol, ctx->usage, k, ws);
+    search_context_invalidate(ctx);
+    vnd_ctx(ctx, 5);
+    return elite_pool_offer(&ws->elite, ctx->sol);
+}
+
+/* Internal helper to keep a better solution (and its usage) as the best one */
+static void keep_if_better(const Problem *prob, const Solution *sol, const float *usage,
+                           Solution *best_sol, float *best_usage, const LogLevel verbose) {
+    if (sol->value > best_sol->value) {
+        copy_solution(sol, best_sol);
+        memcpy(best_usage, usage, prob->m * sizeof(float));
+        stats_inc(STAT_INCUMBENT_IMPROVEMENTS);
+        if (verbose == DEBUG) {
+            printf("[PR] New best value: %.2f\n", best_sol->value);
+        }
+    }
+}
+
+void path_relinking(const Problem *prob,
+                    Solution *best_sol,
+                    const int max_no_improvement,
+                    const int ls_k,
+                    const LSMode ls_mode,
+                    const clock_t start,
+                    const float max_time,
+                    const LogLevel verbose,
+                    Workspace *ws) {
+    PROFILE_ZONE("path_relinking");
+    ElitePool *pool = &ws->elite;
+
+    // best_sol as a local optimum, then shaken optima of it until the pool is full
+    float *best_usage = ws->vns_usage;
+    compute_usage_from_solution(prob, best_sol, best_usage);
+    SearchContext ctx = {
+        .prob = prob, .ws = ws, .sol = best_sol, .usage = best_usage,
+        .ls_k = ls_k, .ls_mode = ls_mode, .start = start, .max_time = max_time
+    };
+    vnd_ctx(&ctx, 5);
+    best_usage = ctx.usage;
+    elite_pool_offer(pool, best_sol);
+
+    ctx.sol = &ws->vns_candidate;
+    ctx.usage = ws->shake_usage;
+    for (int attempt = 0; attempt < 3 * pool->capacity && pool->count < pool->capacity; attempt++) {
+        if (time_is_up(start, max_time)) {
+            break;
+        }
+        offer_shaken(prob, best_sol, best_usage, &ctx, ws);
+        keep_if_better(prob, ctx.sol, ctx.usage, best_sol, best_usage, verbose);
+    }
+
+    // Relinking rounds: only pairs with a member added since the previous round give new paths
+    uint64_t fresh_from = 0;
+    int no_improvement = 0;
+    SearchContext path_ctx = ctx;
+    path_ctx.sol = &ws->pr_current;
+    while (no_improvement < max_no_improvement && !time_is_up(start, max_time)) {
+        const uint64_t round_start = pool->next_id;
+        bool added = false;
+        for (int a = 0; a < pool->count && !time_is_up(start, max_time); a++) {
+            for (int b = 0; b < pool->count; b++) {
+                if (a == b || (pool->ids[a] < fresh_from && pool->ids[b] < fresh_from)) {
+                    continue;
+                }
+                if (!path_relink(prob, a, b, ws)) {
+                    continue;
+                }
+
+                // Improve the best point of the path and offer it back
+                path_ctx.usage = ws->pr_usage;
+                search_context_invalidate(&path_ctx);
+                vnd_ctx(&path_ctx, 5);
+                ws->pr_usage = path_ctx.usage;
+                keep_if_better(prob, &ws->pr_current, ws->pr_usage, best_sol, best_usage, verbose);
+                added |= elite_pool_offer(pool, &ws->pr_current);
+            }
+        }
+        fresh_from = round_start;
+
+        // Nothing new: diversify with one more shaken optimum of the best solution
+        if (added) {
+            no_improvement = 0;
+        } else {
+            no_improvement++;
+            if (!time_is_up(start, max_time)) {
+                offer_shaken(prob, best_sol, best_usage, &ctx, ws);
+                keep_if_better(prob, ctx.sol, ctx.usage, best_sol, best_usage, verbose);
+            }
+        }
+        if (verbose == DEBUG) {
+            printf("[PR] Round done: %d members, best value = %.2f\n", pool->count, best_sol->value);
+        }
+    }
+
+    // Hand the (possibly swapped) usage buffers back to the workspace
+    ws->vns_usage = best_usage;
+    ws->shake_usage = ctx.usage;
+}
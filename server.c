@@ -0,0 +1,552 @@
+//
+// Resident solver daemon (mkp_server).
+// Reads JSON-lines requests on stdin or a Unix domain socket and answers one JSON line per request.
+// Parsed instances are kept with their solver (workspace, RNG) across requests, so a warm request
+// pays neither process start, parsing nor allocation.
+//
+// Request (one line):
+//   {"id": 1, "instance": "Instances_MKP/100M5_1.txt", "method": "VNS", "max_time": 1.0}
+//   {"id": 2, "key": "my-inst", "data": {"n": 3, "m": 1, "c": [..], "capacities": [..], "weights": [..]},
+//    "method": "GA", "max_time": 0.5, "population_size": 200}
+//   {"cmd": "ping"} | {"cmd": "evict", "instance": "..."} | {"cmd": "evict", "key": "..."} | {"cmd": "shutdown"}
+//   {"id": 3, "cmd": "delta", "key": "my-inst", "capacities": [[1, 480]], "profits": [[7, 35]],
+//    "remove": [12], "add": [{"c": 40, "weights": [..m..]}], "method": "VNS", "max_time": 0.2}
+//
+// A request with "key" and "data" (re)loads the instance under that key: if the key is already
+// cached, its instance and solver are evicted and replaced by the new data ("cached": false).
+//
+// A "delta" request changes the cached instance in place (1-based item and constraint indices,
+// removals and additions renumber the items like problem_apply_delta), repairs the previous
+// solution and re-optimizes it with the given method. A cached inline instance can be referred to
+// by its "key" alone.
+//
+// Optional request fields: seed, num_starts, lambda, lr, ls_max_checks, order (ratio, scaled,
+// dual or profit), threads, vns_parallel (sync or async), deterministic (true: reproducible parallel
+// runs), max_no_improv, k_max, population_size, max_generations, mutation_rate, init (solution file
+// to start from) and
+// warm_start (true: start from the previous solution of a cached instance).
+//
+// Response:
+//   {"id": 1, "ok": true, "method": "VNS", "value": 24381, "feasible": true, "num_selected": 58,
+//    "items": [1, 4, ...], "time": 1.0, "cached": true, "stats": {"counters": {...}, "phases": {...}}}
+//   {"id": 1, "ok": false, "error": "..."}
+//
+#include <mkp.h>
+#include <json.h>
+#include <stats.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_DEFAULT_MAX_CACHED 16
+#define SERVER_MAX_CACHED 256
+
+/**
+ * @brief A cached instance with its warm solver.
+ */
+typedef struct {
+    char *key;          /**< Instance path, or "data:<key>" for inline instances */
+    MkpSolver *solver;  /**< Solver owning the parsed problem and workspace */
+    uint64_t last_used; /**< For LRU eviction */
+} CacheEntry;
+
+typedef struct {
+    CacheEntry entries[SERVER_MAX_CACHED];
+    int count;
+    int max_cached;
+    uint64_t tick;
+    MkpParams base;     /**< Default parameters of every request */
+    bool shutdown;
+} Server;
+
+static CacheEntry *cache_find(Server *srv, const char *key) {
+    for (int i = 0; i < srv->count; i++) {
+        if (strcmp(srv->entries[i].key, key) == 0) {
+            srv->entries[i].last_used = ++srv->tick;
+            return &srv->entries[i];
+        }
+    }
+    return nullptr;
+}
+
+static void cache_remove(Server *srv, const int i) {
+    mkp_solver_destroy(srv->entries[i].solver);
+    free(srv->entries[i].key);
+    srv->entries[i] = srv->entries[--srv->count];
+}
+
+static CacheEntry *cache_insert(Server *srv, const char *key, MkpSolver *solver) {
+    if (srv->count >= srv->max_cached) {
+        // Evict the least recently used instance
+        int lru = 0;
+        for (int i = 1; i < srv->count; i++) {
+            if (srv->entries[i].last_used < srv->entries[lru].last_used) lru = i;
+        }
+        cache_remove(srv, lru);
+    }
+    CacheEntry *e = &srv->entries[srv->count];
+    e->key = strdup(key);
+    if (!e->key) return nullptr;
+    e->solver = solver;
+    e->last_used = ++srv->tick;
+    srv->count++;
+    return e;
+}
+
+/* Internal helper to build a problem from an inline "data" object */
+static int problem_from_json(const JsonValue *data, Problem *prob, const char **error) {
+    const int n = (int)json_get_number(data, "n", 0);
+    const int m = (int)json_get_number(data, "m", 0);
+    if (n <= 0 || m <= 0) {
+        *error = "data.n and data.m must be positive";
+        return -1;
+    }
+    float *c = malloc(n * sizeof(float));
+    float *cap = malloc(m * sizeof(float));
+    float *w = malloc((size_t)m * n * sizeof(float));
+    int rc = -1;
+    if (!c || !cap || !w) {
+        *error = "out of memory";
+    } else if (json_to_floats(json_get(data, "c"), c, n) < 0) {
+        *error = "data.c must be an array of n numbers";
+    } else if (json_to_floats(json_get(data, "capacities"), cap, m) < 0) {
+        *error = "data.capacities must be an array of m numbers";
+    } else if (json_to_floats(json_get(data, "weights"), w, m * n) < 0) {
+        *error = "data.weights must be an array of m*n numbers (row-major)";
+    } else if (problem_from_arrays(prob, n, m, c, cap, w) != 0) {
+        *error = "invalid problem data";
+    } else {
+        rc = 0;
+    }
+    free(c);
+    free(cap);
+    free(w);
+    return rc;
+}
+
+/* Internal helper to override the base parameters with the fields present in the request */
+static void params_from_request(const JsonValue *req, const MkpParams *base, MkpParams *params) {
+    *params = *base;
+    params->num_starts      = (int)json_get_number(req, "num_starts", params->num_starts);
+    params->lambda          = (float)json_get_number(req, "lambda", params->lambda);
+    params->learning_rate   = (float)json_get_number(req, "lr", params->learning_rate);
+    params->ls_max_checks   = (int)json_get_number(req, "ls_max_checks", params->ls_max_checks);
+    params->max_no_improv   = (int)json_get_number(req, "max_no_improv", params->max_no_improv);
+    params->k_max           = (int)json_get_number(req, "k_max", params->k_max);
+    params->threads         = (int)json_get_number(req, "threads", params->threads);
+    if (params->threads < 1) params->threads = 1;
+    const char *vns_parallel = json_get_string(req, "vns_parallel", nullptr);
+    if (vns_parallel) {
+        params->vns_parallel = (strcmp(vns_parallel, "async") == 0) ? VNS_ASYNC : VNS_SYNC;
+    }
+    params->deterministic   = json_get_number(req, "deterministic", params->deterministic) != 0.0;
+    params->population_size = (int)json_get_number(req, "population_size", params->population_size);
+    params->max_generations = (int)json_get_number(req, "max_generations", params->max_generations);
+    params->mutation_rate   = (float)json_get_number(req, "mutation_rate", params->mutation_rate);
+}
+
+static void write_id(FILE *out, const JsonValue *req) {
+    const JsonValue *id = json_get(req, "id");
+    fprintf(out, "{\"id\": ");
+    if (id && id->type == JSON_NUMBER) {
+        fprintf(out, "%.17g", id->number);
+    } else if (id && id->type == JSON_STRING) {
+        json_write_string(out, id->string);
+    } else {
+        fprintf(out, "null");
+    }
+}
+
+static void write_error(FILE *out, const JsonValue *req, const char *error) {
+    write_id(out, req);
+    fprintf(out, ", \"ok\": false, \"error\": ");
+    json_write_string(out, error);
+    fprintf(out, "}\n");
+}
+
+/* Internal helper to find (or load and cache) the solver of a request */
+static MkpSolver *request_solver(Server *srv, const JsonValue *req, bool *cached, bool *owned, const char **error) {
+    const char *path = json_get_string(req, "instance", nullptr);
+    const JsonValue *data = json_get(req, "data");
+    const char *key = json_get_string(req, "key", nullptr);
+    *owned = false;
+
+    char *cache_key = nullptr;
+    if (path) {
+        cache_key = strdup(path);
+    } else if (key) {
+        cache_key = malloc(strlen(key) + 6);
+        if (cache_key) sprintf(cache_key, "data:%s", key);
+    } else if (!data) {
+        *error = "request needs \"instance\" or \"data\"";
+        return nullptr;
+    }
+
+    if (cache_key) {
+        const CacheEntry *e = cache_find(srv, cache_key);
+        if (e && !path && data) {
+            // New data under a cached key replaces the instance (and its warm solver)
+            cache_remove(srv, (int)(e - srv->entries));
+        } else if (e) {
+            *cached = true;
+            free(cache_key);
+            return e->solver;
+        }
+    }
+    *cached = false;
+    if (!path && !data) {
+        free(cache_key);
+        *error = "unknown instance key";
+        return nullptr;
+    }
+
+    MkpSolver *solver = nullptr;
+    if (path) {
+        solver = mkp_solver_create(path, &srv->base, 42);
+        if (!solver) *error = "cannot load instance";
+    } else {
+        Problem prob;
+        if (problem_from_json(data, &prob, error) == 0) {
+            solver = mkp_solver_create_from_problem(&prob, &srv->base, 42);
+            if (!solver) {
+                free_problem(&prob);
+                *error = "cannot create solver";
+            }
+        }
+    }
+
+    if (solver && cache_key) {
+        if (!cache_insert(srv, cache_key, solver)) *owned = true;
+    } else if (solver) {
+        *owned = true; // inline data without a key: not cached
+    }
+    free(cache_key);
+    return solver;
+}
+
+/* Internal helper to read [[index, value], ...] (1-based indices) into freshly allocated arrays */
+static int pairs_from_json(const JsonValue *arr, int **idx, float **values, int *count) {
+    *count = 0;
+    if (!arr) return 0;
+    if (arr->type != JSON_ARRAY) return -1;
+    *idx = malloc((arr->count + 1) * sizeof(int));
+    *values = malloc((arr->count + 1) * sizeof(float));
+    if (!*idx || !*values) return -1;
+    for (int k = 0; k < arr->count; k++) {
+        const JsonValue *pair = &arr->items[k];
+        if (pair->type != JSON_ARRAY || pair->count != 2 ||
+            pair->items[0].type != JSON_NUMBER || pair->items[1].type != JSON_NUMBER) return -1;
+        (*idx)[k] = (int)pair->items[0].number - 1;
+        (*values)[k] = (float)pair->items[1].number;
+    }
+    *count = arr->count;
+    return 0;
+}
+
+/* Internal helper to read [item, ...] (1-based) into a freshly allocated array */
+static int indices_from_json(const JsonValue *arr, int **idx, int *count) {
+    *count = 0;
+    if (!arr) return 0;
+    if (arr->type != JSON_ARRAY) return -1;
+    *idx = malloc((arr->count + 1) * sizeof(int));
+    if (!*idx) return -1;
+    for (int k = 0; k < arr->count; k++) {
+        if (arr->items[k].type != JSON_NUMBER) return -1;
+        (*idx)[k] = (int)arr->items[k].number - 1;
+    }
+    *count = arr->count;
+    return 0;
+}
+
+/* Internal helper to read [{"c": .., "weights": [..m..]}, ...] into freshly allocated arrays */
+static int items_from_json(const JsonValue *arr, const int m, float **c, float **weights, int *count) {
+    *count = 0;
+    if (!arr) return 0;
+    if (arr->type != JSON_ARRAY) return -1;
+    *c = malloc((arr->count + 1) * sizeof(float));
+    *weights = malloc(((size_t)arr->count * m + 1) * sizeof(float));
+    if (!*c || !*weights) return -1;
+    for (int k = 0; k < arr->count; k++) {
+        const JsonValue *profit = json_get(&arr->items[k], "c");
+        if (!profit || profit->type != JSON_NUMBER ||
+            json_to_floats(json_get(&arr->items[k], "weights"), &(*weights)[(size_t)k * m], m) < 0) return -1;
+        (*c)[k] = (float)profit->number;
+    }
+    *count = arr->count;
+    return 0;
+}
+
+/* Internal helper to apply the "capacities", "profits", "remove" and "add" fields of a request */
+static int apply_request_delta(MkpSolver *solver, const JsonValue *req, const char **error) {
+    int *capacity_idx = nullptr, *profit_idx = nullptr, *removed = nullptr;
+    float *capacity_values = nullptr, *profit_values = nullptr, *added_c = nullptr, *added_weights = nullptr;
+    ProblemDelta delta = {0};
+    int rc = -1;
+
+    if (pairs_from_json(json_get(req, "capacities"), &capacity_idx, &capacity_values, &delta.num_capacities) != 0) {
+        *error = "capacities must be an array of [constraint, value] pairs";
+    } else if (pairs_from_json(json_get(req, "profits"), &profit_idx, &profit_values, &delta.num_profits) != 0) {
+        *error = "profits must be an array of [item, value] pairs";
+    } else if (indices_from_json(json_get(req, "remove"), &removed, &delta.num_removed) != 0) {
+        *error = "remove must be an array of items";
+    } else if (items_from_json(json_get(req, "add"), mkp_solver_problem(solver)->m,
+                               &added_c, &added_weights, &delta.num_added) != 0) {
+        *error = "add must be an array of {\"c\": number, \"weights\": [m numbers]} objects";
+    } else {
+        delta.capacity_idx = capacity_idx;
+        delta.capacity_values = capacity_values;
+        delta.profit_idx = profit_idx;
+        delta.profit_values = profit_values;
+        delta.removed = removed;
+        delta.added_c = added_c;
+        delta.added_weights = added_weights;
+        if (mkp_solver_apply_delta(solver, &delta) != 0) {
+            *error = "invalid delta";
+        } else {
+            rc = 0;
+        }
+    }
+    free(capacity_idx);
+    free(capacity_values);
+    free(profit_idx);
+    free(profit_values);
+    free(removed);
+    free(added_c);
+    free(added_weights);
+    return rc;
+}
+
+static void handle_solve(Server *srv, const JsonValue *req, FILE *out, const bool apply_delta) {
+    const char *method_name = json_get_string(req, "method", "VNS");
+    MkpMethod method;
+    if (mkp_method_from_name(method_name, &method) != 0) {
+        write_error(out, req, "unknown method");
+        return;
+    }
+    ItemOrder order = srv->base.order;
+    const char *order_name = json_get_string(req, "order", nullptr);
+    if (order_name && order_from_name(order_name, &order) != 0) {
+        write_error(out, req, "unknown order");
+        return;
+    }
+
+    // Stats of this request only (including parsing when the instance was not cached)
+    stats_reset();
+    const uint64_t t0 = stats_now_ns();
+
+    bool cached, owned;
+    const char *error = "unknown error";
+    MkpSolver *solver = request_solver(srv, req, &cached, &owned, &error);
+    if (!solver) {
+        write_error(out, req, error);
+        return;
+    }
+
+    MkpParams params;
+    params_from_request(req, &srv->base, &params);
+    params.order = order;
+    const JsonValue *seed = json_get(req, "seed");
+    if (seed && seed->type == JSON_NUMBER) {
+        mkp_solver_seed(solver, (uint64_t)seed->number);
+    }
+
+    // Starting point: the repaired previous solution after a delta, a solution file,
+    // the previous solution of a cached instance, or random
+    const char *init_file = json_get_string(req, "init", nullptr);
+    if (apply_delta) {
+        if (apply_request_delta(solver, req, &error) != 0) {
+            write_error(out, req, error);
+            if (owned) mkp_solver_destroy(solver);
+            return;
+        }
+    } else if (init_file) {
+        if (mkp_solver_load_initial(solver, init_file) != 0) {
+            write_error(out, req, "cannot read init solution");
+            if (owned) mkp_solver_destroy(solver);
+            return;
+        }
+    } else if (cached && json_get_number(req, "warm_start", 0.0) != 0.0) {
+        mkp_solver_set_initial(solver, mkp_solver_solution(solver));
+    } else {
+        mkp_solver_clear_initial(solver);
+    }
+
+    const float max_time = (float)json_get_number(req, "max_time", 1.0);
+    if (mkp_solve(solver, method, &params, max_time) != 0) {
+        write_error(out, req, "solve failed");
+        if (owned) mkp_solver_destroy(solver);
+        return;
+    }
+    const double elapsed = (double)(stats_now_ns() - t0) * 1e-9;
+
+    SearchStats stats;
+    stats_snapshot(&stats);
+
+    const Solution *sol = mkp_solver_solution(solver);
+    int count_selected = 0;
+    for (int j = 0; j < sol->n; j++) {
+        if (sol->x[j] > 0.5f) count_selected++;
+    }
+
+    write_id(out, req);
+    fprintf(out, ", \"ok\": true, \"method\": \"%s\", \"value\": %.0f, \"feasible\": %s, \"num_selected\": %d, \"items\": [",
+            mkp_method_name(method), sol->value, sol->feasible ? "true" : "false", count_selected);
+    bool first = true;
+    for (int j = 0; j < sol->n; j++) {
+        if (sol->x[j] > 0.5f) {
+            fprintf(out, first ? "%d" : ", %d", j + 1);
+            first = false;
+        }
+    }
+    fprintf(out, "], \"time\": %.6f, \"cached\": %s, \"stats\": ", elapsed, cached ? "true" : "false");
+    stats_fprint_json(out, &stats);
+    fprintf(out, "}\n");
+
+    if (owned) mkp_solver_destroy(solver);
+}
+
+static void handle_request(Server *srv, const char *line, FILE *out) {
+    JsonValue req;
+    const char *error = nullptr;
+    if (json_parse(line, &req, &error) != 0 || req.type != JSON_OBJECT) {
+        if (error == nullptr) json_free(&req);
+        JsonValue empty = { .type = JSON_NULL };
+        write_error(out, &empty, error ? error : "request must be a JSON object");
+        return;
+    }
+
+    const char *cmd = json_get_string(&req, "cmd", "solve");
+    if (strcmp(cmd, "solve") == 0) {
+        handle_solve(srv, &req, out, false);
+    } else if (strcmp(cmd, "delta") == 0) {
+        handle_solve(srv, &req, out, true);
+    } else if (strcmp(cmd, "ping") == 0) {
+        write_id(out, &req);
+        fprintf(out, ", \"ok\": true, \"cached_instances\": %d}\n", srv->count);
+    } else if (strcmp(cmd, "evict") == 0) {
+        const char *path = json_get_string(&req, "instance", "");
+        const char *key = json_get_string(&req, "key", nullptr);
+        bool found = false;
+        for (int i = 0; i < srv->count; i++) {
+            const char *entry = srv->entries[i].key;
+            const bool match = key ? (strncmp(entry, "data:", 5) == 0 && strcmp(entry + 5, key) == 0)
+                                   : strcmp(entry, path) == 0;
+            if (match) {
+                cache_remove(srv, i);
+                found = true;
+                break;
+            }
+        }
+        write_id(out, &req);
+        fprintf(out, ", \"ok\": %s}\n", found ? "true" : "false");
+    } else if (strcmp(cmd, "shutdown") == 0) {
+        srv->shutdown = true;
+        write_id(out, &req);
+        fprintf(out, ", \"ok\": true}\n");
+    } else {
+        write_error(out, &req, "unknown cmd");
+    }
+    fflush(out);
+    json_free(&req);
+}
+
+/* Internal helper to serve requests from a stream until EOF or shutdown */
+static void serve_stream(Server *srv, FILE *in, FILE *out) {
+    char *line = nullptr;
+    size_t cap = 0;
+    ssize_t len;
+    while (!srv->shutdown && (len = getline(&line, &cap, in)) != -1) {
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+        if (len == 0) continue;
+        handle_request(srv, line, out);
+    }
+    free(line);
+}
+
+static int serve_socket(Server *srv, const char *path) {
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        close(fd);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    fprintf(stderr, "mkp_server listening on %s\n", path);
+
+    // One client at a time: solves are CPU-bound and use the cached workspaces
+    while (!srv->shutdown) {
+        const int client = accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        FILE *in = fdopen(client, "r");
+        FILE *out = fdopen(dup(client), "w");
+        if (in && out) {
+            serve_stream(srv, in, out);
+        }
+        if (in) fclose(in); else close(client);
+        if (out) fclose(out);
+    }
+
+    close(fd);
+    unlink(path);
+    return 0;
+}
+
+int main(const int argc, char *argv[]) {
+    const char *socket_path = nullptr;
+    Server *srv = calloc(1, sizeof(Server));
+    if (!srv) return EXIT_FAILURE;
+    srv->max_cached = SERVER_DEFAULT_MAX_CACHED;
+    mkp_default_params(&srv->base);
+    srv->base.log_level = NONE; // stdout carries the protocol
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--socket=", 9) == 0) {
+            socket_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "--max_cached=", 13) == 0) {
+            srv->max_cached = atoi(argv[i] + 13);
+            if (srv->max_cached < 1) srv->max_cached = 1;
+            if (srv->max_cached > SERVER_MAX_CACHED) srv->max_cached = SERVER_MAX_CACHED;
+        } else if (strncmp(argv[i], "--population_size=", 18) == 0) {
+            srv->base.population_size = atoi(argv[i] + 18);
+        } else {
+            fprintf(stderr, "Usage: %s [--socket=/path/to/socket] [--max_cached=N] [--population_size=PS]\n"
+                            "Without --socket, requests are read from stdin and answered on stdout.\n", argv[0]);
+            free(srv);
+            return EXIT_FAILURE;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    int rc = 0;
+    if (socket_path) {
+        rc = serve_socket(srv, socket_path);
+    } else {
+        serve_stream(srv, stdin, stdout);
+    }
+
+    while (srv->count > 0) cache_remove(srv, srv->count - 1);
+    free(srv);
+    return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
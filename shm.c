@@ -0,0 +1,256 @@
+//
+// Shared-memory segment: an instance and a solution board shared by cooperating solver processes.
+//
+#include <shm.h>
+#include <utils.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// "MKPS", and the version of the layout below
+#define SHM_MAGIC 0x4d4b5053u
+#define SHM_LAYOUT 2u
+
+// Value of state once the creator has filled the segment
+#define SHM_READY 1u
+
+/* Start of the segment; followed by c, capacities and weights, then by the board */
+typedef struct {
+    _Atomic uint32_t state;     // SHM_READY once filled
+    uint32_t magic;
+    uint32_t layout;
+    int n;
+    int m;
+    _Atomic int attached;       // processes that have the segment open
+    char instance[256];         // file name (without directories) of the instance
+} ShmHeader;
+
+/* Internal helper to round a size up to a cache line */
+static inline size_t round_line(const size_t bytes) {
+    return (bytes + 63) / 64 * 64;
+}
+
+/* Internal helper to get the offset of the board in a segment */
+static inline size_t board_offset(const int n, const int m) {
+    return round_line(sizeof(ShmHeader)) + round_line(((size_t)n + m + (size_t)m * n) * sizeof(float));
+}
+
+/* Internal helper to get the size of a segment */
+static inline size_t segment_bytes(const int n, const int m) {
+    return board_offset(n, m) + solution_board_bytes(BOARD_SIZE, n);
+}
+
+/* Internal helper to get the file name of a path */
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+/* Internal helper to sleep for a millisecond */
+static void sleep_ms(void) {
+    const struct timespec ts = {.tv_sec = 0, .tv_nsec = 1000000};
+    nanosleep(&ts, nullptr);
+}
+
+/* Internal helper to point seg to the instance and the board of its mapping */
+static void attach(ShmSegment *seg) {
+    const ShmHeader *header = seg->base;
+    char *base = seg->base;
+    seg->n = header->n;
+    seg->m = header->m;
+    seg->c = (const float*)(base + round_line(sizeof(ShmHeader)));
+    seg->capacities = seg->c + seg->n;
+    seg->weights = seg->capacities + seg->m;
+    solution_board_attach(&seg->board, BOARD_SIZE, seg->n, base + board_offset(seg->n, seg->m));
+}
+
+/* Internal helper to map an open segment */
+static int map(ShmSegment *seg, const int fd) {
+    void *base = mmap(nullptr, seg->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Cannot map shared memory %s: %s.\n", seg->name, strerror(errno));
+        return -1;
+    }
+    seg->base = base;
+    return 0;
+}
+
+/* Internal helper to size and fill a segment just created, from the parsed instance */
+static int create(ShmSegment *seg, const int fd, const char *file, const Problem *prob) {
+    seg->size = segment_bytes(prob->n, prob->m);
+    if (ftruncate(fd, (off_t)seg->size) != 0) {
+        fprintf(stderr, "Cannot size shared memory %s: %s.\n", seg->name, strerror(errno));
+        return -1;
+    }
+    if (map(seg, fd) != 0) {
+        return -1;
+    }
+    seg->created = true;
+
+    ShmHeader *header = seg->base;
+    header->magic = SHM_MAGIC;
+    header->layout = SHM_LAYOUT;
+    header->n = prob->n;
+    header->m = prob->m;
+    snprintf(header->instance, sizeof(header->instance), "%s", file);
+    atomic_init(&header->attached, 1);
+    attach(seg);
+    memcpy((float*)seg->c, prob->c, prob->n * sizeof(float));
+    memcpy((float*)seg->capacities, prob->capacities, prob->m * sizeof(float));
+    memcpy((float*)seg->weights, prob->weights, (size_t)prob->m * prob->n * sizeof(float));
+    solution_board_clear(&seg->board);
+
+    // Joiners read nothing before they see the segment ready
+    atomic_store_explicit(&header->state, SHM_READY, memory_order_release);
+    return 0;
+}
+
+/* Internal helper to count a process in, unless the last one already left (the segment is then
+ * being removed, and may not even have a name any more)
+ * @return false if the count was 0 */
+static bool attach_count(ShmHeader *header) {
+    int attached = atomic_load(&header->attached);
+    while (attached > 0) {
+        if (atomic_compare_exchange_weak(&header->attached, &attached, attached + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Internal helper to wait for a segment created by another process, check it and copy its instance
+ * @return 0 on success, 1 if the segment is being removed, -1 on error */
+static int join(ShmSegment *seg, const int fd, const char *file, Problem *prob) {
+    // The creator sizes the segment, then fills it
+    struct stat st;
+    int waited = 0;
+    while (fstat(fd, &st) == 0 && st.st_size == 0 && waited < SHM_WAIT_MS) {
+        sleep_ms();
+        waited++;
+    }
+    if (st.st_size < (off_t)sizeof(ShmHeader)) {
+        fprintf(stderr, "Shared memory %s is empty.\n", seg->name);
+        return -1;
+    }
+    seg->size = (size_t)st.st_size;
+    if (map(seg, fd) != 0) {
+        return -1;
+    }
+    ShmHeader *header = seg->base;
+    while (atomic_load_explicit(&header->state, memory_order_acquire) != SHM_READY && waited < SHM_WAIT_MS) {
+        sleep_ms();
+        waited++;
+    }
+
+    int status = 0;
+    if (atomic_load_explicit(&header->state, memory_order_acquire) != SHM_READY) {
+        fprintf(stderr, "Timed out waiting for shared memory %s to be filled.\n", seg->name);
+        status = -1;
+    } else if (header->magic != SHM_MAGIC || header->layout != SHM_LAYOUT || header->n <= 0 || header->m <= 0 ||
+               seg->size != segment_bytes(header->n, header->m)) {
+        fprintf(stderr, "Shared memory %s was not made by this version of the solver.\n", seg->name);
+        status = -1;
+    } else if (strcmp(header->instance, file) != 0) {
+        fprintf(stderr, "Shared memory %s holds instance %s, not %s.\n", seg->name, header->instance, file);
+        status = -1;
+    } else if (!attach_count(header)) {
+        status = 1;
+    }
+    if (status != 0) {
+        munmap(seg->base, seg->size);
+        seg->base = nullptr;
+        return status;
+    }
+
+    // Counted in: from here on, leaving goes through shm_segment_close
+    attach(seg);
+    if (problem_from_arrays(prob, seg->n, seg->m, seg->c, seg->capacities, seg->weights) != 0) {
+        shm_segment_close(seg);
+        return -1;
+    }
+    return 0;
+}
+
+/* Internal helper to create the segment of seg->name, or join it if it exists
+ * @return 0 on success, 1 if the segment was being removed, -1 on error */
+static int open_once(ShmSegment *seg, const char *instance_file, const char *file, Problem *prob) {
+    int fd = shm_open(seg->name, O_RDWR, 0600);
+    if (fd < 0 && errno == ENOENT) {
+        // Nobody has it yet: parse the instance, then race the other processes to create it
+        if (parse_instance(instance_file, prob) != 0) {
+            return -1;
+        }
+        fd = shm_open(seg->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            const int status = create(seg, fd, file, prob);
+            close(fd);
+            if (status != 0) {
+                if (seg->base) {
+                    munmap(seg->base, seg->size);
+                    seg->base = nullptr;
+                }
+                shm_unlink(seg->name);
+                free_problem(prob);
+            }
+            return status;
+        }
+        free_problem(prob);
+        if (errno == EEXIST) {
+            fd = shm_open(seg->name, O_RDWR, 0600);
+        }
+    }
+    if (fd < 0) {
+        // Removed between the two opens: try again
+        if (errno == ENOENT) {
+            return 1;
+        }
+        fprintf(stderr, "Cannot open shared memory %s: %s.\n", seg->name, strerror(errno));
+        return -1;
+    }
+    const int status = join(seg, fd, file, prob);
+    close(fd);
+    return status;
+}
+
+int shm_segment_open(ShmSegment *seg, const char *name, const char *instance_file, Problem *prob) {
+    memset(seg, 0, sizeof(*seg));
+    const int length = snprintf(seg->name, SHM_NAME_MAX, "%s%s", name[0] == '/' ? "" : "/", name);
+    if (length <= 1 || length >= SHM_NAME_MAX || strchr(seg->name + 1, '/')) {
+        fprintf(stderr, "Invalid shared memory name %s.\n", name);
+        return -1;
+    }
+    const char *file = base_name(instance_file);
+
+    // A segment whose last process is leaving cannot be joined: wait for its name to go, then
+    // create a new one
+    for (int waited = 0; waited < SHM_WAIT_MS; waited++) {
+        const int status = open_once(seg, instance_file, file, prob);
+        if (status <= 0) {
+            return status;
+        }
+        sleep_ms();
+    }
+    fprintf(stderr, "Timed out waiting for shared memory %s to be removed.\n", seg->name);
+    return -1;
+}
+
+void shm_segment_close(ShmSegment *seg) {
+    if (!seg || !seg->base) {
+        return;
+    }
+    ShmHeader *header = seg->base;
+    const bool last = atomic_fetch_sub(&header->attached, 1) == 1;
+    munmap(seg->base, seg->size);
+    seg->base = nullptr;
+    solution_board_free(&seg->board);
+    if (last) {
+        shm_unlink(seg->name);
+    }
+}
@@ -0,0 +1,187 @@
+//
+// Search counters and per-phase wall-clock timers.
+// Each thread counts into its own block; blocks are merged into atomic totals on flush.
+//
+#include <stats.h>
+#include <json.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+thread_local SearchStats tls_stats;
+
+static _Atomic uint64_t global_counters[STAT_COUNT];
+static _Atomic uint64_t global_phase_ns[PHASE_COUNT];
+static _Atomic uint64_t global_phase_calls[PHASE_COUNT];
+static _Atomic uint64_t global_node_evals[STATS_MAX_NODES];
+static _Atomic uint64_t global_node_moves[STATS_MAX_NODES];
+
+// NUMA node of the calling thread, for the per-node counters
+static thread_local int tls_node;
+
+static const char *counter_names[STAT_COUNT] = {
+    [STAT_FULL_EVALS]        = "full_evaluations",
+    [STAT_INCREMENTAL_MOVES] = "incremental_moves",
+    [STAT_REPAIRS]           = "repairs",
+    [STAT_REPAIR_DROPS]      = "repair_dropped_items",
+    [STAT_LS_ITERATIONS]     = "ls_iterations",
+    [STAT_LS_IMPROVEMENTS]   = "ls_improvements",
+    [STAT_VND_ITERATIONS]    = "vnd_iterations",
+    [STAT_VNS_SHAKES]        = "vns_shakes",
+    [STAT_GA_GENERATIONS]    = "ga_generations",
+    [STAT_GA_OFFSPRING]      = "ga_offspring",
+    [STAT_INCUMBENT_IMPROVEMENTS] = "incumbent_improvements",
+    [STAT_ELITE_INSERTS]     = "elite_inserts",
+    [STAT_RELINK_PATHS]      = "relink_paths",
+    [STAT_TABU_ITERATIONS]   = "tabu_iterations",
+    [STAT_PORTFOLIO_SLICES]  = "portfolio_slices",
+    [STAT_BOARD_PUBLISHES]   = "board_publishes",
+    [STAT_BOARD_IMPORTS]     = "board_imports",
+};
+
+static const char *phase_names[PHASE_COUNT] = {
+    [PHASE_PARSE] = "parse",
+    [PHASE_GD]    = "gd",
+    [PHASE_VNS]   = "vns",
+    [PHASE_GA]    = "ga",
+};
+
+uint64_t stats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void stats_set_node(const int node) {
+    tls_node = (node < 0) ? 0 : (node < STATS_MAX_NODES ? node : STATS_MAX_NODES - 1);
+}
+
+void stats_flush_thread(void) {
+    atomic_fetch_add_explicit(&global_node_evals[tls_node], tls_stats.counters[STAT_FULL_EVALS], memory_order_relaxed);
+    atomic_fetch_add_explicit(&global_node_moves[tls_node], tls_stats.counters[STAT_INCREMENTAL_MOVES],
+                              memory_order_relaxed);
+    for (int c = 0; c < STAT_COUNT; c++) {
+        atomic_fetch_add_explicit(&global_counters[c], tls_stats.counters[c], memory_order_relaxed);
+    }
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        atomic_fetch_add_explicit(&global_phase_ns[p], tls_stats.phase_ns[p], memory_order_relaxed);
+        atomic_fetch_add_explicit(&global_phase_calls[p], tls_stats.phase_calls[p], memory_order_relaxed);
+    }
+    memset(&tls_stats, 0, sizeof(tls_stats));
+}
+
+void stats_snapshot(SearchStats *out) {
+    stats_flush_thread();
+    for (int c = 0; c < STAT_COUNT; c++) {
+        out->counters[c] = atomic_load_explicit(&global_counters[c], memory_order_relaxed);
+    }
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        out->phase_ns[p]    = atomic_load_explicit(&global_phase_ns[p], memory_order_relaxed);
+        out->phase_calls[p] = atomic_load_explicit(&global_phase_calls[p], memory_order_relaxed);
+    }
+    for (int node = 0; node < STATS_MAX_NODES; node++) {
+        out->node_evals[node] = atomic_load_explicit(&global_node_evals[node], memory_order_relaxed);
+        out->node_moves[node] = atomic_load_explicit(&global_node_moves[node], memory_order_relaxed);
+    }
+}
+
+void stats_reset(void) {
+    memset(&tls_stats, 0, sizeof(tls_stats));
+    for (int c = 0; c < STAT_COUNT; c++) {
+        atomic_store_explicit(&global_counters[c], 0, memory_order_relaxed);
+    }
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        atomic_store_explicit(&global_phase_ns[p], 0, memory_order_relaxed);
+        atomic_store_explicit(&global_phase_calls[p], 0, memory_order_relaxed);
+    }
+    for (int node = 0; node < STATS_MAX_NODES; node++) {
+        atomic_store_explicit(&global_node_evals[node], 0, memory_order_relaxed);
+        atomic_store_explicit(&global_node_moves[node], 0, memory_order_relaxed);
+    }
+}
+
+const char *stats_counter_name(const StatCounter c) {
+    return (c >= 0 && c < STAT_COUNT) ? counter_names[c] : "unknown";
+}
+
+const char *stats_phase_name(const StatPhase p) {
+    return (p >= 0 && p < PHASE_COUNT) ? phase_names[p] : "unknown";
+}
+
+/* Internal helper to write the counters, phases and nodes members (without the enclosing braces); the
+ * per-node rates are only written for a positive run time */
+static void fprint_members(FILE *fout, const SearchStats *stats, const bool pretty, const double seconds) {
+    const char *nl = pretty ? "\n" : "";
+    const char *in1 = pretty ? "  " : "";
+    const char *in2 = pretty ? "    " : "";
+
+    // Counters
+    fprintf(fout, "%s\"counters\": {%s", in1, nl);
+    for (int c = 0; c < STAT_COUNT; c++) {
+        fprintf(fout, "%s\"%s\": %llu%s%s", in2, counter_names[c],
+                (unsigned long long)stats->counters[c], c + 1 < STAT_COUNT ? (pretty ? "," : ", ") : "", nl);
+    }
+    fprintf(fout, "%s},%s", in1, pretty ? "\n" : " ");
+
+    // Phases
+    fprintf(fout, "%s\"phases\": {%s", in1, nl);
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        fprintf(fout, "%s\"%s\": {\"seconds\": %.6f, \"calls\": %llu}%s%s", in2, phase_names[p],
+                (double)stats->phase_ns[p] * 1e-9, (unsigned long long)stats->phase_calls[p],
+                p + 1 < PHASE_COUNT ? (pretty ? "," : ", ") : "", nl);
+    }
+    fprintf(fout, "%s},%s", in1, pretty ? "\n" : " ");
+
+    // Nodes, up to the last one that did any work
+    int nodes = 1;
+    for (int node = 0; node < STATS_MAX_NODES; node++) {
+        if (stats->node_evals[node] > 0 || stats->node_moves[node] > 0) {
+            nodes = node + 1;
+        }
+    }
+    fprintf(fout, "%s\"nodes\": [%s", in1, nl);
+    for (int node = 0; node < nodes; node++) {
+        fprintf(fout, "%s{\"node\": %d, \"full_evaluations\": %llu, \"incremental_moves\": %llu", in2, node,
+                (unsigned long long)stats->node_evals[node], (unsigned long long)stats->node_moves[node]);
+        if (seconds > 0.0) {
+            fprintf(fout, ", \"evaluations_per_second\": %.1f, \"moves_per_second\": %.1f",
+                    (double)stats->node_evals[node] / seconds, (double)stats->node_moves[node] / seconds);
+        }
+        fprintf(fout, "}%s%s", node + 1 < nodes ? (pretty ? "," : ", ") : "", nl);
+    }
+    fprintf(fout, "%s]%s", in1, nl);
+}
+
+void stats_fprint_json(FILE *fout, const SearchStats *stats) {
+    fputc('{', fout);
+    fprint_members(fout, stats, false, 0.0);
+    fputc('}', fout);
+}
+
+int stats_write_json(const char *filename, const SearchStats *stats,
+                     const char *instance, const char *method, const double total_seconds) {
+    FILE *fout = fopen(filename, "w");
+    if (!fout) {
+        fprintf(stderr, "Error opening stats file %s.\n", filename);
+        return -1;
+    }
+
+    fprintf(fout, "{\n");
+    if (instance) {
+        fprintf(fout, "  \"instance\": ");
+        json_write_string(fout, instance);
+        fprintf(fout, ",\n");
+    }
+    if (method) {
+        fprintf(fout, "  \"method\": ");
+        json_write_string(fout, method);
+        fprintf(fout, ",\n");
+    }
+    fprintf(fout, "  \"total_seconds\": %.6f,\n", total_seconds);
+    fprint_members(fout, stats, true, total_seconds);
+    fprintf(fout, "}\n");
+
+    fclose(fout);
+    return 0;
+}
@@ -0,0 +1,129 @@
+//
+// Flip tabu search: greedy adds, worst-ranked drops, short-term memory of the flipped items.
+//
+#include <tabu.h>
+#include <stats.h>
+#include <profiler.h>
+#include <math.h>
+#include <string.h>
+
+// Iterations between two checks of the time limit (a check costs a system call)
+#define TABU_TIME_CHECK 64
+
+/* Internal helper to check whether item j fits in the slack of usage */
+static inline bool tabu_fits(const Problem *prob, const float *usage, const int j) {
+    const float *w = &prob->weights_by_item[j * prob->m];
+    for (int k = 0; k < prob->m; k++) {
+        if (usage[k] + w[k] > prob->capacities[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Internal helper to flip item j of the current point, keeping value and usage exact */
+static inline void tabu_flip(const Problem *prob, Solution *current, float *usage, const int j) {
+    const bool add = current->x[j] < 0.5f;
+    const float sign = add ? 1.0f : -1.0f;
+    const float *w = &prob->weights_by_item[j * prob->m];
+    current->x[j] = add ? 1.0f : 0.0f;
+    current->value += sign * prob->c[j];
+    for (int k = 0; k < prob->m; k++) {
+        usage[k] += sign * w[k];
+    }
+}
+
+/* Internal helper to choose the drop that best makes room for item target (-1: any item) */
+static int tabu_drop(const Problem *prob, const Solution *current, const float *usage, const int *tabu_until,
+                     const int iter, const int target) {
+    const int m = prob->m;
+    const float *w_t = (target != -1) ? &prob->weights_by_item[target * m] : nullptr;
+    int drop = -1;
+    float drop_ratio = INFINITY;
+    for (int i = 0; i < prob->n; i++) {
+        if (current->x[i] < 0.5f || tabu_until[i] >= iter) {
+            continue;
+        }
+        const float *w_i = &prob->weights_by_item[i * m];
+        float relief = 0.0f;
+        for (int k = 0; k < m; k++) {
+            if (!w_t || usage[k] + w_t[k] > prob->capacities[k]) {
+                relief += w_i[k] / prob->capacities[k];
+            }
+        }
+        const float ratio = prob->c[i] / (relief + 1e-9f);
+        if (ratio < drop_ratio) {
+            drop_ratio = ratio;
+            drop = i;
+        }
+    }
+    return drop;
+}
+
+void tabu_search(const Problem *prob,
+                 Solution *sol,
+                 const int ls_k,
+                 const int max_no_improvement,
+                 const clock_t start,
+                 const float max_time,
+                 Workspace *ws) {
+    PROFILE_ZONE("tabu_search");
+    const int n = prob->n;
+    const int limit = (ls_k <= n) ? ls_k : n;
+    Solution *current = &ws->tabu_current;
+    float *usage = ws->tabu_usage;
+    int *tabu_until = ws->tabu_until;
+
+    copy_solution(sol, current);
+    compute_usage_from_solution(prob, current, usage);
+    memset(tabu_until, 0, n * sizeof(int));
+
+    uint64_t moves = 0;
+    int no_improvement = 0;
+    for (int iter = 1; no_improvement < max_no_improvement; iter++) {
+        if (iter % TABU_TIME_CHECK == 0 && time_is_up(start, max_time)) {
+            break;
+        }
+        stats_inc(STAT_TABU_ITERATIONS);
+
+        // Most profitable add of the window that fits: not tabu, unless it gives a new best.
+        // The most profitable non-tabu add that does not fit is the target of the next drop
+        int pick = -1;
+        int target = -1;
+        for (int idx = 0; idx < limit; idx++) {
+            const int j = prob->candidate_list[idx];
+            if (current->x[j] > 0.5f || prob->c[j] <= 0.0f || (pick != -1 && prob->c[j] <= prob->c[pick])) {
+                continue;
+            }
+            moves++;
+            const bool allowed = tabu_until[j] < iter;
+            if ((allowed || current->value + prob->c[j] > sol->value) && tabu_fits(prob, usage, j)) {
+                pick = j;
+            } else if (allowed && (target == -1 || prob->c[j] > prob->c[target])) {
+                target = j;
+            }
+        }
+
+        // No add: drop the non-tabu selected item with the least profit per unit of the capacity
+        // the target lacks (per unit of total relative weight if there is no target)
+        if (pick == -1) {
+            pick = tabu_drop(prob, current, usage, tabu_until, iter, target);
+        }
+        if (pick == -1) {
+            break;
+        }
+        tabu_flip(prob, current, usage, pick);
+        tabu_until[pick] = iter + TABU_MIN_TENURE + rng_below(&ws->rng, n / 20 + 1);
+
+        // Every point is feasible: keep the best one
+        if (current->value > sol->value) {
+            copy_solution(current, sol);
+            stats_inc(STAT_INCUMBENT_IMPROVEMENTS);
+            no_improvement = 0;
+        } else {
+            no_improvement++;
+        }
+    }
+    stats_add(STAT_INCREMENTAL_MOVES, moves);
+    sol->feasible = true;
+}
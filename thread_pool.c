@@ -0,0 +1,499 @@
+//
+// Work-stealing pthread pool: every thread owns a Chase-Lev deque of tasks and steals from the
+// others when it runs out; idle workers sleep on a condition variable until a task is posted.
+//
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+#include <thread_pool.h>
+#include <stats.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tasks a deque holds (a power of two); a task submitted to a full deque runs inline
+#define DEQUE_CAPACITY 1024
+
+// Failed attempts to find a task before an idle thread sleeps
+#define IDLE_SPINS 64
+
+// Most NUMA nodes taken into account for the placement
+#define MAX_NODES 64
+
+typedef struct {
+    ThreadPoolTask fn;
+    void *arg;
+    int task;
+    ThreadPoolGroup *group;
+} PoolTask;
+
+/* A deque entry: a thief may read it while the owner rewrites it (the thief's compare-and-swap
+ * then fails), so its fields are atomics */
+typedef struct {
+    _Atomic(ThreadPoolTask) fn;
+    _Atomic(void*) arg;
+    _Atomic int task;
+    _Atomic(ThreadPoolGroup*) group;
+} DequeSlot;
+
+/* Chase-Lev deque: the owner pushes and pops at bottom, thieves take from top */
+typedef struct {
+    alignas(64) _Atomic int64_t top;
+    alignas(64) _Atomic int64_t bottom;
+    DequeSlot *buffer;                /**< DEQUE_CAPACITY tasks, indexed modulo the capacity */
+} Deque;
+
+typedef struct {
+    Deque deque;
+    ThreadPool *pool;
+    int id;
+    int cpu;                          /**< CPU the worker is pinned to, or -1 */
+    int node;                         /**< NUMA node of that CPU, or of node_set */
+#ifdef __linux__
+    bool bound;                       /**< Unpinned, but kept on the CPUs of its node */
+    cpu_set_t node_set;               /**< Allowed CPUs of the node, when bound */
+#endif
+    PoolTask mail;                    /**< Task of thread_pool_run_each for this worker */
+    _Atomic bool has_mail;
+} PoolWorker;
+
+struct ThreadPool {
+    int size;                 /**< Threads, including the caller */
+    pthread_t *threads;       /**< The size - 1 workers */
+    PoolWorker *workers;      /**< Deques and placement of every thread, the caller's first */
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;   /**< Signaled when a task is posted, a group completes or the pool stops */
+    _Atomic uint64_t posted;  /**< Number of posts (new tasks or completed groups) */
+    _Atomic int sleepers;     /**< Threads waiting on work_cv */
+    _Atomic bool stop;        /**< Set by thread_pool_destroy */
+};
+
+/* The pool and index of the calling thread, if it is a worker */
+static thread_local ThreadPool *tls_pool;
+static thread_local int tls_worker;
+
+/* Internal helper: index of the calling thread in the pool (outside threads are worker 0) */
+static inline int self_id(const ThreadPool *pool) {
+    return (tls_pool == pool) ? tls_worker : 0;
+}
+
+/* Internal helpers to write and read a deque entry */
+static inline void slot_store(DequeSlot *slot, const PoolTask *t) {
+    atomic_store_explicit(&slot->fn, t->fn, memory_order_relaxed);
+    atomic_store_explicit(&slot->arg, t->arg, memory_order_relaxed);
+    atomic_store_explicit(&slot->task, t->task, memory_order_relaxed);
+    atomic_store_explicit(&slot->group, t->group, memory_order_relaxed);
+}
+
+static inline PoolTask slot_load(DequeSlot *slot) {
+    return (PoolTask){
+        .fn = atomic_load_explicit(&slot->fn, memory_order_relaxed),
+        .arg = atomic_load_explicit(&slot->arg, memory_order_relaxed),
+        .task = atomic_load_explicit(&slot->task, memory_order_relaxed),
+        .group = atomic_load_explicit(&slot->group, memory_order_relaxed),
+    };
+}
+
+/* Internal helper: push a task at the bottom of the owner's deque */
+static bool deque_push(Deque *dq, const PoolTask *t) {
+    const int64_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+    const int64_t top = atomic_load_explicit(&dq->top, memory_order_acquire);
+    if (b - top >= DEQUE_CAPACITY) {
+        return false;
+    }
+    slot_store(&dq->buffer[b & (DEQUE_CAPACITY - 1)], t);
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_release);
+    return true;
+}
+
+/* Internal helper: pop the newest task of the owner's deque */
+static bool deque_pop(Deque *dq, PoolTask *out) {
+    const int64_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&dq->top, memory_order_relaxed);
+    if (top > b) {
+        atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+        return false;
+    }
+    *out = slot_load(&dq->buffer[b & (DEQUE_CAPACITY - 1)]);
+    if (top == b) {
+        // Last task: race the thieves for it
+        const bool won = atomic_compare_exchange_strong_explicit(&dq->top, &top, top + 1,
+                                                                 memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+/* Internal helper: steal the oldest task of another thread's deque, if it belongs to group
+ * (any group if NULL) */
+static bool deque_steal(Deque *dq, PoolTask *out, const ThreadPoolGroup *group) {
+    int64_t top = atomic_load_explicit(&dq->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const int64_t b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+    if (top >= b) {
+        return false;
+    }
+    const PoolTask t = slot_load(&dq->buffer[top & (DEQUE_CAPACITY - 1)]);
+    if (group && t.group != group) {
+        return false;
+    }
+    if (!atomic_compare_exchange_strong_explicit(&dq->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return false;
+    }
+    *out = t;
+    return true;
+}
+
+/* Internal helper: tell sleeping threads that something changed */
+static void post(ThreadPool *pool) {
+    atomic_fetch_add(&pool->posted, 1);
+    if (atomic_load(&pool->sleepers) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->work_cv);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/* Internal helper: sleep until a post after seen (or until group is done, if given) */
+static void sleep_until_post(ThreadPool *pool, const uint64_t seen, const ThreadPoolGroup *group) {
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->sleepers, 1);
+    while (!atomic_load(&pool->stop) && atomic_load(&pool->posted) == seen &&
+           (!group || atomic_load(&group->pending) > 0)) {
+        pthread_cond_wait(&pool->work_cv, &pool->lock);
+    }
+    atomic_fetch_sub(&pool->sleepers, 1);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Internal helper: run a task and mark it done in its group */
+static void execute(ThreadPool *pool, const PoolTask *t, const int worker) {
+    t->fn(t->arg, t->task, worker);
+    if (worker != 0) {
+        stats_flush_thread();
+    }
+    if (atomic_fetch_sub_explicit(&t->group->pending, 1, memory_order_acq_rel) == 1) {
+        post(pool);
+    }
+}
+
+/* Internal helper: run one task of group (any task, including run_each mail, if NULL) */
+static bool run_one(ThreadPool *pool, const int worker, ThreadPoolGroup *group) {
+    PoolWorker *self = &pool->workers[worker];
+    PoolTask t;
+    if (!group && atomic_load_explicit(&self->has_mail, memory_order_acquire)) {
+        t = self->mail;
+        atomic_store_explicit(&self->has_mail, false, memory_order_relaxed);
+        execute(pool, &t, worker);
+        return true;
+    }
+    if (deque_pop(&self->deque, &t)) {
+        if (!group || t.group == group) {
+            execute(pool, &t, worker);
+            return true;
+        }
+        deque_push(&self->deque, &t); // just popped: there is room
+    }
+    for (int k = 1; k < pool->size; k++) {
+        const int victim = (worker + k) % pool->size;
+        if (deque_steal(&pool->workers[victim].deque, &t, group)) {
+            execute(pool, &t, worker);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void *worker_main(void *arg) {
+    PoolWorker *self = arg;
+    ThreadPool *pool = self->pool;
+    tls_pool = pool;
+    tls_worker = self->id;
+    stats_set_node(self->node);
+#ifdef __linux__
+    if (self->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(self->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    } else if (self->bound) {
+        pthread_setaffinity_np(pthread_self(), sizeof(self->node_set), &self->node_set);
+    }
+#endif
+
+    int idle = 0;
+    while (!atomic_load(&pool->stop)) {
+        const uint64_t seen = atomic_load(&pool->posted);
+        if (run_one(pool, self->id, nullptr)) {
+            idle = 0;
+        } else if (++idle < IDLE_SPINS) {
+            sched_yield();
+        } else {
+            idle = 0;
+            sleep_until_post(pool, seen, nullptr);
+        }
+    }
+    return nullptr;
+}
+
+#ifdef __linux__
+/* Internal helper to read the CPUs of NUMA node `node` from sysfs into a set */
+static bool read_node_cpus(const int node, cpu_set_t *set) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    CPU_ZERO(set);
+    int lo, hi;
+    while (fscanf(f, "%d", &lo) == 1) {
+        hi = lo;
+        int c = fgetc(f);
+        if (c == '-') {
+            if (fscanf(f, "%d", &hi) != 1) break;
+            c = fgetc(f);
+        }
+        for (int cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, set);
+        }
+        if (c != ',') break;
+    }
+    fclose(f);
+    return true;
+}
+#endif
+
+/* Internal helper to place the threads: round-robin over the NUMA nodes of the allowed CPUs,
+ * from the node of the calling thread; pinned only if every thread gets a CPU of its own */
+static void place_workers(ThreadPool *pool) {
+    for (int t = 0; t < pool->size; t++) {
+        pool->workers[t].cpu = -1;
+        pool->workers[t].node = 0;
+#ifdef __linux__
+        pool->workers[t].bound = false;
+#endif
+    }
+#ifdef __linux__
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+
+    // Allowed CPUs of each node (a single node without sysfs information)
+    cpu_set_t node_cpus[MAX_NODES];
+    int nodes = 0;
+    while (nodes < MAX_NODES && read_node_cpus(nodes, &node_cpus[nodes])) {
+        CPU_AND(&node_cpus[nodes], &node_cpus[nodes], &allowed);
+        nodes++;
+    }
+    if (nodes == 0) {
+        node_cpus[0] = allowed;
+        nodes = 1;
+    }
+    const int here = sched_getcpu();
+    int first = 0;
+    for (int node = 0; node < nodes; node++) {
+        if (here >= 0 && CPU_ISSET(here, &node_cpus[node])) {
+            first = node;
+        }
+    }
+
+    pool->workers[0].node = first;
+
+    // Too few CPUs to pin every thread: the workers interleave the nodes, each on its node's CPUs,
+    // so that what they first touch and count stays on the node they run on
+    if (CPU_COUNT(&allowed) < pool->size) {
+        for (int t = 1, k = 0; t < pool->size && k < pool->size * nodes; k++) {
+            const int node = (first + k) % nodes;
+            if (CPU_COUNT(&node_cpus[node]) > 0) {
+                pool->workers[t].node = node;
+                pool->workers[t].bound = true;
+                pool->workers[t].node_set = node_cpus[node];
+                t++;
+            }
+        }
+        return;
+    }
+
+    // The caller keeps its CPU: the workers take the others, interleaving the nodes
+    if (here >= 0) {
+        CPU_CLR(here, &node_cpus[first]);
+    }
+    int next_cpu[MAX_NODES] = {0};
+    int t = 1;
+    for (int round = 0; t < pool->size && round < pool->size; round++) {
+        for (int k = 0; k < nodes && t < pool->size; k++) {
+            const int node = (first + k) % nodes;
+            while (next_cpu[node] < CPU_SETSIZE && !CPU_ISSET(next_cpu[node], &node_cpus[node])) {
+                next_cpu[node]++;
+            }
+            if (next_cpu[node] >= CPU_SETSIZE) {
+                continue;
+            }
+            pool->workers[t].cpu = next_cpu[node];
+            pool->workers[t].node = node;
+            next_cpu[node]++;
+            t++;
+        }
+    }
+#endif
+}
+
+ThreadPool *thread_pool_create(const int threads) {
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) {
+        fprintf(stderr, "Memory allocation error in thread_pool_create.\n");
+        return nullptr;
+    }
+    pool->size = (threads > 1) ? threads : 1;
+    pool->threads = (pthread_t*)malloc(pool->size * sizeof(pthread_t));
+    pool->workers = (PoolWorker*)aligned_alloc(alignof(PoolWorker), pool->size * sizeof(PoolWorker));
+    if (!pool->threads || !pool->workers) {
+        fprintf(stderr, "Memory allocation error in thread_pool_create.\n");
+        free(pool->threads);
+        free(pool->workers);
+        free(pool);
+        return nullptr;
+    }
+    memset(pool->workers, 0, pool->size * sizeof(PoolWorker));
+    pthread_mutex_init(&pool->lock, nullptr);
+    pthread_cond_init(&pool->work_cv, nullptr);
+    for (int t = 0; t < pool->size; t++) {
+        pool->workers[t].pool = pool;
+        pool->workers[t].id = t;
+        pool->workers[t].deque.buffer = (DequeSlot*)calloc(DEQUE_CAPACITY, sizeof(DequeSlot));
+        if (!pool->workers[t].deque.buffer) {
+            fprintf(stderr, "Memory allocation error in thread_pool_create.\n");
+            pool->size = 1; // no worker started yet
+            thread_pool_destroy(pool);
+            return nullptr;
+        }
+    }
+    place_workers(pool);
+    stats_set_node(pool->workers[0].node);
+
+    for (int t = 1; t < pool->size; t++) {
+        if (pthread_create(&pool->threads[t], nullptr, worker_main, &pool->workers[t]) != 0) {
+            fprintf(stderr, "Could not start thread %d of %d.\n", t, pool->size);
+            // Only stop the workers already started
+            for (int u = t; u < pool->size; u++) {
+                free(pool->workers[u].deque.buffer);
+                pool->workers[u].deque.buffer = nullptr;
+            }
+            pool->size = t;
+            thread_pool_destroy(pool);
+            return nullptr;
+        }
+    }
+    return pool;
+}
+
+int thread_pool_size(const ThreadPool *pool) {
+    return pool ? pool->size : 1;
+}
+
+int thread_pool_node(const ThreadPool *pool, const int worker) {
+    return (pool && worker >= 0 && worker < pool->size) ? pool->workers[worker].node : 0;
+}
+
+void thread_pool_submit(ThreadPool *pool, ThreadPoolGroup *group, const ThreadPoolTask fn, void *arg, const int task) {
+    if (!pool || pool->size == 1) {
+        fn(arg, task, 0);
+        return;
+    }
+    const int worker = self_id(pool);
+    const PoolTask t = { .fn = fn, .arg = arg, .task = task, .group = group };
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    if (deque_push(&pool->workers[worker].deque, &t)) {
+        post(pool);
+    } else {
+        execute(pool, &t, worker);
+    }
+}
+
+void thread_pool_wait(ThreadPool *pool, ThreadPoolGroup *group) {
+    if (!pool || pool->size == 1) {
+        return;
+    }
+    const int worker = self_id(pool);
+    int idle = 0;
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+        const uint64_t seen = atomic_load(&pool->posted);
+        if (run_one(pool, worker, group)) {
+            idle = 0;
+        } else if (++idle < IDLE_SPINS) {
+            sched_yield();
+        } else {
+            idle = 0;
+            sleep_until_post(pool, seen, group);
+        }
+    }
+}
+
+void thread_pool_run(ThreadPool *pool, const ThreadPoolTask fn, void *arg, const int tasks) {
+    if (!pool || pool->size == 1 || tasks <= 1) {
+        for (int task = 0; task < tasks; task++) {
+            fn(arg, task, 0);
+        }
+        return;
+    }
+    // Pushed from the last task down: the caller pops task 0 first, thieves take the last ones
+    ThreadPoolGroup group;
+    thread_pool_group_init(&group);
+    const int worker = self_id(pool);
+    atomic_store_explicit(&group.pending, tasks, memory_order_relaxed);
+    for (int task = tasks - 1; task >= 0; task--) {
+        const PoolTask t = { .fn = fn, .arg = arg, .task = task, .group = &group };
+        if (!deque_push(&pool->workers[worker].deque, &t)) {
+            execute(pool, &t, worker);
+        }
+    }
+    post(pool);
+    thread_pool_wait(pool, &group);
+}
+
+void thread_pool_run_each(ThreadPool *pool, const ThreadPoolTask fn, void *arg) {
+    if (!pool || pool->size == 1) {
+        fn(arg, 0, 0);
+        return;
+    }
+    ThreadPoolGroup group;
+    thread_pool_group_init(&group);
+    atomic_store_explicit(&group.pending, pool->size - 1, memory_order_relaxed);
+    for (int t = 1; t < pool->size; t++) {
+        PoolWorker *w = &pool->workers[t];
+        w->mail = (PoolTask){ .fn = fn, .arg = arg, .task = t, .group = &group };
+        atomic_store_explicit(&w->has_mail, true, memory_order_release);
+    }
+    post(pool);
+    fn(arg, 0, 0);
+    thread_pool_wait(pool, &group);
+}
+
+void thread_pool_destroy(ThreadPool *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->stop, true);
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+    for (int t = 1; t < pool->size; t++) {
+        pthread_join(pool->threads[t], nullptr);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cv);
+    for (int t = 0; t < pool->size; t++) {
+        free(pool->workers[t].deque.buffer);
+    }
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+}
@@ -6,6 +6,8 @@
 // - A helper for the solver functions that gives an initial solution to work with.
 //
 #include <utils.h>
+#include <order.h>
+#include <stats.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -13,6 +15,12 @@
 #include <time.h>
 
 
+int default_threads(void) {
+    const char *env = getenv("MKP_THREADS");
+    const int threads = env ? atoi(env) : 1;
+    return (threads > 0) ? threads : 1;
+}
+
 Arguments parse_cmd_args(const int argc, char *argv[]) {
     Arguments args;
     // Defaults
@@ -28,6 +36,10 @@ Arguments parse_cmd_args(const int argc, char *argv[]) {
     // Local Search parameters
     args.ls_max_checks   = 500;
     args.ls_mode         = LS_BEST_IMPROVEMENT;
+    args.order           = ORDER_RATIO;
+    args.threads         = default_threads();
+    args.vns_parallel    = VNS_SYNC;
+    args.deterministic   = false;
     // VNS/VND parameters
     args.max_no_improv   = 100;
     args.k_max           = 100;
@@ -36,23 +48,37 @@ Arguments parse_cmd_args(const int argc, char *argv[]) {
     args.max_generations = 1000;
     args.mutation_rate   = 0.01f;
     args.log_level       = INFO;
+    args.stats_file      = nullptr;
+    args.profile_prefix  = nullptr;
+    args.init_file       = nullptr;
+    args.coop_shm        = nullptr;
+    args.seed            = 42;
 
     if (argc < 2) {
         fprintf(stderr,
             "Usage: %s <instance_file> [--cpu|--gpu] "
-            "[--method=LS-FLIP|LS-SWAP|VND|VNS|GD|MULTI-GD-VNS|GA] "
+            "[--method=LS-FLIP|LS-SWAP|VND|VNS|GD|MULTI-GD-VNS|GA|PATH-RELINK|TABU|PORTFOLIO|COOP] "
             "[--output=solution.txt] "
             "[--max_time=seconds] "
             "[--num_starts=N] "
             "[--lambda=L] "
             "[--lr=LR] "
             "[--ls_max_checks=K] "
+            "[--order=ratio|scaled|dual|profit] "
+            "[--threads=T] "
+            "[--vns_parallel=sync|async] "
+            "[--deterministic] "
             "[--max_no_improv=NI] "
             "[--k_max=KM] "
             "[--population_size=PS] "
             "[--max_generations=MG] "
             "[--mutation_rate=MR] "
-            "[--verbose=NONE|INFO|DEBUG]\n",
+            "[--verbose=NONE|INFO|DEBUG] "
+            "[--stats=stats.json] "
+            "[--profile=prefix] "
+            "[--init=solution.txt] "
+            "[--coop-shm=name] "
+            "[--seed=S]\n",
             argv[0]
         );
         exit(EXIT_FAILURE);
@@ -65,6 +91,8 @@ Arguments parse_cmd_args(const int argc, char *argv[]) {
             args.use_gpu = 1;
         } else if (strcmp(argv[i], "--cpu") == 0) {
             args.use_gpu = 0;
+        } else if (strcmp(argv[i], "--deterministic") == 0) {
+            args.deterministic = true;
         } else if (strncmp(argv[i], "--method=", 9) == 0) {
             args.method = argv[i] + 9;
         } else if (strncmp(argv[i], "--output=", 9) == 0) {
@@ -81,6 +109,19 @@ Arguments parse_cmd_args(const int argc, char *argv[]) {
             args.ls_max_checks = atoi(argv[i] + 16);
         } else if (strncmp(argv[i], "--ls_mode=", 10) == 0) {
             args.ls_mode = (strcmp(argv[i] + 10, "first") == 0) ? LS_FIRST_IMPROVEMENT : LS_BEST_IMPROVEMENT;
+        } else if (strncmp(argv[i], "--order=", 8) == 0) {
+            if (order_from_name(argv[i] + 8, &args.order) != 0) {
+                fprintf(stderr, "Unknown order %s. Using ratio.\n", argv[i] + 8);
+                args.order = ORDER_RATIO;
+            }
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            args.threads = atoi(argv[i] + 10);
+            if (args.threads < 1) {
+                fprintf(stderr, "Invalid thread count %s. Using 1.\n", argv[i] + 10);
+                args.threads = 1;
+            }
+        } else if (strncmp(argv[i], "--vns_parallel=", 15) == 0) {
+            args.vns_parallel = (strcmp(argv[i] + 15, "async") == 0) ? VNS_ASYNC : VNS_SYNC;
         } else if (strncmp(argv[i], "--max_no_improv=", 16) == 0) {
             args.max_no_improv = atoi(argv[i] + 16);
         } else if (strncmp(argv[i], "--k_max=", 8) == 0) {
@@ -101,17 +142,38 @@ Arguments parse_cmd_args(const int argc, char *argv[]) {
             } else if (strcmp(argv[i] + 10, "DEBUG") == 0) {
                 args.log_level = DEBUG;
             }
+        } else if (strncmp(argv[i], "--stats=", 8) == 0) {
+            args.stats_file = argv[i] + 8;
+        } else if (strncmp(argv[i], "--profile=", 10) == 0) {
+            args.profile_prefix = argv[i] + 10;
+        } else if (strncmp(argv[i], "--init=", 7) == 0) {
+            args.init_file = argv[i] + 7;
+        } else if (strncmp(argv[i], "--coop-shm=", 11) == 0) {
+            args.coop_shm = argv[i] + 11;
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            args.seed = strtoull(argv[i] + 7, nullptr, 10);
         }
     }
     return args;
 }
 
 
+clock_t wall_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (clock_t)ts.tv_sec * CLOCKS_PER_SEC + (clock_t)((double)ts.tv_nsec * (CLOCKS_PER_SEC / 1e9));
+}
+
 int time_is_up(const clock_t start, const float max_time) {
-    const double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    const double elapsed = (double)(wall_clock() - start) / CLOCKS_PER_SEC;
     return (elapsed >= (double)max_time) ? 1 : 0;
 }
 
+float time_remaining(const clock_t start, const float max_time) {
+    const double elapsed = (double)(wall_clock() - start) / CLOCKS_PER_SEC;
+    return (elapsed < (double)max_time) ? (float)((double)max_time - elapsed) : 0.0f;
+}
+
 /* Internal helper to read arrays in the required format */
 static int read_array(FILE *fin, float *arr, const int count) {
     for (int i = 0; i < count; i++) {
@@ -123,63 +185,143 @@ static int read_array(FILE *fin, float *arr, const int count) {
     return 0;
 }
 
-/* Internal helper to compare ratios in descending order */
-int compare_ratios_descending(const void *a, const void *b) {
+int compare_pairs_descending(const void *a, const void *b) {
     const auto fa = (const float*)a;
     const auto fb = (const float*)b;
-    return (fa[0] < fb[0]) - (fa[0] > fb[0]); // returns -1, 0, 1 for a < b, a == b, a > b
+    if (fa[0] != fb[0]) {
+        return (fa[0] < fb[0]) - (fa[0] > fb[0]); // larger key first
+    }
+    return (fa[1] > fb[1]) - (fa[1] < fb[1]); // equal keys: smaller index first
 }
 
-int parse_instance(const char *filename, Problem *prob) {
-    // Read instance file, and check for errors
-    FILE *fin = fopen(filename, "r");
-    if (!fin) {
-        fprintf(stderr, "Cannot open instance file %s.\n", filename);
+/* Internal helper to allocate the arrays of a problem of size n x m */
+static int allocate_problem(Problem *prob, const int n, const int m) {
+    prob->n = n;
+    prob->m = m;
+    prob->c              = (float*)malloc(n * sizeof(float));
+    prob->capacities     = (float*)malloc(m * sizeof(float));
+    prob->weights        = (float*)malloc(m * n * sizeof(float));
+    prob->weights_by_item = (float*)malloc(m * n * sizeof(float));
+    prob->sum_of_weights = (float*)calloc(n, sizeof(float));
+    prob->ratios         = (float*)calloc(n, sizeof(float));
+    prob->scaled_ratios  = (float*)calloc(n, sizeof(float));
+    prob->dual_ratios    = (float*)calloc(n, sizeof(float));
+    prob->duals          = (float*)calloc(m, sizeof(float));
+    bool orders_ok = true;
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        prob->orders[o] = (int*)malloc(n * sizeof(int));
+        orders_ok &= prob->orders[o] != nullptr;
+    }
+    prob->order = ORDER_RATIO;
+    prob->candidate_list = prob->orders[ORDER_RATIO];
+
+    // Check for allocation errors
+    if (!prob->c || !prob->capacities || !prob->weights || !prob->weights_by_item || !prob->sum_of_weights || !prob->ratios ||
+        !prob->scaled_ratios || !prob->dual_ratios || !prob->duals || !orders_ok) {
+        fprintf(stderr, "Memory allocation error.\n");
+        free_problem(prob);
         return -1;
     }
+    return 0;
+}
+
+/* Internal helper to precompute weights_by_item, sum_of_weights and the item orderings from c and weights */
+static void precompute_problem(Problem *prob) {
+    for (int i = 0; i < prob->m; i++) {
+        for (int j = 0; j < prob->n; j++) {
+            prob->weights_by_item[j * prob->m + i] = prob->weights[i * prob->n + j];
+        }
+    }
 
+    // Precompute for each item j, the sum of weights w_ij
+    for (int j = 0; j < prob->n; j++) {
+        prob->sum_of_weights[j] = 0.0f;
+        for (int i = 0; i < prob->m; i++) {
+            prob->sum_of_weights[j] += prob->weights[i * prob->n + j];
+        }
+    }
+
+    // Ratios, surrogate ratios and the sorted orderings
+    problem_build_orders(prob);
+}
+
+int problem_from_arrays(Problem *prob, const int n, const int m,
+                        const float *c, const float *capacities, const float *weights) {
+    if (n <= 0 || m <= 0) {
+        fprintf(stderr, "Invalid problem size n=%d, m=%d.\n", n, m);
+        return -1;
+    }
+    if (allocate_problem(prob, n, m) != 0) return -1;
+    memcpy(prob->c, c, n * sizeof(float));
+    memcpy(prob->capacities, capacities, m * sizeof(float));
+    memcpy(prob->weights, weights, (size_t)m * n * sizeof(float));
+    precompute_problem(prob);
+    return 0;
+}
+
+/* Internal helper to read an instance from an open file (prob is left unallocated on error) */
+static int read_instance(FILE *fin, Problem *prob) {
     // Read n and m, the number of items and constraints
-    if (fscanf(fin, "%d %d", &prob->n, &prob->m) != 2) {
+    int n, m;
+    if (fscanf(fin, "%d %d", &n, &m) != 2 || n <= 0 || m <= 0) {
         fprintf(stderr, "Error reading n and m.\n");
-        fclose(fin);
         return -1;
     }
 
     // Allocate memory for problem data
-    prob->c              = (float*)malloc(prob->n * sizeof(float));
-    prob->capacities     = (float*)malloc(prob->m * sizeof(float));
-    prob->weights        = (float*)malloc(prob->m * prob->n * sizeof(float));
-    prob->sum_of_weights = (float*)calloc(prob->n, sizeof(float));
-    prob->ratios         = (float*)calloc(prob->n, sizeof(float));
-    prob->candidate_list = (float*)malloc(prob->n * sizeof(float));
-
-    // Check for allocation errors
-    if (!prob->c || !prob->capacities || !prob->weights || !prob->sum_of_weights || !prob->ratios || !prob->candidate_list) {
-        fprintf(stderr, "Memory allocation error.\n");
-        fclose(fin);
+    if (allocate_problem(prob, n, m) != 0) {
         return -1;
     }
 
     // Read data
-    if (read_array(fin, prob->c, prob->n) != 0) { fclose(fin); return -1; }
-    if (read_array(fin, prob->capacities, prob->m) != 0) { fclose(fin); return -1; }
-    if (read_array(fin, prob->weights, prob->m * prob->n) != 0) { fclose(fin); return -1; }
-
-    // Precompute for each item j, the sum of weights w_ij and ratio c_j/w_ij
-    for (int j = 0; j < prob->n; j++) {
-        for (int i = 0; i < prob->m; i++) {
-            prob->sum_of_weights[j] += prob->weights[i * prob->n + j];
-        }
-        prob->ratios[j] = prob->c[j] / prob->sum_of_weights[j];
+    if (read_array(fin, prob->c, prob->n) != 0 ||
+        read_array(fin, prob->capacities, prob->m) != 0 ||
+        read_array(fin, prob->weights, prob->m * prob->n) != 0) {
+        free_problem(prob);
+        return -1;
     }
 
-    // Fill candidate_list : Using quicksort, sort the items by decreasing ratio.
-    for (int j = 0; j < prob->n; j++) {
-        prob->candidate_list[j] = (float)j;
+    precompute_problem(prob);
+    return 0;
+}
+
+int parse_instance(const char *filename, Problem *prob) {
+    const uint64_t t0 = stats_phase_begin();
+
+    // Read instance file, and check for errors
+    int status = -1;
+    FILE *fin = fopen(filename, "r");
+    if (!fin) {
+        fprintf(stderr, "Cannot open instance file %s.\n", filename);
+    } else {
+        status = read_instance(fin, prob);
+        fclose(fin);
     }
-    qsort(prob->candidate_list, prob->n, sizeof(float), compare_ratios_descending);
 
-    fclose(fin);
+    // Failed parses are timed too
+    stats_phase_end(PHASE_PARSE, t0);
+    return status;
+}
+
+int copy_problem(const Problem *src, Problem *dst) {
+    const int n = src->n;
+    const int m = src->m;
+    if (allocate_problem(dst, n, m) != 0) {
+        return -1;
+    }
+    memcpy(dst->c, src->c, n * sizeof(float));
+    memcpy(dst->capacities, src->capacities, m * sizeof(float));
+    memcpy(dst->weights, src->weights, (size_t)m * n * sizeof(float));
+    memcpy(dst->weights_by_item, src->weights_by_item, (size_t)m * n * sizeof(float));
+    memcpy(dst->sum_of_weights, src->sum_of_weights, n * sizeof(float));
+    memcpy(dst->ratios, src->ratios, n * sizeof(float));
+    memcpy(dst->scaled_ratios, src->scaled_ratios, n * sizeof(float));
+    memcpy(dst->dual_ratios, src->dual_ratios, n * sizeof(float));
+    memcpy(dst->duals, src->duals, m * sizeof(float));
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        memcpy(dst->orders[o], src->orders[o], n * sizeof(int));
+    }
+    problem_set_order(dst, src->order);
     return 0;
 }
 
@@ -188,9 +330,16 @@ void free_problem(Problem *prob) {
     free(prob->c); prob->c = nullptr;
     free(prob->capacities); prob->capacities = nullptr;
     free(prob->weights); prob->weights = nullptr;
+    free(prob->weights_by_item); prob->weights_by_item = nullptr;
     free(prob->sum_of_weights); prob->sum_of_weights = nullptr;
     free(prob->ratios); prob->ratios = nullptr;
-    free(prob->candidate_list); prob->candidate_list = nullptr;
+    free(prob->scaled_ratios); prob->scaled_ratios = nullptr;
+    free(prob->dual_ratios); prob->dual_ratios = nullptr;
+    free(prob->duals); prob->duals = nullptr;
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        free(prob->orders[o]); prob->orders[o] = nullptr;
+    }
+    prob->candidate_list = nullptr;
 }
 
 bool check_feasibility(const Problem *prob, const Solution *sol) {
@@ -208,6 +357,8 @@ bool check_feasibility(const Problem *prob, const Solution *sol) {
 }
 
 void evaluate_solution_cpu(const Problem *prob, Solution *sol) {
+    stats_inc(STAT_FULL_EVALS);
+
     // Objective = c^T x
     float val = 0.0f;
     for (int j = 0; j < prob->n; j++) {
@@ -220,41 +371,46 @@ void evaluate_solution_cpu(const Problem *prob, Solution *sol) {
 }
 
 void evaluate_solution_gpu(const Problem *prob, Solution *sol) {
-    // Placeholder: Real code would allocate device memory, copy data, and use cublasSgemv.
-    // For now, we just call CPU version.
+    // Batches go through ws->evaluator; a lone solution is cheapest on the CPU path
     evaluate_solution_cpu(prob, sol);
 }
 
 void construct_initial_solution(const Problem *prob, Solution *sol,
                                 void (*eval_func)(const Problem*, Solution*),
-                                const int num_starts) {
-    Solution best;
-    allocate_solution(&best, prob->n);
-    best.value = -INFINITY;
-    best.feasible = false;
-
-    for (int s = 0; s < num_starts; s++) {
-        Solution candidate;
-        allocate_solution(&candidate, prob->n);
-        for (int j = 0; j < prob->n; j++) {
-            candidate.x[j] = (rand() % 2 == 0) ? 1.0f : 0.0f;
-        }
-        eval_func(prob, &candidate);
+                                const int num_starts,
+                                Workspace *ws) {
+    // sol holds the best start so far
+    sol->value = -INFINITY;
+    sol->feasible = false;
+    for (int j = 0; j < prob->n; j++) {
+        sol->x[j] = 0.0f;
+    }
 
-        // Swap if the candidate is better (feasible when best is not, or higher value)
-        if ((candidate.feasible && !best.feasible) ||
-            (candidate.feasible == best.feasible && candidate.value > best.value)) {
-            // Swap to make candidate the best
-            swap_solutions(&best, &candidate);
+    if (num_starts > 0) {
+        // Draw every start, then score them all in one batch
+        for (int s = 0; s < num_starts; s++) {
+            Solution *candidate = &ws->start_solutions[s];
+            for (int j = 0; j < prob->n; j++) {
+                candidate->x[j] = (rng_next_u32(&ws->rng) & 1u) ? 1.0f : 0.0f;
+            }
+            ws->eval_batch[s] = candidate;
         }
-
-        free_solution(&candidate);
+        batch_evaluate(ws->evaluator, prob, ws->eval_batch, num_starts);
+
+        // Keep the best start (feasible when best is not, or higher value)
+        const Solution *best = &ws->start_solutions[0];
+        for (int s = 1; s < num_starts; s++) {
+            const Solution *candidate = &ws->start_solutions[s];
+            if ((candidate->feasible && !best->feasible) ||
+                (candidate->feasible == best->feasible && candidate->value > best->value)) {
+                best = candidate;
+            }
+        }
+        copy_solution(best, sol);
+    } else {
+        eval_func(prob, sol);
     }
 
-    // Copy best to sol
-    swap_solutions(&best, sol);
-    free_solution(&best);
-
     // Modify solution to be feasible
     if (!sol->feasible) {
         for (int j = 0; j < prob->n; j++) {
@@ -291,6 +447,42 @@ void save_solution(const char *filename, const Solution *sol) {
     fclose(fout);
 }
 
+int read_solution(const char *filename, const Problem *prob, Solution *sol) {
+    // Open file for reading and check for errors
+    FILE *fin = fopen(filename, "r");
+    if (!fin) {
+        fprintf(stderr, "Cannot open solution file %s.\n", filename);
+        return -1;
+    }
+
+    // Line 1: value and number of selected items
+    float value;
+    int count_selected;
+    if (fscanf(fin, "%f %d", &value, &count_selected) != 2 || count_selected < 0 || count_selected > prob->n) {
+        fprintf(stderr, "Error reading solution header in %s.\n", filename);
+        fclose(fin);
+        return -1;
+    }
+
+    // Line 2: selected items (1-based)
+    for (int j = 0; j < prob->n; j++) {
+        sol->x[j] = 0.0f;
+    }
+    for (int k = 0; k < count_selected; k++) {
+        int item;
+        if (fscanf(fin, "%d", &item) != 1 || item < 1 || item > prob->n) {
+            fprintf(stderr, "Invalid item in solution file %s.\n", filename);
+            fclose(fin);
+            return -1;
+        }
+        sol->x[item - 1] = 1.0f;
+    }
+    fclose(fin);
+
+    evaluate_solution_cpu(prob, sol);
+    return 0;
+}
+
 /**
  * @brief Computes usage array from a 0-1 solution x (stored in out_sol->x).
  *
@@ -1,51 +1,106 @@
 #include "lib/vnd.h"
 #include <local_search.h>
+#include <exchange.h>
+#include <stats.h>
+#include <profiler.h>
 #include <stdio.h>
 
-void vnd(const Problem *prob,
-        Solution *sol,
-        const int max_no_improvement,
-        const int ls_k,
-        const LSMode ls_mode,
-        const clock_t start,
-        const float max_time) {
-
-    int no_improvement = 0;
+/* Neighborhoods of the descent, from the cheapest to the most expensive */
+static void (*const vnd_levels[])(SearchContext *ctx) = {
+    local_search_flip_ctx,
+    local_search_swap_ctx,
+    local_search_exchange_21_ctx,
+    local_search_exchange_12_ctx,
+    local_search_ejection_ctx,
+};
 
-    // Allocate candidate solution once
-    Solution candidate_sol;
-    allocate_solution(&candidate_sol, prob->n);
+/* Internal helper for one VND iteration: each level runs only if the previous ones did not improve */
+static bool vnd_iteration(SearchContext *ctx) {
+    stats_inc(STAT_VND_ITERATIONS);
+    const float value_before = ctx->sol->value;
 
-    // Repeat until we reach the maximum allowed iterations without improvement
-    while (no_improvement < max_no_improvement && !time_is_up(start, max_time)) {
-        bool improved = false;
+    // Local search only accepts strictly improving moves, so it runs on the context's solution directly
+    bool improved = false;
+    for (size_t level = 0; level < sizeof(vnd_levels) / sizeof(vnd_levels[0]) && !improved; level++) {
+        vnd_levels[level](ctx);
+        improved = ctx->sol->value > value_before;
+    }
+    return improved;
+}
 
-        // Flip first
-        copy_solution(sol, &candidate_sol);
-        local_search_flip(prob, &candidate_sol, ls_k, ls_mode);
+void vnd_ctx(SearchContext *ctx, const int max_no_improvement) {
+    PROFILE_ZONE("vnd");
 
-        if (candidate_sol.value > sol->value) {
-            copy_solution(&candidate_sol, sol);
-            improved = true;
-        }
-        else {
-            // Swap
-            copy_solution(sol, &candidate_sol);
-            local_search_swap(prob, &candidate_sol, ls_k, ls_mode);
-            if (candidate_sol.value > sol->value) {
-                copy_solution(&candidate_sol, sol);
-                improved = true;
-            }
-        }
+    int no_improvement = 0;
 
+    // Repeat until we reach the maximum allowed iterations without improvement
+    while (no_improvement < max_no_improvement && !time_is_up(ctx->start, ctx->max_time)) {
         // Track consecutive iterations with no improvement
-        if (improved) {
+        if (vnd_iteration(ctx)) {
             no_improvement = 0;
         } else {
             no_improvement++;
         }
     }
+}
+
+void vnd_init(VndState *st,
+              const Problem *prob,
+              Solution *sol,
+              const int max_no_improvement,
+              const int ls_k,
+              const LSMode ls_mode,
+              Workspace *ws) {
+    compute_usage_from_solution(prob, sol, ws->ls_usage);
+    *st = (VndState){
+        .ctx = { .prob = prob, .ws = ws, .sol = sol, .usage = ws->ls_usage, .ls_k = ls_k, .ls_mode = ls_mode },
+        .max_no_improvement = max_no_improvement,
+    };
+}
 
-    // Free candidate solution after finishing
-    free_solution(&candidate_sol);
+bool vnd_step(VndState *st, const float budget) {
+    return vnd_step_units(st, UINT64_MAX, budget);
+}
+
+bool vnd_step_units(VndState *st, const uint64_t units, const float budget) {
+    PROFILE_ZONE("vnd");
+    SearchContext *ctx = &st->ctx;
+    ctx->start = wall_clock();
+    ctx->max_time = budget;
+    for (uint64_t unit = 0; unit < units && st->no_improvement < st->max_no_improvement &&
+                            !time_is_up(ctx->start, ctx->max_time); unit++) {
+        st->iterations++;
+        if (vnd_iteration(ctx)) {
+            st->no_improvement = 0;
+        } else {
+            st->no_improvement++;
+        }
+    }
+    return st->no_improvement < st->max_no_improvement;
+}
+
+StepState vnd_state(const VndState *st) {
+    return (StepState){
+        .value = st->ctx.sol->value,
+        .iterations = st->iterations,
+        .done = st->no_improvement >= st->max_no_improvement,
+    };
+}
+
+void vnd_finalize(VndState *st) {
+    st->ctx.ws->ls_usage = st->ctx.usage;
+}
+
+void vnd(const Problem *prob,
+        Solution *sol,
+        const int max_no_improvement,
+        const int ls_k,
+        const LSMode ls_mode,
+        const clock_t start,
+        const float max_time,
+        Workspace *ws) {
+    VndState st;
+    vnd_init(&st, prob, sol, max_no_improvement, ls_k, ls_mode, ws);
+    vnd_step(&st, time_remaining(start, max_time));
+    vnd_finalize(&st);
 }
@@ -6,12 +6,115 @@
 #include "lib/vns.h"
 
 #include <local_search.h>
+#include <stats.h>
+#include <profiler.h>
 #include <stdio.h>
 
 #include <stdlib.h>
 #include <string.h>
 #include <utils.h>
 #include <vnd.h>
+#include <elite.h>
+#include <thread_pool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+void vns_init(VnsState *st,
+              const Problem *prob,
+              Solution *sol,
+              const int max_no_improvement,
+              const int k_max,
+              const int ls_k,
+              const LSMode ls_mode,
+              const LogLevel verbose,
+              Workspace *ws) {
+    // Incumbent usage, and the search context that carries the shaken candidate down to VND.
+    // Improvements are handed back by swapping pointers, never by copying or recomputing
+    compute_usage_from_solution(prob, sol, ws->vns_usage);
+    *st = (VnsState){
+        .prob = prob, .ws = ws, .sol = sol, .sol_usage = ws->vns_usage,
+        .ctx = {
+            .prob = prob, .ws = ws, .sol = &ws->vns_candidate, .usage = ws->shake_usage,
+            .ls_k = ls_k, .ls_mode = ls_mode
+        },
+        .max_no_improvement = max_no_improvement, .k_max = k_max, .verbose = verbose
+    };
+}
+
+bool vns_step(VnsState *st, const float budget) {
+    return vns_step_units(st, UINT64_MAX, budget);
+}
+
+bool vns_step_units(VnsState *st, const uint64_t units, const float budget) {
+    PROFILE_ZONE("vns");
+    const uint64_t t0 = stats_phase_begin();
+    const Problem *prob = st->prob;
+    Solution *sol = st->sol;
+    SearchContext *ctx = &st->ctx;
+    const clock_t start = wall_clock();
+
+    // VND stops at the step's deadline too, so a step does not overrun its budget
+    ctx->start = start;
+    ctx->max_time = budget;
+
+    for (uint64_t unit = 0; unit < units && st->no_improvement < st->max_no_improvement &&
+                            !time_is_up(start, budget); unit++) {
+        // Shake
+        shake(prob, sol, st->sol_usage, ctx->sol, ctx->usage, st->k, st->ws);
+        search_context_invalidate(ctx);
+        st->shakes++;
+
+        // Search for a better solution, and keep its local optimum if it is good and new
+        vnd_ctx(ctx, 5);
+        elite_pool_offer(&st->ws->elite, ctx->sol);
+
+        // Update best solution
+        if (ctx->sol->value > sol->value) {
+            st->improved = true;
+            stats_inc(STAT_INCUMBENT_IMPROVEMENTS);
+            swap_solutions(sol, ctx->sol);
+            float *tmp_usage = st->sol_usage;
+            st->sol_usage = ctx->usage;
+            ctx->usage = tmp_usage;
+            st->k = 0;
+        } else {
+            st->k++;
+        }
+
+        // End of a sweep over k
+        if (st->k > st->k_max) {
+            if (st->improved) {
+                st->no_improvement = 0;
+            } else {
+                st->no_improvement++;
+            }
+            st->k = 0;
+            st->improved = false;
+            st->sweeps++;
+
+            // Print progress
+            if (st->verbose == DEBUG && (st->sweeps % 10 == 0)) {
+                printf("[VNS] Iteration %d: best value = %.2f\n", st->sweeps, sol->value);
+            }
+        }
+    }
+    stats_phase_end(PHASE_VNS, t0);
+    return st->no_improvement < st->max_no_improvement;
+}
+
+StepState vns_state(const VnsState *st) {
+    return (StepState){
+        .value = st->sol->value,
+        .iterations = st->shakes,
+        .done = st->no_improvement >= st->max_no_improvement,
+    };
+}
+
+void vns_finalize(VnsState *st) {
+    // Hand the (possibly swapped) usage buffers back to the workspace
+    st->ws->vns_usage = st->sol_usage;
+    st->ws->shake_usage = st->ctx.usage;
+}
 
 void vns(const Problem *prob,
         Solution *sol,
@@ -21,93 +124,241 @@ void vns(const Problem *prob,
         const LSMode ls_mode,
         const clock_t start,
         const float max_time,
-        const LogLevel verbose) {
+        const LogLevel verbose,
+        Workspace *ws) {
+    VnsState st;
+    vns_init(&st, prob, sol, max_no_improvement, k_max, ls_k, ls_mode, verbose, ws);
+    vns_step(&st, time_remaining(start, max_time));
+    vns_finalize(&st);
+}
+
+/* The shared state of a parallel VNS run */
+typedef struct {
+    const Problem *prob;
+    Solution *sol;                  // the shared incumbent
+    float *sol_usage;               // its usage
+    Workspace *ws;                  // workspace of thread 0
+    Workspace *workers;             // workspaces of threads 1 and up
+    int max_no_improvement;
+    int k_max;
+    int ls_k;
+    LSMode ls_mode;
+    clock_t start;
+    float max_time;
+    int k;                          // synchronous: shake size of thread 0 in this round
+    pthread_mutex_t lock;           // asynchronous: guards sol and sol_usage
+    _Atomic uint64_t version;       // asynchronous: number of improvements published
+} ParallelVns;
+
+/* Internal helper: the workspace of thread t */
+static inline Workspace *pvns_workspace(const ParallelVns *job, const int t) {
+    return (t == 0) ? job->ws : &job->workers[t - 1];
+}
+
+/* Internal helper: shake the incumbent into a thread's candidate and descend with VND */
+static void pvns_shake_and_descend(const ParallelVns *job, const Solution *from, const float *from_usage,
+                                   const int k, Workspace *ws) {
+    const Problem *prob = workspace_problem(ws, job->prob);
+    SearchContext ctx = {
+        .prob = prob, .ws = ws, .sol = &ws->vns_candidate, .usage = ws->shake_usage,
+        .ls_k = job->ls_k, .ls_mode = job->ls_mode, .start = job->start, .max_time = job->max_time
+    };
+    shake(prob, from, from_usage, ctx.sol, ctx.usage, k, ws);
+    vnd_ctx(&ctx, 5);
+    ws->shake_usage = ctx.usage;
+    elite_pool_offer(&ws->elite, ctx.sol);
+}
+
+/* Internal helper: one synchronous round, thread t shakes with k + t */
+static void pvns_sync_task(void *arg, const int task, const int worker) {
+    const ParallelVns *job = arg;
+    const int k = job->k + task;
+    if (k <= job->k_max) {
+        pvns_shake_and_descend(job, job->sol, job->sol_usage, k, pvns_workspace(job, worker));
+    }
+}
+
+/* Internal helper: copy the shared incumbent into a thread's private one */
+static uint64_t pvns_import(ParallelVns *job, Solution *local, float *local_usage) {
+    pthread_mutex_lock(&job->lock);
+    copy_solution(job->sol, local);
+    memcpy(local_usage, job->sol_usage, job->prob->m * sizeof(float));
+    const uint64_t version = atomic_load_explicit(&job->version, memory_order_relaxed);
+    pthread_mutex_unlock(&job->lock);
+    return version;
+}
+
+/* Internal helper: one thread of the asynchronous search */
+static void pvns_async_task(void *arg, const int task, const int worker) {
+    (void)task;
+    ParallelVns *job = arg;
+    Workspace *ws = pvns_workspace(job, worker);
+    Solution *local = &ws->pvns_incumbent;
+    float *local_usage = ws->pvns_usage;
+    uint64_t seen = pvns_import(job, local, local_usage);
 
-    int iter = 0;
     int k = 0;
+    bool improved = false;
     int no_improvement = 0;
+    while (no_improvement < job->max_no_improvement && !time_is_up(job->start, job->max_time)) {
+        // Another thread published a better incumbent: continue from it
+        if (atomic_load_explicit(&job->version, memory_order_acquire) != seen) {
+            seen = pvns_import(job, local, local_usage);
+            improved = true;
+            k = 0;
+        }
 
-    Solution candidate_sol;
-    allocate_solution(&candidate_sol, prob->n);
-    copy_solution(sol, &candidate_sol);
+        pvns_shake_and_descend(job, local, local_usage, k, ws);
+        Solution *candidate = &ws->vns_candidate;
+        if (candidate->value > local->value) {
+            swap_solutions(local, candidate);
+            float *tmp_usage = local_usage;
+            local_usage = ws->shake_usage;
+            ws->shake_usage = tmp_usage;
+            improved = true;
+            k = 0;
 
-    while (no_improvement < max_no_improvement) {
-        k = 0;
-        bool improved = false;
-        while (k <= k_max) {
-            // Shake
-            shake(prob, sol, &candidate_sol, k);
+            // Publish it, unless another thread got further in the meantime
+            pthread_mutex_lock(&job->lock);
+            if (local->value > job->sol->value) {
+                copy_solution(local, job->sol);
+                memcpy(job->sol_usage, local_usage, job->prob->m * sizeof(float));
+                seen = atomic_fetch_add_explicit(&job->version, 1, memory_order_release) + 1;
+                stats_inc(STAT_INCUMBENT_IMPROVEMENTS);
+            }
+            pthread_mutex_unlock(&job->lock);
+        } else {
+            k++;
+        }
+
+        // End of a sweep over k
+        if (k > job->k_max) {
+            no_improvement = improved ? 0 : no_improvement + 1;
+            improved = false;
+            k = 0;
+        }
+    }
+    ws->pvns_usage = local_usage;
+}
 
-            // Search for a better solution
-            vnd(prob, &candidate_sol, 5, ls_k, ls_mode, start, max_time);
+void parallel_vns(const Problem *prob,
+                  Solution *sol,
+                  const int max_no_improvement,
+                  const int k_max,
+                  const int ls_k,
+                  const LSMode ls_mode,
+                  const VnsParallel mode,
+                  const clock_t start,
+                  const float max_time,
+                  const LogLevel verbose,
+                  Workspace *ws,
+                  Workspace *workers) {
+    ThreadPool *pool = ws->pool;
+    const int threads = thread_pool_size(pool);
+    if (threads == 1) {
+        vns(prob, sol, max_no_improvement, k_max, ls_k, ls_mode, start, max_time, verbose, ws);
+        return;
+    }
+    PROFILE_ZONE("parallel_vns");
+    const uint64_t t0 = stats_phase_begin();
 
-            // Update best solution
-            if (candidate_sol.value > sol->value) {
-                improved = true;
-                copy_solution(&candidate_sol, sol);
-                k = 0;
+    // The pool runs the threads of the search: their VND scans sequentially
+    ws->pool = nullptr;
+    compute_usage_from_solution(prob, sol, ws->vns_usage);
+    ParallelVns job = {
+        .prob = prob, .sol = sol, .sol_usage = ws->vns_usage, .ws = ws, .workers = workers,
+        .max_no_improvement = max_no_improvement, .k_max = k_max, .ls_k = ls_k, .ls_mode = ls_mode,
+        .start = start, .max_time = max_time
+    };
+
+    if (mode == VNS_ASYNC) {
+        pthread_mutex_init(&job.lock, nullptr);
+        thread_pool_run_each(pool, pvns_async_task, &job);
+        pthread_mutex_destroy(&job.lock);
+    } else {
+        bool improved = false;
+        int no_improvement = 0;
+        int sweeps = 0;
+        while (no_improvement < max_no_improvement && !time_is_up(start, max_time)) {
+            thread_pool_run_each(pool, pvns_sync_task, &job);
+
+            // Best result of the round, the smallest k on ties
+            Workspace *best = nullptr;
+            for (int t = 0; t < threads && job.k + t <= k_max; t++) {
+                Workspace *w = pvns_workspace(&job, t);
+                if (w->vns_candidate.value > (best ? best->vns_candidate.value : sol->value)) {
+                    best = w;
+                }
             }
-            else {
-                k++;
+            if (best) {
+                copy_solution(&best->vns_candidate, sol);
+                memcpy(job.sol_usage, best->shake_usage, prob->m * sizeof(float));
+                stats_inc(STAT_INCUMBENT_IMPROVEMENTS);
+                improved = true;
+                job.k = 0;
+            } else {
+                job.k += threads;
             }
-        }
-        if (improved) {
-            no_improvement = 0;
-        } else {
-            no_improvement++;
-        }
-        iter++;
 
-        // Print progress
-        if (verbose == DEBUG && (iter % 10 == 0)) {
-            printf("[VNS] Iteration %d: best value = %.2f\n", iter, sol->value);
+            // End of a sweep over k
+            if (job.k > k_max) {
+                no_improvement = improved ? 0 : no_improvement + 1;
+                improved = false;
+                job.k = 0;
+                sweeps++;
+                if (verbose == DEBUG && (sweeps % 10 == 0)) {
+                    printf("[VNS] Iteration %d: best value = %.2f\n", sweeps, sol->value);
+                }
+            }
         }
     }
-    free_solution(&candidate_sol);
+    ws->pool = pool;
+    stats_phase_end(PHASE_VNS, t0);
 }
 
-void shake(const Problem *p, const Solution *s, Solution *candidate, const int k) {
-    memcpy(candidate->x, s->x, p->n * sizeof(float));
+void shake(const Problem *p, const Solution *s, const float *s_usage,
+           Solution *candidate, float *candidate_usage, const int k, Workspace *ws) {
+    PROFILE_ZONE("shake");
+    stats_inc(STAT_VNS_SHAKES);
+    const int n = p->n;
+    const int m = p->m;
+    memcpy(candidate->x, s->x, n * sizeof(float));
+    memcpy(candidate_usage, s_usage, m * sizeof(float));
     candidate->value = s->value;
 
-    const int n = p->n;
     // If k > n, there's no point flipping more than n unique indices:
     const int flips = (k < n) ? k : n;
 
-    // Create an array of all indices
-    int *indices = malloc(n * sizeof(int));
-    for (int i = 0; i < n; i++) {
-        indices[i] = i;
-    }
-
-    // Randomize the order of indices
-    for (int i = n - 1; i > 0; i--) {
-        const int j = rand() % (i + 1);
-        // Swap
-        const int temp = indices[i];
-        indices[i] = indices[j];
-        indices[j] = temp;
-    }
-
-    // Flip the first 'flips' distinct indices
+    // Partial Fisher-Yates on the persistent permutation: after step i, indices[0..i] is a
+    // uniform sample of distinct items whatever the permutation held before (O(flips), not O(n))
+    int *indices = ws->shake_indices;
     for (int i = 0; i < flips; i++) {
-        const int idx = indices[i];
+        const int j = i + (int)rng_below(&ws->rng, n - i);
+        const int idx = indices[j];
+        indices[j] = indices[i];
+        indices[i] = idx;
 
-        const float old_val   = candidate->x[idx];
-        const float new_val   = (old_val > 0.5f) ? 0.0f : 1.0f;
-        const float delta_val = (new_val > old_val) ? p->c[idx] : -p->c[idx];
-
-        candidate->x[idx] = new_val;
-        candidate->value  += delta_val;
+        // Flip idx, updating value and usage with its weights (O(m))
+        const bool add = candidate->x[idx] < 0.5f;
+        const float sign = add ? 1.0f : -1.0f;
+        const float *w = &p->weights_by_item[idx * m];
+        candidate->x[idx] = add ? 1.0f : 0.0f;
+        candidate->value += sign * p->c[idx];
+        for (int r = 0; r < m; r++) {
+            candidate_usage[r] += sign * w[r];
+        }
     }
 
-    free(indices);
-
-    // Check feasibility
-    if (!check_feasibility(p, candidate)) {
-        const auto usage   = (float*)malloc(p->m * sizeof(float));
-        compute_usage_from_solution(p, candidate, usage);
-        compute_usage_from_solution(p, candidate, usage);
-        repair_solution(p, candidate, usage, &candidate->value);
+    // Check feasibility on the updated usage, repair from it if needed
+    bool feasible = true;
+    for (int r = 0; r < m; r++) {
+        if (candidate_usage[r] > p->capacities[r]) {
+            feasible = false;
+            break;
+        }
     }
-}
\ No newline at end of file
+    candidate->feasible = feasible;
+    if (!feasible) {
+        repair_solution(p, candidate, candidate_usage, &candidate->value);
+    }
+}
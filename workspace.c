@@ -0,0 +1,291 @@
+//
+// Preallocated scratch buffers shared by all solver methods.
+//
+#include <workspace.h>
+#include <move_eval.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int workspace_init(Workspace *ws, const Problem *prob, const uint64_t seed) {
+    memset(ws, 0, sizeof(*ws));
+    ws->n = prob->n;
+    ws->m = prob->m;
+    rng_seed(&ws->rng, seed, 0);
+
+    const int n = prob->n;
+    const int m = prob->m;
+
+    allocate_solution(&ws->init_candidate, n);
+    allocate_solution(&ws->start_candidate, n);
+    allocate_solution(&ws->ls_candidate, n);
+    allocate_solution(&ws->vns_candidate, n);
+    allocate_solution(&ws->pvns_incumbent, n);
+    allocate_solution(&ws->pr_current, n);
+    allocate_solution(&ws->tabu_current, n);
+    allocate_solution(&ws->slice_candidate, n);
+    allocate_solution(&ws->slice_best, n);
+    allocate_solution(&ws->coop_vns, n);
+    allocate_solution(&ws->coop_ls, n);
+    allocate_solution(&ws->coop_import, n);
+
+    ws->ls_usage           = (float*)malloc(m * sizeof(float));
+    ws->ls_candidate_usage = (float*)malloc(m * sizeof(float));
+    ws->ls_fit             = (int*)malloc(n * sizeof(int));
+    ws->ls_profit_pairs    = malloc(n * sizeof(*ws->ls_profit_pairs));
+    ws->ls_slack           = (float*)malloc(m * sizeof(float));
+    ws->ls_window_mask     = (uint64_t*)malloc(move_mask_words(n) * sizeof(uint64_t));
+    ws->ls_fit_mask        = (uint64_t*)malloc(move_mask_words(n) * sizeof(uint64_t));
+    ws->ex_slack           = (float*)malloc(m * sizeof(float));
+    ws->ex_residual        = (float*)malloc(m * sizeof(float));
+    ws->ex_chain_usage     = (float*)malloc(m * sizeof(float));
+    ws->pr_usage           = (float*)malloc(m * sizeof(float));
+    ws->pr_path            = (int*)malloc(n * sizeof(int));
+    ws->tabu_usage         = (float*)malloc(m * sizeof(float));
+    ws->tabu_until         = (int*)malloc(n * sizeof(int));
+    ws->vns_usage          = (float*)malloc(m * sizeof(float));
+    ws->shake_indices      = (int*)malloc(n * sizeof(int));
+    ws->shake_usage        = (float*)malloc(m * sizeof(float));
+    ws->pvns_usage         = (float*)malloc(m * sizeof(float));
+    ws->gd_theta           = (float*)malloc(n * sizeof(float));
+    ws->gd_velocity        = (float*)malloc(n * sizeof(float));
+    ws->gd_x_hat           = (float*)malloc(n * sizeof(float));
+    ws->gd_mask            = (float*)malloc(m * sizeof(float));
+    ws->gd_usage           = (float*)malloc(m * sizeof(float));
+    ws->gd_frozen          = (bool*)malloc(n * sizeof(bool));
+    ws->ga_usage           = (float*)malloc(m * sizeof(float));
+
+    // Check for allocation errors
+    if (!ws->ls_usage || !ws->ls_candidate_usage || !ws->ls_fit || !ws->ls_profit_pairs || !ws->ls_slack ||
+        !ws->ls_window_mask || !ws->ls_fit_mask || !ws->ex_slack || !ws->ex_residual || !ws->ex_chain_usage ||
+        !ws->pr_usage || !ws->pr_path || !ws->tabu_usage || !ws->tabu_until || !ws->vns_usage || !ws->shake_indices || !ws->shake_usage || !ws->pvns_usage ||
+        !ws->gd_theta || !ws->gd_velocity || !ws->gd_x_hat || !ws->gd_mask || !ws->gd_usage ||
+        !ws->gd_frozen || !ws->ga_usage) {
+        fprintf(stderr, "Memory allocation error in workspace_init.\n");
+        workspace_free(ws);
+        return -1;
+    }
+
+    for (int j = 0; j < n; j++) {
+        ws->shake_indices[j] = j;
+    }
+    if (elite_pool_init(&ws->elite, ELITE_POOL_SIZE, n) != 0 || solution_board_init(&ws->board, BOARD_SIZE, n) != 0 ||
+        workspace_set_pool(ws, nullptr) != 0) {
+        workspace_free(ws);
+        return -1;
+    }
+
+    ws->eval_backend = BATCH_EVAL_BITPACKED;
+    ws->evaluator = batch_evaluator_create(ws->eval_backend, prob);
+    if (!ws->evaluator) {
+        workspace_free(ws);
+        return -1;
+    }
+    return 0;
+}
+
+int workspace_set_backend(Workspace *ws, const Problem *prob, const BatchBackend backend) {
+    if (backend == ws->eval_backend && ws->evaluator) return 0;
+    BatchEvaluator *evaluator = batch_evaluator_create(backend, prob);
+    if (!evaluator) return -1;
+    batch_evaluator_destroy(ws->evaluator);
+    ws->evaluator = evaluator;
+    ws->eval_backend = backend;
+    return 0;
+}
+
+/* Internal helper to free the swap scan slots */
+static void free_scans(Workspace *ws) {
+    for (int t = 0; t < ws->ls_scan_count; t++) {
+        free(ws->ls_scans[t].filter);
+        free(ws->ls_scans[t].fit_mask);
+        free(ws->ls_scans[t].slack);
+    }
+    free(ws->ls_scans); ws->ls_scans = nullptr;
+    ws->ls_scan_count = 0;
+}
+
+int workspace_set_pool(Workspace *ws, ThreadPool *pool) {
+    ws->pool = pool;
+    const int threads = thread_pool_size(pool);
+    if (threads <= ws->ls_scan_count) return 0;
+
+    SwapScan *scans = realloc(ws->ls_scans, threads * sizeof(SwapScan));
+    if (!scans) {
+        fprintf(stderr, "Memory allocation error for the swap scan slots.\n");
+        return -1;
+    }
+    ws->ls_scans = scans;
+    for (int t = ws->ls_scan_count; t < threads; t++) {
+        SwapScan *scan = &ws->ls_scans[t];
+        memset(scan, 0, sizeof(*scan));
+        scan->filter   = (uint64_t*)malloc(move_mask_words(ws->n) * sizeof(uint64_t));
+        scan->fit_mask = (uint64_t*)malloc(move_mask_words(ws->n) * sizeof(uint64_t));
+        scan->slack    = (float*)malloc(ws->m * sizeof(float));
+        ws->ls_scan_count = t + 1; // freed by free_scans even if incomplete
+        if (!scan->filter || !scan->fit_mask || !scan->slack) {
+            fprintf(stderr, "Memory allocation error for the swap scan slots.\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Internal helper to make sure eval_batch can point to count solutions */
+static int reserve_eval_batch(Workspace *ws, const int count) {
+    if (count <= ws->eval_capacity) return 0;
+    Solution **eval_batch = realloc(ws->eval_batch, count * sizeof(Solution *));
+    if (!eval_batch) {
+        fprintf(stderr, "Memory allocation error for the evaluation batch.\n");
+        return -1;
+    }
+    ws->eval_batch = eval_batch;
+    ws->eval_capacity = count;
+    return 0;
+}
+
+int workspace_reserve_population(Workspace *ws, const int population_size) {
+    if (population_size <= ws->ga_capacity) return 0;
+
+    Individual *population     = realloc(ws->ga_population, population_size * sizeof(Individual));
+    if (population) ws->ga_population = population;
+    Individual *new_population = realloc(ws->ga_new_population, population_size * sizeof(Individual));
+    if (new_population) ws->ga_new_population = new_population;
+    Individual **sorted        = realloc(ws->ga_sorted, population_size * sizeof(Individual *));
+    if (sorted) ws->ga_sorted = sorted;
+    if (!population || !new_population || !sorted) {
+        fprintf(stderr, "Memory allocation error for population.\n");
+        return -1;
+    }
+
+    for (int i = ws->ga_capacity; i < population_size; i++) {
+        allocate_solution(&ws->ga_population[i].sol, ws->n);
+        allocate_solution(&ws->ga_new_population[i].sol, ws->n);
+        ws->ga_population[i].fitness = 0.0f;
+        ws->ga_new_population[i].fitness = 0.0f;
+    }
+    ws->ga_capacity = population_size;
+    return reserve_eval_batch(ws, population_size);
+}
+
+/* Internal helper to free the batched gradient descent buffers */
+static void free_gd_batch(Workspace *ws) {
+    free(ws->gd_batch_theta); ws->gd_batch_theta = nullptr;
+    free(ws->gd_batch_velocity); ws->gd_batch_velocity = nullptr;
+    free(ws->gd_batch_x_hat); ws->gd_batch_x_hat = nullptr;
+    free(ws->gd_batch_grad); ws->gd_batch_grad = nullptr;
+    free(ws->gd_batch_usage); ws->gd_batch_usage = nullptr;
+    free(ws->gd_batch_mask); ws->gd_batch_mask = nullptr;
+    free(ws->gd_batch_frozen); ws->gd_batch_frozen = nullptr;
+    free(ws->gd_batch_loss); ws->gd_batch_loss = nullptr;
+    free(ws->gd_batch_no_improv); ws->gd_batch_no_improv = nullptr;
+    for (int b = 0; b < ws->gd_batch_capacity; b++) {
+        free_solution(&ws->start_solutions[b]);
+    }
+    free(ws->start_solutions); ws->start_solutions = nullptr;
+    ws->gd_batch_capacity = 0;
+}
+
+int workspace_reserve_gd_batch(Workspace *ws, const int batch) {
+    if (batch <= ws->gd_batch_capacity) return 0;
+
+    // The matrices are reallocated as a whole: nothing in them survives between calls
+    free_gd_batch(ws);
+    const size_t rows_n = (size_t)batch * ws->n;
+    const size_t rows_m = (size_t)batch * ws->m;
+    ws->gd_batch_theta     = (float*)malloc(rows_n * sizeof(float));
+    ws->gd_batch_velocity  = (float*)malloc(rows_n * sizeof(float));
+    ws->gd_batch_x_hat     = (float*)malloc(rows_n * sizeof(float));
+    ws->gd_batch_grad      = (float*)malloc(rows_n * sizeof(float));
+    ws->gd_batch_usage     = (float*)malloc(rows_m * sizeof(float));
+    ws->gd_batch_mask      = (float*)malloc(rows_m * sizeof(float));
+    ws->gd_batch_frozen    = (bool*)malloc(rows_n * sizeof(bool));
+    ws->gd_batch_loss      = (float*)malloc(batch * sizeof(float));
+    ws->gd_batch_no_improv = (int*)malloc(batch * sizeof(int));
+    ws->start_solutions = (Solution*)malloc(batch * sizeof(Solution));
+    if (!ws->gd_batch_theta || !ws->gd_batch_velocity || !ws->gd_batch_x_hat || !ws->gd_batch_grad ||
+        !ws->gd_batch_usage || !ws->gd_batch_mask || !ws->gd_batch_frozen || !ws->gd_batch_loss ||
+        !ws->gd_batch_no_improv || !ws->start_solutions) {
+        fprintf(stderr, "Memory allocation error for the gradient descent batch.\n");
+        free_gd_batch(ws);
+        return -1;
+    }
+    for (int b = 0; b < batch; b++) {
+        allocate_solution(&ws->start_solutions[b], ws->n);
+    }
+    ws->gd_batch_capacity = batch;
+    return reserve_eval_batch(ws, batch);
+}
+
+int workspace_resize(Workspace *ws, const Problem *prob) {
+    const Rng rng = ws->rng;
+    ThreadPool *pool = ws->pool;
+    const BatchBackend backend = ws->eval_backend;
+    const int capacity = ws->ga_capacity;
+    const int batch = ws->gd_batch_capacity;
+    workspace_free(ws);
+    if (workspace_init(ws, prob, 0) != 0) return -1;
+    ws->rng = rng;
+    if (workspace_set_backend(ws, prob, backend) != 0) return -1;
+    if (workspace_set_pool(ws, pool) != 0) return -1;
+    if (workspace_reserve_population(ws, capacity) != 0) return -1;
+    return workspace_reserve_gd_batch(ws, batch);
+}
+
+void workspace_free(Workspace *ws) {
+    if (!ws) return;
+    free_solution(&ws->init_candidate);
+    free_solution(&ws->start_candidate);
+    free_solution(&ws->ls_candidate);
+    free_solution(&ws->vns_candidate);
+    free_solution(&ws->pvns_incumbent);
+    free_solution(&ws->pr_current);
+    free_solution(&ws->tabu_current);
+    free_solution(&ws->slice_candidate);
+    free_solution(&ws->slice_best);
+    free_solution(&ws->coop_vns);
+    free_solution(&ws->coop_ls);
+    free_solution(&ws->coop_import);
+
+    free(ws->ls_usage); ws->ls_usage = nullptr;
+    free(ws->ls_candidate_usage); ws->ls_candidate_usage = nullptr;
+    free(ws->ls_fit); ws->ls_fit = nullptr;
+    free(ws->ls_profit_pairs); ws->ls_profit_pairs = nullptr;
+    free(ws->ls_slack); ws->ls_slack = nullptr;
+    free(ws->ls_window_mask); ws->ls_window_mask = nullptr;
+    free(ws->ls_fit_mask); ws->ls_fit_mask = nullptr;
+    free(ws->ex_slack); ws->ex_slack = nullptr;
+    free(ws->ex_residual); ws->ex_residual = nullptr;
+    free(ws->ex_chain_usage); ws->ex_chain_usage = nullptr;
+    free(ws->pr_usage); ws->pr_usage = nullptr;
+    free(ws->pr_path); ws->pr_path = nullptr;
+    free(ws->tabu_usage); ws->tabu_usage = nullptr;
+    free(ws->tabu_until); ws->tabu_until = nullptr;
+    free(ws->vns_usage); ws->vns_usage = nullptr;
+    free(ws->shake_indices); ws->shake_indices = nullptr;
+    free(ws->shake_usage); ws->shake_usage = nullptr;
+    free(ws->pvns_usage); ws->pvns_usage = nullptr;
+    free(ws->gd_theta); ws->gd_theta = nullptr;
+    free(ws->gd_velocity); ws->gd_velocity = nullptr;
+    free(ws->gd_x_hat); ws->gd_x_hat = nullptr;
+    free(ws->gd_mask); ws->gd_mask = nullptr;
+    free(ws->gd_usage); ws->gd_usage = nullptr;
+    free(ws->gd_frozen); ws->gd_frozen = nullptr;
+    free(ws->ga_usage); ws->ga_usage = nullptr;
+    free_scans(ws);
+    elite_pool_free(&ws->elite);
+    solution_board_free(&ws->board);
+    free_gd_batch(ws);
+    batch_evaluator_destroy(ws->evaluator); ws->evaluator = nullptr;
+    free(ws->eval_batch); ws->eval_batch = nullptr;
+    ws->eval_capacity = 0;
+
+    for (int i = 0; i < ws->ga_capacity; i++) {
+        free_solution(&ws->ga_population[i].sol);
+        free_solution(&ws->ga_new_population[i].sol);
+    }
+    free(ws->ga_population); ws->ga_population = nullptr;
+    free(ws->ga_new_population); ws->ga_new_population = nullptr;
+    free(ws->ga_sorted); ws->ga_sorted = nullptr;
+    ws->ga_capacity = 0;
+}